@@ -1,183 +1,293 @@
 #include <RDA_5807.h>
+#include <RDA_Prof.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 
 #define WRITE_DELAY 3
 #define MIN_DELAY 1
+#define TUNE_TIMEOUT 500    // ms budget of a tune, longest seen is about 60 ms
+#define I2C_RETRIES 2       // Default retries of a failed transfer
+#define SCAN_TUNE_TIME 10   // ms a channel takes to tune, the scan and the tune continuation poll STC after it
+#define SCAN_RDS_DWELL 200  // ms a scan waits on a station for RDS sync
+#define SCAN_RDS_POLL 20    // ms between RDS sync polls of a scan
+#define SCAN_SEEK_POLL 10   // ms between STC polls of a seek (scan or continuation), a seek passes several channels
+#define SCAN_SEEK_TIMEOUT 3000  // ms budget of one scan seek, up to the whole band
+#define AF_TUNE_TIME 15     // ms a candidate of an AF check is assumed to take until one was measured
+#define POWER_POLL 5        // ms between FM_READY polls of the power-up
+#define AF_MARGIN 6         // RSSI an AF must beat the current channel by, so fading does not flip between them
+#define AF_PI_POLL 10       // ms between RDS reads of the PI check of an AF
+#define AF_PI_POLLS 100     // Burst reads of the PI check without a timebase, about 130 ms at 100 kHz
 
-const uint16_t startBand[4] = {8700, 7600, 7600, 6500};
-const uint16_t endBand[4] = {10800, 9100, 10800, 7600};
+// Scan phases
+#define SCAN_IDLE 0
+#define SCAN_TUNING 1       // Waiting for STC of a channel tune
+#define SCAN_SEEKING 2      // Waiting for STC of a seek
+#define SCAN_DWELL 3        // Waiting for RDS sync on a station
+
+#define CHAN_MAX 1023       // REG03 CHAN is 10 bits
+
+// Band limits and channel spacing in kHz, indexed by BAND and SPACE of REG03
+const uint32_t startBand[4] = {87000, 76000, 76000, 65000};
+const uint32_t endBand[4] = {108000, 91000, 108000, 76000};
 const uint16_t fmSpace[4] = {100, 200, 50, 25};
 
-typedef struct
-{
-    // REG01
-	RDA_Reg01 reg01;
-    // REG02
-	RDA_Reg02 reg02;
-    // REG03
-	RDA_Reg03 reg03;
-    // REG04
-	RDA_Reg04 reg04;
-    // REG05
-	RDA_Reg05 reg05;
-    // REG06
-	RDA_Reg06 reg06;
-    // REG07
-	RDA_Reg07 reg07;
-    // REG08
-	RDA_Reg08 reg08;
-    // REG0A
-	RDA_Reg0A reg0A;
-    // REG0B
-	RDA_Reg0B reg0B;
-    // REG0C
-	RDA_Reg0C reg0C;
-    // REG0D
-	RDA_Reg0D reg0D;
-    // REG0E
-	RDA_Reg0E reg0E;
-    // REG0F
-	RDA_Reg0F reg0F;
-    // FM frequency
-    uint16_t currentFrequency;
-    // FM band
-    uint8_t currentFMBand;
-    // FM space
-    uint8_t currentFMSpace;
-    // FM volume
-    uint8_t currentVolume;
-} RDA_Handle;
-
-static RDA_Handle handle = {};
-
-typedef union {
-    struct
-    {
-        uint8_t low;
-        uint8_t high;
-    } write;
-    uint16_t all;
-} wordToByte;
-
-#ifdef SYSTICK_DELAY
-#define MS_CORE (SystemCoreClock / 1000)
-__IO uint32_t systickValue = 0;
-
-void Delay_Init()
-{
-	SystemCoreClockUpdate(); // Update SystemCoreClock variable
-	SysTick_Config(MS_CORE); // 1 Milli second
-}
-
-uint32_t getMillis()
-{
-	return systickValue;
-}
-
-void Delay(uint32_t delay)
-{
-	uint32_t startMs = getMillis();
-	while ((getMillis() - startMs) < delay);
+
+
+/*
+ * Maps a transfer result to the driver status
+ */
+RDA_Status xferStatus(RDA_XferStatus status)
+{
+    switch (status)
+    {
+    case RDA_XFER_OK:
+        return RDA_OK;
+    case RDA_XFER_TIMEOUT:
+        return RDA_TIMEOUT;
+    case RDA_XFER_NACK:
+        return RDA_NACK;
+    default:
+        return RDA_ERROR;
+    }
+}
+
+/* Default transfer port: runs a descriptor to completion with the
+ * blocking HAL bus functions and completes it synchronously
+ */
+void xferPolledStart(void* port, RDA_Xfer* xfer)
+{
+    RDA_Handle* dev = port;
+    RDA_XferStatus status;
+
+    if (xfer->direction == RDA_XFER_WRITE)
+    {
+        status = RDA_HAL_Write(dev->I2Cx, xfer->address, xfer->reg, xfer->data, xfer->length);
+    }
+    else
+    {
+        status = RDA_HAL_Read(dev->I2Cx, xfer->address, xfer->reg, xfer->data, xfer->length);
+    }
+    RDA_XferComplete(&dev->queue, status);
 }
 
+static const RDA_XferPort xferPolledPort = {xferPolledStart, NULL, NULL, NULL};
+
 /*
- * SysTick Interrupt Handler
+ * Starts the RDA_I2C_TIMEOUT budget of a queue wait
  */
-void SysTick_Handler()
+static uint32_t xferWaitStart(void)
 {
-	systickValue++;
+#ifdef SYSTICK_DELAY
+    return getMillis();
+#else
+    return 0;
+#endif
 }
+
+/* Waits a moment for the queue to move on and checks the RDA_I2C_TIMEOUT budget.
+ * The budget restarts whenever a transfer completes, so transfers queued ahead do not
+ * count against it. When nothing completed within it (a lost interrupt, a bus stuck
+ * before SB) the transfer on the bus is aborted and the bus recovered.
+ * Returns TRUE when it aborted
+ */
+static BOOL xferStalled(RDA_Handle* dev, uint32_t* start, uint8_t* tail)
+{
+    if (dev->queue.tail != *tail)
+    {
+        *tail = dev->queue.tail;
+        *start = xferWaitStart();
+        return FALSE;
+    }
+    RDA_PROF_WAIT();
+#ifdef SYSTICK_DELAY
+    if ((getMillis() - *start) <= RDA_I2C_TIMEOUT)
+    {
+        RDA_HAL_Idle();
+        return FALSE;
+    }
+#else
+    if (++(*start) <= RDA_I2C_TIMEOUT)
+    {
+        return FALSE;
+    }
 #endif
+    RDA_XferAbort(&dev->queue);
+    RDA_HAL_Recover(dev->I2Cx);
+    RDA_XferResume(&dev->queue);
+    *tail = dev->queue.tail;
+    *start = xferWaitStart();
+    return TRUE;
+}
 
-void I2C_Start(I2C_TypeDef* I2Cx, uint8_t address, uint8_t direction)
+/**
+ * @ingroup GA03
+ * @brief Runs a transfer through the queue and waits for its completion
+ * @details Falls back to the polled port when the application did not install one.
+ * @details A failed transfer recovers the bus and is retried up to the retry budget.
+ * @details Submitting and completing are bounded by RDA_I2C_TIMEOUT, a transfer that does not
+ * @details complete in time is aborted in the port and ends with RDA_TIMEOUT.
+ * @details The result is kept for RDA_GetLastError.
+ */
+RDA_Status xferRun(RDA_Handle* dev, RDA_Xfer* xfer)
 {
-	// Wait until I2Cx is not busy anymore
-	while(I2C_GetFlagStatus(I2Cx, I2C_FLAG_BUSY));
-	// Send I2Cx START condition 
-	I2C_GenerateSTART(I2Cx, ENABLE);
-	// Wait for I2Cx EV5 --- Slave has acknowledged start condition
-	while(!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_MODE_SELECT));
-	// Send slave Address for write 
-	I2C_Send7bitAddress(I2Cx, address << 1, direction);
-	/* Wait for I2Cx EV6, check if
-	 * either slave has acknowledged Master transmitter or
-	 * master receiver mode, depending on the transmission
-	 * direction
-	 */
-	if(direction == I2C_Direction_Transmitter)
+    uint8_t attempt = 0;
+    BOOL recovered = FALSE;
+    uint32_t start;
+    uint8_t tail;
+
+    if (!dev->queue.port)
+    {
+        RDA_XferInit(&dev->queue, &xferPolledPort, dev);
+    }
+#ifdef SYSTICK_DELAY
+    // The settle time of the last write runs while the caller does other work, sleep off the rest
+    while (dev->settling && (int32_t)(dev->settleUntil - getMillis()) > 0)
     {
-		while(!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED));
-	}
-	else
+        RDA_PROF_WAIT();
+        RDA_HAL_Idle();
+    }
+    dev->settling = FALSE;
+#endif
+    dev->busOwned = TRUE;
+    do
     {
-		while(!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED));
-	}
+        if (attempt && !recovered)
+        {
+            RDA_HAL_Recover(dev->I2Cx);
+        }
+        recovered = FALSE;
+        tail = dev->queue.tail;
+        start = xferWaitStart();
+        while (!RDA_XferSubmit(&dev->queue, xfer))
+        {
+            xferStalled(dev, &start, &tail);
+        }
+        RDA_PROF_XFER(xfer);
+        while (xfer->status == RDA_XFER_PENDING)
+        {
+            recovered = xferStalled(dev, &start, &tail);
+        }
+    }
+    while (xfer->status != RDA_XFER_OK && attempt++ < dev->retries);
+    dev->busOwned = FALSE;
+
+    dev->lastError = xferStatus(xfer->status);
+    return dev->lastError;
 }
 
-/* This function transmits one byte to the slave device
- * Parameters:
- * I2Cx --- the I2C peripheral e.g.I2C1, I2C2
- * data --- the data byte to be transmitted
+/**
+ * @ingroup GA03
+ * @brief Starts the WRITE_DELAY settle time of a write
+ * @details Nothing waits here: the next transfer of the handle sleeps off what is left of it.
  */
-void I2C_Write(I2C_TypeDef* I2Cx, uint8_t data)
+void settleStart(RDA_Handle* dev)
 {
-	I2C_SendData(I2Cx, data);
-	// Wait for I2Cx EV8_2 --- byte has been transmitted
-	while(!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+#ifdef SYSTICK_DELAY
+    dev->settleUntil = getMillis() + WRITE_DELAY;
+    dev->settling = TRUE;
+#endif
+}
+
+RDA_Status registerWrite(RDA_Handle* dev, uint8_t reg, uint16_t value)
+{
+    RDA_Xfer xfer = {I2C_ADDR_DIRECT_ACCESS, RDA_XFER_WRITE, reg, 1, &value};
+    RDA_Status status = xferRun(dev, &xfer);
+
+    settleStart(dev);
+    // A write may change the status, the next getters read the chip
+    dev->statusFresh = 0;
+    return status;
 }
 
-/* This function reads one byte from the slave device 
- * and based on mode, acknowledges the byte (requests another byte)
+/**
+ * @ingroup GA03
+ * @brief Gets the shadow value of a writable register (0x02 to 0x07)
+ * @details A register that is only passed through by a sequential write (not dirty)
+ * @details must not restart a seek or a tune, so SEEK and TUNE are masked out.
  */
-void I2C_Read(I2C_TypeDef* I2Cx, uint8_t mode, uint16_t *buffer)
+uint16_t shadowValue(RDA_Handle* dev, uint8_t reg, BOOL dirty)
 {
-    wordToByte data = {};
-	// Wait until one byte has been received
-	while(!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED));
-	// Read data from I2Cx data register and return data byte
-	data.write.low = I2C_ReceiveData(I2Cx);
-    if(mode)
+    RDA_Reg02 reg02 = dev->reg02;
+    RDA_Reg03 reg03 = dev->reg03;
+
+    switch (reg)
     {
-        // Enable acknowledge of recieved data
-        I2C_AcknowledgeConfig(I2Cx, ENABLE);
+    case REG02:
+        reg02.refined.SEEK &= dirty;
+        return reg02.raw;
+    case REG03:
+        reg03.refined.TUNE &= dirty;
+        return reg03.raw;
+    case REG04:
+        return dev->reg04.raw;
+    case REG05:
+        return dev->reg05.raw;
+    case REG06:
+        return dev->reg06.raw;
+    case REG07:
+        return dev->reg07.raw;
+    default:
+        return 0x0;
     }
-    else
+}
+
+/**
+ * @ingroup GA03
+ * @brief Writes the registers from 0x02 up to lastReg in a single sequential write
+ * @details Uses the sequential access address (0x10). The chip always starts a sequential write at 0x02,
+ * @details so every register below lastReg is written too, with a single settle time at the end.
+ */
+RDA_Status registerWriteBurst(RDA_Handle* dev, uint8_t lastReg, uint8_t dirty)
+{
+    uint16_t temp[REG07 - REG02 + 1] = {};
+    RDA_Xfer xfer = {I2C_ADDR_FULL_ACCESS, RDA_XFER_WRITE, RDA_XFER_NO_REG, lastReg - REG02 + 1, temp};
+    RDA_Status status;
+    uint8_t reg;
+
+    for (reg = REG02; reg <= lastReg; reg++)
     {
-        // Disable acknowledge of received data
-        // NACK also generates stop condition after last byte received
-        // See reference manual for more info
-        I2C_AcknowledgeConfig(I2Cx, DISABLE);
-        I2C_GenerateSTOP(I2Cx, ENABLE);
+        temp[reg - REG02] = shadowValue(dev, reg, (dirty >> reg) & 1);
     }
-    // Wait until one byte has been received
-	while(!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED));
-	// Read data from I2Cx data register and return data byte
-	data.write.high = I2C_ReceiveData(I2Cx);
-    // Copy the data to buffer
-	*buffer = data.all;
+    status = xferRun(dev, &xfer);
+    settleStart(dev);
+    dev->statusFresh = 0;
+    return status;
 }
 
-/* This funtion issues a stop condition and therefore
- * releases the bus
+/**
+ * @ingroup GA03
+ * @brief Writes a shadow register to the chip, or marks it dirty inside RDA_BeginUpdate/RDA_CommitUpdate
  */
-void I2C_Stop(I2C_TypeDef* I2Cx)
+RDA_Status registerUpdate(RDA_Handle* dev, uint8_t reg)
 {
-	// Send I2Cx STOP condition 
-	I2C_GenerateSTOP(I2Cx, ENABLE);
+    if (dev->batchUpdate)
+    {
+        dev->dirtyRegisters |= (1 << reg);
+        return RDA_OK;
+    }
+    return registerWrite(dev, reg, shadowValue(dev, reg, TRUE));
 }
 
-void registerWrite(I2C_TypeDef* I2Cx, uint8_t reg, uint16_t value)
+/**
+ * @ingroup GA03
+ * @brief Notes when status registers were read (bit SH_REGxx), the getters may use them until they age out
+ */
+void statusStamp(RDA_Handle* dev, uint8_t mask)
 {
-    wordToByte data = {};
-    data.all = value;
-    I2C_Start(I2Cx, I2C_ADDR_DIRECT_ACCESS, I2C_Direction_Transmitter);
-    I2C_Write(I2Cx, reg); // Write address of the reg
-    I2C_Write(I2Cx, data.write.high); // Write byte by byte to the slave
-    I2C_Write(I2Cx, data.write.low);
-    I2C_Stop(I2Cx);
 #ifdef SYSTICK_DELAY
-    Delay(WRITE_DELAY);
+    uint32_t now = getMillis();
+    uint8_t i;
+
+    for (i = SH_REG0A; i <= SH_REG0F; i++)
+    {
+        if (mask & (1 << i))
+        {
+            dev->statusTime[i] = now;
+        }
+    }
 #endif
+    dev->statusFresh |= mask;
 }
 
 /**
@@ -187,195 +297,562 @@ void registerWrite(I2C_TypeDef* I2Cx, uint8_t reg, uint16_t value)
  * @details This method update the first element of the shadowStatusRegisters linked to the register
  * @return rdax_reg0a the reference to current value of the 0x0A register. 
  */
-void getStatus(I2C_TypeDef* I2Cx, uint8_t reg)
+RDA_Status getStatus(RDA_Handle* dev, uint8_t reg)
 {
     uint16_t temp = 0x0;
+    RDA_Xfer xfer = {I2C_ADDR_DIRECT_ACCESS, RDA_XFER_READ, reg, 1, &temp};
+    RDA_Status status;
 
     if (reg < 0x0A || reg > 0x0F)
     {
-        return; // Maybe not necessary.
+        return RDA_ERROR; // Maybe not necessary.
     }
 
-    I2C_Start(I2Cx, I2C_ADDR_DIRECT_ACCESS, I2C_Direction_Transmitter);
-    I2C_Write(I2Cx, reg); // Request specific register access
-    I2C_Stop(I2Cx);
-
-    I2C_Start(I2Cx, I2C_ADDR_DIRECT_ACCESS, I2C_Direction_Receiver);
-    I2C_Read(I2Cx, FALSE, &temp); // Read data from the register
-    I2C_Stop(I2Cx);
+    status = xferRun(dev, &xfer);
+    if (status != RDA_OK)
+    {
+        return status; // Keep the last good value
+    }
 
     switch (reg)
     {
     case REG0A:
-        handle.reg0A = (RDA_Reg0A)temp;
+        dev->reg0A = (RDA_Reg0A)temp;
         break;
     case REG0B:
-        handle.reg0B = (RDA_Reg0B)temp;
+        dev->reg0B = (RDA_Reg0B)temp;
         break;
     case REG0C:
-        handle.reg0C = (RDA_Reg0C)temp;
+        dev->reg0C = (RDA_Reg0C)temp;
         break;
     case REG0D:
-        handle.reg0D = (RDA_Reg0D)temp;
+        dev->reg0D = (RDA_Reg0D)temp;
         break;
     case REG0E:
-        handle.reg0E = (RDA_Reg0E)temp;
+        dev->reg0E = (RDA_Reg0E)temp;
         break;
     case REG0F:
-        handle.reg0F = (RDA_Reg0F)temp;
+        dev->reg0F = (RDA_Reg0F)temp;
         break;
     default:
         break;
     }
+    statusStamp(dev, 1 << (reg - REG0A));
+    return RDA_OK;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Gets all status registers (from 0x0A to 0x0F) in a single sequential read
+ * @details Uses the sequential access address (0x10). The chip always starts a sequential read at 0x0A,
+ * @details so no register address has to be written first and one bus transaction refreshes every status shadow register.
+ */
+RDA_Status getStatusBurst(RDA_Handle* dev)
+{
+    uint16_t temp[SH_REG0F + 1] = {};
+    RDA_Xfer xfer = {I2C_ADDR_FULL_ACCESS, RDA_XFER_READ, RDA_XFER_NO_REG, SH_REG0F + 1, temp};
+    RDA_Status status = xferRun(dev, &xfer);
+
+    if (status != RDA_OK)
+    {
+        return status; // Keep the last good values
+    }
+
+    dev->reg0A = (RDA_Reg0A)temp[SH_REG0A];
+    dev->reg0B = (RDA_Reg0B)temp[SH_REG0B];
+    dev->reg0C = (RDA_Reg0C)temp[SH_REG0C];
+    dev->reg0D = (RDA_Reg0D)temp[SH_REG0D];
+    dev->reg0E = (RDA_Reg0E)temp[SH_REG0E];
+    dev->reg0F = (RDA_Reg0F)temp[SH_REG0F];
+    // Reading the blocks clears RDSR, the REG0A just read is stale already
+    statusStamp(dev, ((1 << (SH_REG0F + 1)) - 1) & ~(1 << SH_REG0A));
+    return RDA_OK;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Gets REG0A and REG0B in one sequential read
+ */
+RDA_Status getSignal(RDA_Handle* dev)
+{
+    uint16_t temp[SH_REG0B + 1] = {};
+    RDA_Xfer xfer = {I2C_ADDR_FULL_ACCESS, RDA_XFER_READ, RDA_XFER_NO_REG, SH_REG0B + 1, temp};
+    RDA_Status status = xferRun(dev, &xfer);
+
+    if (status != RDA_OK)
+    {
+        return status; // Keep the last good values
+    }
+    dev->reg0A = (RDA_Reg0A)temp[SH_REG0A];
+    dev->reg0B = (RDA_Reg0B)temp[SH_REG0B];
+    statusStamp(dev, (1 << SH_REG0A) | (1 << SH_REG0B));
+    return RDA_OK;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Gets REG0A and/or REG0B for a getter
+ * @details Served from the shadow registers when all of them were read within the staleness window.
+ * @param mask bit SH_REG0A and/or SH_REG0B
+ */
+RDA_Status statusCached(RDA_Handle* dev, uint8_t mask)
+{
+#ifdef SYSTICK_DELAY
+    BOOL fresh = dev->cacheWindow && (dev->statusFresh & mask) == mask;
+    uint8_t i;
+
+    for (i = SH_REG0A; fresh && i <= SH_REG0B; i++)
+    {
+        fresh = !(mask & (1 << i)) || (getMillis() - dev->statusTime[i]) < dev->cacheWindow;
+    }
+    if (fresh)
+    {
+        dev->cacheStats.hits++;
+        return RDA_OK;
+    }
+#endif
+    dev->cacheStats.misses++;
+    switch (mask)
+    {
+    case 1 << SH_REG0A:
+        return getStatus(dev, REG0A);
+    case 1 << SH_REG0B:
+        return getStatus(dev, REG0B);
+    default:
+        return getSignal(dev);
+    }
+}
+
+/*
+ * Notes the end of the first tune or seek after the power-up, the station plays from there
+ */
+static void bootAudio(RDA_Handle* dev)
+{
+#ifdef SYSTICK_DELAY
+    if (!dev->bootTime)
+    {
+        dev->bootTime = getMillis() - dev->powerStarted;
+    }
+#endif
 }
 
 /**
  * @ingroup GA03
  * @brief Waits for Seek or Tune finish
+ * @details Gives up after TUNE_TIMEOUT ms (SysTick builds) or on a bus error. With the
+ * @details interrupt, STC is read at the deadline in case the EXTI edge was missed.
  */
-void waitAndFinishTune(I2C_TypeDef* I2Cx)
+RDA_Status waitAndFinishTune(RDA_Handle* dev)
 {
+    RDA_Status status;
+#ifdef SYSTICK_DELAY
+    uint32_t startMs = getMillis();
+#endif
+
+    dev->tunePolls = 0;
+    if (dev->reg04.refined.STCIEN)
+    {
+        // No bus traffic until GPIO2 reports completion
+        while (!dev->stcPending)
+        {
+            RDA_PROF_WAIT();
+            RDA_HAL_Idle();
+#ifdef SYSTICK_DELAY
+            if ((getMillis() - startMs) > TUNE_TIMEOUT)
+            {
+                // A missed EXTI edge does not fail a tune that completed, STC tells
+                dev->tunePolls++;
+                status = getStatus(dev, REG0A);
+                if (status != RDA_OK)
+                {
+                    return status;
+                }
+                if (dev->reg0A.refined.STC == 0)
+                {
+                    return RDA_TIMEOUT;
+                }
+                break;
+            }
+#endif
+        }
+        dev->reg0A.refined.STC = 1;
+        dev->reg03.refined.TUNE = 0;
+        bootAudio(dev);
+        return RDA_OK;
+    }
+
     do
 	{
-        getStatus(I2Cx, REG0A);
+        RDA_PROF_WAIT();
+        dev->tunePolls++;
+        status = getStatus(dev, REG0A);
+        if (status != RDA_OK)
+        {
+            return status;
+        }
 #ifdef SYSTICK_DELAY
+        if ((getMillis() - startMs) > TUNE_TIMEOUT)
+        {
+            return RDA_TIMEOUT;
+        }
         Delay(MIN_DELAY);
 #endif
     }
-	while (handle.reg0A.refined.STC == 0);
+	while (dev->reg0A.refined.STC == 0);
+    // The chip clears TUNE by itself, a later REG03 write must not tune again
+    dev->reg03.refined.TUNE = 0;
+    bootAudio(dev);
+    return RDA_OK;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Gets the first frequency of the current band in kHz
+ * @details Band 3 starts at 50 MHz instead of 65 MHz when MODE_50_60 of REG07 is cleared.
+ */
+uint32_t bandStart(RDA_Handle* dev)
+{
+    if (dev->currentFMBand == RDA_FM_BAND_SPECIAL && !dev->reg07.refined.MODE_50_60)
+    {
+        return 50000;
+    }
+    return startBand[dev->currentFMBand];
+}
+
+/**
+ * @ingroup GA03
+ * @brief Gets the last channel of the current band and space
+ */
+uint16_t lastChannel(RDA_Handle* dev)
+{
+    uint32_t last = (endBand[dev->currentFMBand] - bandStart(dev)) / fmSpace[dev->currentFMSpace];
+
+    return (last > CHAN_MAX) ? CHAN_MAX : last;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Converts a frequency in kHz to the nearest channel of the current band and space
+ */
+uint16_t frequencyToChannel(RDA_Handle* dev, uint32_t frequency)
+{
+    uint32_t start = bandStart(dev);
+    uint16_t space = fmSpace[dev->currentFMSpace];
+    uint32_t channel;
+
+    if (frequency <= start)
+    {
+        return 0;
+    }
+    channel = (frequency - start + space / 2) / space;
+    return (channel > lastChannel(dev)) ? lastChannel(dev) : channel;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Converts a channel of the current band and space to a frequency in kHz
+ */
+uint32_t channelToFrequency(RDA_Handle* dev, uint16_t channel)
+{
+    return bandStart(dev) + (uint32_t)channel * fmSpace[dev->currentFMSpace];
+}
+
+#ifdef SYSTICK_DELAY
+/*
+ * Tune/seek continuation, polls STC from the timer service until the operation is over
+ */
+static void tuneContinue(RDA_Timer* timer)
+{
+    RDA_Handle* dev = timer->context;
+
+    if (RDA_TunePoll(dev) == RDA_TUNE_IN_PROGRESS)
+    {
+        RDA_TimerStart(timer, dev->tuneSeeking ? SCAN_SEEK_POLL : MIN_DELAY, tuneContinue, dev);
+    }
+}
+#endif
+
+/*
+ * Checks the deadline of the asynchronous tune/seek: TUNE_TIMEOUT, SCAN_SEEK_TIMEOUT for a seek
+ */
+static BOOL tuneOverdue(RDA_Handle* dev)
+{
+#ifdef SYSTICK_DELAY
+    return (getMillis() - dev->tuneStarted) > (dev->tuneSeeking ? SCAN_SEEK_TIMEOUT : TUNE_TIMEOUT);
+#else
+    return FALSE;
+#endif
+}
+
+/**
+ * @ingroup GA03
+ * @brief Arms the asynchronous tune/seek state machine
+ * @details The first STC poll of the continuation is due when a tune usually is complete.
+ */
+void tuneStart(RDA_Handle* dev, RDA_TuneCallback callback, BOOL seeking)
+{
+    dev->tuneStatus = RDA_TUNE_IN_PROGRESS;
+    dev->tuneSeeking = seeking;
+    dev->tuneCallback = callback;
+    dev->tunePolls = 0;
+#ifdef SYSTICK_DELAY
+    dev->tuneStarted = getMillis();
+    dev->tuneLastPoll = dev->tuneStarted;
+    RDA_TimerStart(&dev->tuneTimer, seeking ? SCAN_SEEK_POLL : SCAN_TUNE_TIME, tuneContinue, dev);
+#endif
 }
 
 /**
  * @ingroup RDA_API
- * @brief Init the RDA chip
- * @param I2Cx I2C Port
+ * @brief Start the power-up of the RDA chip
+ * @param dev Device handle
+ * @param I2Cx I2C Port the chip is on
  */
-void RDA_Init(I2C_TypeDef* I2Cx)
+RDA_Status RDA_PowerUpStart(RDA_Handle* dev, RDA_BusTypeDef* I2Cx)
 {
+    RDA_PROF_API();
+    RDA_Status status;
+
+#ifdef SYSTICK_DELAY
+    // A handle initialised again must not leave its continuation in the timer list
+    RDA_TimerStop(&dev->tuneTimer);
+#endif
+    memset(dev, 0, sizeof(*dev));
+    dev->I2Cx = I2Cx;
+    dev->retries = I2C_RETRIES;
+    dev->cacheWindow = RDA_CACHE_WINDOW;
 #ifdef SYSTICK_DELAY
     Delay_Init();
     Delay(MIN_DELAY);
+    dev->powerStarted = getMillis();
+    dev->powerLastPoll = dev->powerStarted;
+#endif
+    dev->reg02.raw = 0x0;
+    dev->reg02.refined.NEW_METHOD = 0;
+    dev->reg02.refined.RDS_EN = 0; // RDS disable
+    dev->reg02.refined.CLK_MODE = CLOCK_32K;
+    dev->reg02.refined.RCLK_DIRECT_IN = OSCILLATOR_TYPE_CRYSTAL;
+    dev->reg02.refined.MONO = 1; // Force mono
+    dev->reg02.refined.DMUTE = 1; // Normal operation
+    dev->reg02.refined.DHIZ = 1; // Normal operation
+    dev->reg02.refined.ENABLE = 1;
+    dev->reg02.refined.BASS = 1;
+    dev->reg02.refined.SEEK = 0;
+    // ENABLE starts the crystal oscillator
+    status = registerWrite(dev, REG02, dev->reg02.raw);
+    if (status != RDA_OK)
+    {
+        return status;
+    }
+    dev->powerStatus = RDA_TUNE_IN_PROGRESS;
+    return RDA_OK;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Step the power-up of the RDA chip
+ * @param dev Device handle
+ * @return RDA_TuneStatus
+ */
+RDA_TuneStatus RDA_PowerUpPoll(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    if (dev->powerStatus != RDA_TUNE_IN_PROGRESS)
+    {
+        return RDA_TUNE_IDLE;
+    }
+#ifdef SYSTICK_DELAY
+    if ((getMillis() - dev->powerLastPoll) < POWER_POLL)
+    {
+        return RDA_TUNE_IN_PROGRESS;
+    }
+    dev->powerLastPoll = getMillis();
+#endif
+    if (getStatus(dev, REG0B) != RDA_OK)
+    {
+        dev->powerStatus = RDA_TUNE_IDLE;
+        return RDA_TUNE_ERROR;
+    }
+    if (!dev->reg0B.refined.FM_READY)
+    {
+#ifdef SYSTICK_DELAY
+        if ((getMillis() - dev->powerStarted) > MAX_DELAY_AFTER_OSCILLATOR)
+        {
+            dev->powerStatus = RDA_TUNE_IDLE;
+            dev->lastError = RDA_TIMEOUT;
+            return RDA_TUNE_ERROR;
+        }
+#endif
+        return RDA_TUNE_IN_PROGRESS;
+    }
+#ifdef SYSTICK_DELAY
+    dev->readyTime = getMillis() - dev->powerStarted;
 #endif
-    handle.reg02.raw = 0x0;
-    handle.reg02.refined.NEW_METHOD = 0;
-    handle.reg02.refined.RDS_EN = 0; // RDS disable
-    handle.reg02.refined.CLK_MODE = CLOCK_32K;
-    handle.reg02.refined.RCLK_DIRECT_IN = OSCILLATOR_TYPE_CRYSTAL;
-    handle.reg02.refined.MONO = 1; // Force mono
-    handle.reg02.refined.DMUTE = 1; // Normal operation
-    handle.reg02.refined.DHIZ = 1; // Normal operation
-    handle.reg02.refined.ENABLE = 1;
-    handle.reg02.refined.BASS = 1;
-    handle.reg02.refined.SEEK = 0;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
-    
-    handle.reg05.raw = 0x0;
-    handle.reg05.refined.INT_MODE = 0;
-    handle.reg05.refined.LNA_PORT_SEL = 2;
-    handle.reg05.refined.LNA_ICSEL_BIT = 0;
-    handle.reg05.refined.SEEKTH = 8; // 0B1000
-    handle.reg05.refined.VOLUME = 0;
-    registerWrite(I2Cx, REG05, handle.reg05.raw);
+
+    dev->reg05.raw = 0x0;
+    dev->reg05.refined.INT_MODE = 0;
+    dev->reg05.refined.LNA_PORT_SEL = 2;
+    dev->reg05.refined.LNA_ICSEL_BIT = 0;
+    dev->reg05.refined.SEEKTH = 8; // 0B1000
+    dev->reg05.refined.VOLUME = 0;
+    dev->reg07.raw = 0x4202; // Power-on value, not written: MODE_50_60 = 1 (band 3 is 65-76 MHz)
+    dev->powerStatus = RDA_TUNE_IDLE;
+    return (registerWrite(dev, REG05, dev->reg05.raw) == RDA_OK) ? RDA_TUNE_DONE : RDA_TUNE_ERROR;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Init the RDA chip
+ * @param dev Device handle
+ * @param I2Cx I2C Port the chip is on
+ */
+RDA_Status RDA_Init(RDA_Handle* dev, RDA_BusTypeDef* I2Cx)
+{
+    RDA_PROF_API();
+    RDA_Status status = RDA_PowerUpStart(dev, I2Cx);
+    RDA_TuneStatus power;
+
+    if (status != RDA_OK)
+    {
+        return status;
+    }
+    while ((power = RDA_PowerUpPoll(dev)) == RDA_TUNE_IN_PROGRESS)
+    {
+        RDA_PROF_WAIT();
+        RDA_HAL_Idle();
+    }
+    return (power == RDA_TUNE_DONE) ? RDA_OK : dev->lastError;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the boot-to-first-audio time of RDA chip
+ * @param dev Device handle
+ */
+uint32_t RDA_GetBootTime(RDA_Handle* dev)
+{
+    return dev->bootTime;
 }
 
 /**
  * @ingroup RDA_API
  * @brief De-Init the RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-void RDA_DeInit(I2C_TypeDef* I2Cx)
+RDA_Status RDA_DeInit(RDA_Handle* dev)
 {
-    handle.reg02.refined.SEEK = 0;
-	handle.reg02.refined.ENABLE = 0;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    dev->reg02.refined.SEEK = 0;
+	dev->reg02.refined.ENABLE = 0;
+    return registerUpdate(dev, REG02);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Soft reset the RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-void RDA_SoftReset(I2C_TypeDef* I2Cx)
+RDA_Status RDA_SoftReset(RDA_Handle* dev)
 {
-    handle.reg02.refined.SOFT_RESET = 1;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    RDA_Status status;
+
+    // A pulse: left set in the shadow, every later REG02 write would reset the chip again
+    dev->reg02.refined.SOFT_RESET = 1;
+    status = registerWrite(dev, REG02, shadowValue(dev, REG02, FALSE));
+    dev->reg02.refined.SOFT_RESET = 0;
+    return status;
 }
 
 /**
  * @ingroup RDA_API (Internal)
  * @brief Set channel on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param channel channel
  */
-void RDA_SetChannel(I2C_TypeDef* I2Cx, uint16_t channel)
+RDA_Status RDA_SetChannel(RDA_Handle* dev, uint16_t channel)
 {
-    handle.reg03.refined.CHAN = channel;
-    handle.reg03.refined.TUNE = 1;
-    handle.reg03.refined.BAND = 0;
-    handle.reg03.refined.SPACE = 0;
-    handle.reg03.refined.DIRECT_MODE = 0;
-    registerWrite(I2Cx, REG03, handle.reg03.raw);
-    waitAndFinishTune(I2Cx);
+    RDA_PROF_API();
+    RDA_Status status;
+
+    dev->stcPending = FALSE;
+    dev->reg03.refined.CHAN = channel;
+    dev->reg03.refined.TUNE = 1;
+    dev->reg03.refined.BAND = dev->currentFMBand;
+    dev->reg03.refined.SPACE = dev->currentFMSpace;
+    dev->reg03.refined.DIRECT_MODE = 0;
+    status = registerUpdate(dev, REG03);
+    if (status != RDA_OK || dev->batchUpdate)
+    {
+        return status;
+    }
+    return waitAndFinishTune(dev);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set frequency on RDA chip
- * @param I2Cx I2C Port
- * @param frequency frequency
+ * @param dev Device handle
+ * @param frequency frequency in kHz
  */
-void RDA_Tune(I2C_TypeDef* I2Cx, uint16_t frequency)
+RDA_Status RDA_Tune(RDA_Handle* dev, uint32_t frequency)
 {
-    uint16_t channel = (frequency - startBand[handle.currentFMBand] ) / (fmSpace[handle.currentFMSpace] / 10.0);
-    RDA_SetChannel(I2Cx, channel);
-    handle.currentFrequency = frequency;
+    RDA_PROF_API();
+    uint16_t channel = frequencyToChannel(dev, frequency);
+
+    // The chip tunes the nearest channel, the manual steps go on from there
+    dev->currentFrequency = channelToFrequency(dev, channel);
+    return RDA_SetChannel(dev, channel);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Call manual seek down on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-void RDA_ManualDown(I2C_TypeDef* I2Cx)
+RDA_Status RDA_ManualDown(RDA_Handle* dev)
 {
-    if (handle.currentFrequency < endBand[handle.currentFMBand])
+    RDA_PROF_API();
+    if (dev->currentFrequency < channelToFrequency(dev, lastChannel(dev)))
     {
-        handle.currentFrequency += (fmSpace[handle.currentFMSpace] / 10.0);
+        dev->currentFrequency += fmSpace[dev->currentFMSpace];
     }
     else
     {
-        handle.currentFrequency = startBand[handle.currentFMBand];
+        dev->currentFrequency = bandStart(dev);
     }
-    RDA_Tune(I2Cx, handle.currentFrequency);
+    return RDA_Tune(dev, dev->currentFrequency);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Call manual seek up on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-void RDA_ManualUp(I2C_TypeDef* I2Cx)
+RDA_Status RDA_ManualUp(RDA_Handle* dev)
 {
-    if (handle.currentFrequency > startBand[handle.currentFMBand])
+    RDA_PROF_API();
+    if (dev->currentFrequency > bandStart(dev))
     {
-        handle.currentFrequency -= (fmSpace[handle.currentFMSpace] / 10.0);
+        dev->currentFrequency -= fmSpace[dev->currentFMSpace];
     }
     else
     {
-        handle.currentFrequency = endBand[handle.currentFMBand];
+        dev->currentFrequency = channelToFrequency(dev, lastChannel(dev));
     }
-    RDA_Tune(I2Cx, handle.currentFrequency);
+    return RDA_Tune(dev, dev->currentFrequency);
 }
 
 /**
  * @ingroup RDA_API (Internal)
  * @brief Get real channel on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-uint16_t RDA_GetRealChannel(I2C_TypeDef* I2Cx)
+uint16_t RDA_GetRealChannel(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0A);
-    return handle.reg0A.refined.READCHAN;
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0A);
+    return dev->reg0A.refined.READCHAN;
 }
 
 /**
@@ -385,45 +862,49 @@ uint16_t RDA_GetRealChannel(I2C_TypeDef* I2Cx)
  * | ------ | ------- | 
  * |    0   | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 87.0 MHz |
  * | 1 or 2 | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 76.0 MHz |
- * |    3   | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 65.0 MHz |
- * @param I2Cx I2C Port
+ * |    3   | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 65.0 MHz (50.0 MHz when MODE_50_60 = 0) |
+ * @param dev Device handle
  */
-uint16_t RDA_GetRealFrequency(I2C_TypeDef* I2Cx)
+uint32_t RDA_GetRealFrequency(RDA_Handle* dev)
 {
-    return (RDA_GetRealChannel(I2Cx) * (fmSpace[handle.currentFMSpace] / 10.0) + startBand[handle.currentFMBand]);
+    RDA_PROF_API();
+    return channelToFrequency(dev, RDA_GetRealChannel(dev));
 }
 
 /**
  * @ingroup RDA_API
  * @brief Call seek on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param seek_mode if 0, wrap at the upper or lower band limit and continue seeking; 1 = stop seeking at the upper or lower band limit
  * @param direction if 0, seek down; if 1, seek up.
  */
-void RDA_Seek(I2C_TypeDef* I2Cx, uint8_t seek_mode, uint8_t direction)
+RDA_Status RDA_Seek(RDA_Handle* dev, uint8_t seek_mode, uint8_t direction)
 {
-    handle.reg02.refined.SEEK = 1;
-    handle.reg02.refined.SKMODE = seek_mode;
-    handle.reg02.refined.SEEKUP = direction;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    dev->stcPending = FALSE;
+    dev->reg02.refined.SEEK = 1;
+    dev->reg02.refined.SKMODE = seek_mode;
+    dev->reg02.refined.SEEKUP = direction;
+    return registerUpdate(dev, REG02);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set seek threshold on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value RSSI threshold
  */
-void RDA_SetSeekThreshold(I2C_TypeDef* I2Cx, uint8_t value)
+RDA_Status RDA_SetSeekThreshold(RDA_Handle* dev, uint8_t value)
 {
-    handle.reg05.refined.SEEKTH = value;
-    registerWrite(I2Cx, REG05, handle.reg05.raw);
+    RDA_PROF_API();
+    dev->reg05.refined.SEEKTH = value;
+    return registerUpdate(dev, REG05);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set FM band on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param band FM band
  * | Value | Description                 |
  * | ----- | --------------------------- |
@@ -432,16 +913,18 @@ void RDA_SetSeekThreshold(I2C_TypeDef* I2Cx, uint8_t value)
  * | 10    | 76–108 MHz (world wide)     |
  * | 11    | 65 –76 MHz (East Europe) or 50-65MHz (see bit 9 of gegister 0x06) |
  */
-void RDA_SetBand(I2C_TypeDef* I2Cx, uint8_t band)
+RDA_Status RDA_SetBand(RDA_Handle* dev, uint8_t band)
 {
-    handle.reg03.refined.BAND = band;
-    registerWrite(I2Cx, REG03, handle.reg03.raw);
+    RDA_PROF_API();
+    dev->reg03.refined.BAND = band;
+    dev->currentFMBand = band;
+    return registerUpdate(dev, REG03);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set FM space on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param space FM space
  * | Value | Description |
  * | ----- | ----------- |
@@ -450,260 +933,1599 @@ void RDA_SetBand(I2C_TypeDef* I2Cx, uint8_t band)
  * | 10    | 50KHz       |
  * | 11    | 25KHz       |
  */
-void RDA_SetSpace(I2C_TypeDef* I2Cx, uint8_t space)
+RDA_Status RDA_SetSpace(RDA_Handle* dev, uint8_t space)
 {
-    handle.reg03.refined.SPACE = space;
-    registerWrite(I2Cx, REG03, handle.reg03.raw);
+    RDA_PROF_API();
+    dev->reg03.refined.SPACE = space;
+    dev->currentFMSpace = space;
+    return registerUpdate(dev, REG03);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get the current RSSI
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @details RSSI - 000000(Min) 111111(Max) RSSI scale is logarithmic.
  * @return int32_t
  */
-int32_t RDA_GetQuality(I2C_TypeDef* I2Cx)
+int32_t RDA_GetQuality(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0B);
-    return handle.reg0B.refined.RSSI;
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0B);
+    return dev->reg0B.refined.RSSI;
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set FM soft mute on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetSoftMute(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetSoftMute(RDA_Handle* dev, BOOL value)
 {
-    handle.reg04.refined.SOFTMUTE_EN = value;
-    registerWrite(I2Cx, REG04, handle.reg04.raw);
+    RDA_PROF_API();
+    dev->reg04.refined.SOFTMUTE_EN = value;
+    return registerUpdate(dev, REG04);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set FM mute on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetMute(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetMute(RDA_Handle* dev, BOOL value)
 {
-    handle.reg02.refined.SEEK = 0;    
-    handle.reg02.refined.DHIZ = !value;
-    registerWrite(I2Cx, REG02, handle.reg02.raw); 
+    RDA_PROF_API();
+    dev->reg02.refined.SEEK = 0;    
+    dev->reg02.refined.DHIZ = !value;
+    return registerUpdate(dev, REG02);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set mono on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetMono(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetMono(RDA_Handle* dev, BOOL value)
 {
-    handle.reg02.refined.SEEK = 0;
-    handle.reg02.refined.MONO = value;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    dev->reg02.refined.SEEK = 0;
+    dev->reg02.refined.MONO = value;
+    return registerUpdate(dev, REG02);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set bass on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetBass(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetBass(RDA_Handle* dev, BOOL value)
 {
-    handle.reg02.refined.SEEK = 0;
-    handle.reg02.refined.BASS = value;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    dev->reg02.refined.SEEK = 0;
+    dev->reg02.refined.BASS = value;
+    return registerUpdate(dev, REG02);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get mono status on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return value TRUE/FALSE
  */
-BOOL RDA_GetSterioStatus(I2C_TypeDef* I2Cx)
+BOOL RDA_GetSterioStatus(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0A);
-    return handle.reg0A.refined.ST;
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0A);
+    return dev->reg0A.refined.ST;
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set volume on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value 0-15 levels
  */
-void RDA_SetVolume(I2C_TypeDef* I2Cx, uint8_t value)
+RDA_Status RDA_SetVolume(RDA_Handle* dev, uint8_t value)
 {
+    RDA_PROF_API();
     value > 15 ? value = 15 : value;
-    handle.reg05.refined.VOLUME = handle.currentVolume = value;
-    registerWrite(I2Cx, REG05, handle.reg05.raw);
+    dev->reg05.refined.VOLUME = dev->currentVolume = value;
+    return registerUpdate(dev, REG05);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get internal volume on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return uint8_t 0-15 levels
  */
-uint8_t RDA_GetVolume(I2C_TypeDef* I2Cx)
+uint8_t RDA_GetVolume(RDA_Handle* dev)
 {
-    return(handle.currentVolume);
+    return(dev->currentVolume);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Call volume up on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-void RDA_SetVolumeUp(I2C_TypeDef* I2Cx)
+RDA_Status RDA_SetVolumeUp(RDA_Handle* dev)
 {
-    if (handle.currentVolume < 15)
+    RDA_PROF_API();
+    if (dev->currentVolume < 15)
     {
-        handle.currentVolume++;
-        RDA_SetVolume(I2Cx, handle.currentVolume);
+        dev->currentVolume++;
+        return RDA_SetVolume(dev, dev->currentVolume);
     }
+    return RDA_OK;
 }
 
 /**
  * @ingroup RDA_API
  * @brief Call volume down on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  */
-void RDA_SetVolumeDown(I2C_TypeDef* I2Cx)
+RDA_Status RDA_SetVolumeDown(RDA_Handle* dev)
 {
-    if (handle.currentVolume > 0)
+    RDA_PROF_API();
+    if (dev->currentVolume > 0)
     {
-        handle.currentVolume--;
-        RDA_SetVolume(I2Cx, handle.currentVolume);
+        dev->currentVolume--;
+        return RDA_SetVolume(dev, dev->currentVolume);
     }
+    return RDA_OK;
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set FM De-Emphasis on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param deEmphasis deEmphasis
  */
-void RDA_SetFMDeEmphasis(I2C_TypeDef* I2Cx, uint8_t deEmphasis)
+RDA_Status RDA_SetFMDeEmphasis(RDA_Handle* dev, uint8_t deEmphasis)
 {
-    handle.reg04.refined.DE = deEmphasis;
-    registerWrite(I2Cx, REG04, handle.reg04.raw);
+    RDA_PROF_API();
+    dev->reg04.refined.DE = deEmphasis;
+    return registerUpdate(dev, REG04);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set RDS on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetRDS(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetRDS(RDA_Handle* dev, BOOL value)
 {
-    handle.reg02.refined.SEEK = 0;
-    handle.reg02.refined.RDS_EN = value;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    dev->reg02.refined.SEEK = 0;
+    dev->reg02.refined.RDS_EN = value;
+    return registerUpdate(dev, REG02);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set RBDS on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetRBDS(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetRBDS(RDA_Handle* dev, BOOL value)
 {
-    handle.reg02.refined.SEEK = 0;
-    handle.reg02.refined.RDS_EN = 1;
-    registerWrite(I2Cx, REG02, handle.reg02.raw);
+    RDA_PROF_API();
+    BOOL nested = dev->batchUpdate;
+
+    // REG02 and REG04 go out in one sequential write
+    RDA_BeginUpdate(dev);
+    dev->reg02.refined.SEEK = 0;
+    dev->reg02.refined.RDS_EN = 1;
+    registerUpdate(dev, REG02);
 
-    handle.reg04.refined.RBDS = value;
-    registerWrite(I2Cx, REG04, handle.reg04.raw);
+    dev->reg04.refined.RBDS = value;
+    registerUpdate(dev, REG04);
+    return nested ? RDA_OK : RDA_CommitUpdate(dev);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get RDS Ready on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return TRUE/FALSE
  */
-BOOL RDA_GetRDSReady(I2C_TypeDef* I2Cx)
+BOOL RDA_GetRDSReady(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0A);
-    return(handle.reg0A.refined.RDSR);
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0A);
+    return(dev->reg0A.refined.RDSR);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get RDS Sync on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return TRUE/FALSE
  */
-BOOL RDA_GetRDSSync(I2C_TypeDef* I2Cx)
+BOOL RDA_GetRDSSync(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0A);
-    return handle.reg0A.refined.RDSS;
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0A);
+    return dev->reg0A.refined.RDSS;
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get Block ID on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return uint8_t
+ */
+uint8_t RDA_GetBlockId(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0B);
+    return dev->reg0B.refined.ABCD_E;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the error level of RDS block A on RDA chip
+ * @param dev Device handle
  * @return uint8_t
  */
-uint8_t RDA_GetBlockId(I2C_TypeDef* I2Cx)
+uint8_t RDA_GetErrorBlockA(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0B);
-    return handle.reg0B.refined.ABCD_E;
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0B);
+    return dev->reg0B.refined.BLERA;
 }
 
 /**
  * @ingroup RDA_API
- * @brief Set volume down on RDA chip
- * @param I2Cx I2C Port
+ * @brief Get the error level of RDS block B on RDA chip
+ * @param dev Device handle
  * @return uint8_t
  */
-uint8_t RDA_GetErrorBlockB(I2C_TypeDef* I2Cx)
+uint8_t RDA_GetErrorBlockB(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0B);
-    return handle.reg0B.refined.BLERB;
+    RDA_PROF_API();
+    statusCached(dev, 1 << SH_REG0B);
+    return dev->reg0B.refined.BLERB;
 }
 
 /**
  * @ingroup RDA_API
  * @brief Get RDS info state on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return TRUE/FALSE
  */
-BOOL RDA_GetRDSInfoState(I2C_TypeDef* I2Cx)
+BOOL RDA_GetRDSInfoState(RDA_Handle* dev)
 {
-    getStatus(I2Cx, REG0B);
-    return(handle.reg0A.refined.RDSS && handle.reg0B.refined.ABCD_E == 0 && handle.reg0B.refined.BLERB == 0);
+    RDA_PROF_API();
+    statusCached(dev, (1 << SH_REG0A) | (1 << SH_REG0B));
+    return(dev->reg0A.refined.RDSS && dev->reg0B.refined.ABCD_E == 0 && dev->reg0B.refined.BLERB == 0);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Set RDS FIFO on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
  */
-void RDA_SetRDSFifo(I2C_TypeDef* I2Cx, BOOL value)
+RDA_Status RDA_SetRDSFifo(RDA_Handle* dev, BOOL value)
 {
-    handle.reg04.refined.RDS_FIFO_EN = value;
-    registerWrite(I2Cx, REG04, handle.reg04.raw);
+    RDA_PROF_API();
+    dev->reg04.refined.RDS_FIFO_EN = value;
+    return registerUpdate(dev, REG04);
 }
 
 /**
  * @ingroup RDA_API
  * @brief Call clear RDS FIFO on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ */
+RDA_Status RDA_ClearRDSFifo(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    dev->reg04.refined.RDS_FIFO_CLR = 1;
+    return registerUpdate(dev, REG04);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Refresh all status registers (0x0A to 0x0F) on RDA chip
+ * @param dev Device handle
  */
-void RDA_ClearRDSFifo(I2C_TypeDef* I2Cx)
+RDA_Status RDA_RefreshStatus(RDA_Handle* dev)
 {
-    handle.reg04.refined.RDS_FIFO_CLR = 1;
-    registerWrite(I2Cx, REG04, handle.reg04.raw);
+    RDA_PROF_API();
+    return getStatusBurst(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the RDS blocks of the last status refresh
+ * @details Served from the shadow registers, no bus access. Call RDA_RefreshStatus first.
+ * @param dev Device handle
+ * @param blocks array of 4 words, filled with blocks A, B, C and D
+ */
+void RDA_GetRDSBlocks(RDA_Handle* dev, uint16_t* blocks)
+{
+    blocks[0] = dev->reg0C.RDSA;
+    blocks[1] = dev->reg0D.RDSB;
+    blocks[2] = dev->reg0E.RDSC;
+    blocks[3] = dev->reg0F.RDSD;
+}
+
+/*
+ * Bits of a writable register the read-back is compared on, the chip clears the others by itself
+ */
+static uint16_t verifyMask(uint8_t reg)
+{
+    RDA_Reg02 reg02 = {.raw = 0xFFFF};
+    RDA_Reg03 reg03 = {.raw = 0xFFFF};
+    RDA_Reg04 reg04 = {.raw = 0xFFFF};
+
+    switch (reg)
+    {
+    case REG02:
+        reg02.refined.SOFT_RESET = 0;
+        reg02.refined.SEEK = 0;
+        return reg02.raw;
+    case REG03:
+        reg03.refined.TUNE = 0;
+        return reg03.raw;
+    case REG04:
+        reg04.refined.RDS_FIFO_CLR = 0;
+        return reg04.raw;
+    default:
+        return 0xFFFF;
+    }
+}
+
+/*
+ * Reads REG02-REG07 back and compares them with the shadow registers
+ */
+static RDA_Status verifyRead(RDA_Handle* dev, uint16_t* chip, uint8_t* diverged)
+{
+    RDA_Xfer xfer = {I2C_ADDR_DIRECT_ACCESS, RDA_XFER_READ, REG02, REG07 - REG02 + 1, chip};
+    RDA_Status status = xferRun(dev, &xfer);
+    uint8_t reg;
+
+    *diverged = 0;
+    if (status != RDA_OK)
+    {
+        return status;
+    }
+    dev->cacheStats.verifies++;
+    for (reg = REG02; reg <= REG07; reg++)
+    {
+        if ((chip[reg - REG02] ^ shadowValue(dev, reg, FALSE)) & verifyMask(reg))
+        {
+            *diverged |= 1 << reg;
+        }
+    }
+    return RDA_OK;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the staleness window of the status getters of RDA chip
+ * @param dev Device handle
+ * @param window ms, 0 = read the chip on every call
+ */
+void RDA_SetCacheWindow(RDA_Handle* dev, uint16_t window)
+{
+    dev->cacheWindow = window;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Compare the writable registers of RDA chip with the shadow registers
+ * @param dev Device handle
+ * @param diverged Filled with a bit per register that differs
+ */
+RDA_Status RDA_Verify(RDA_Handle* dev, uint8_t* diverged)
+{
+    RDA_PROF_API();
+    uint16_t chip[REG07 - REG02 + 1];
+
+    return verifyRead(dev, chip, diverged);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Bring RDA chip back in line with the shadow registers
+ * @param dev Device handle
+ */
+RDA_Status RDA_Resync(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    uint16_t chip[REG07 - REG02 + 1];
+    RDA_Reg02 reg02;
+    uint8_t diverged;
+    RDA_Status status;
+#ifdef SYSTICK_DELAY
+    uint32_t start;
+#endif
+
+    if (dev->tuneStatus == RDA_TUNE_IN_PROGRESS || dev->scanPhase != SCAN_IDLE || dev->batchUpdate)
+    {
+        return RDA_ERROR;
+    }
+    status = verifyRead(dev, chip, &diverged);
+    if (status != RDA_OK || !diverged)
+    {
+        return status;
+    }
+    dev->cacheStats.resyncs++;
+    reg02.raw = chip[REG02 - REG02];
+    if (!reg02.refined.ENABLE)
+    {
+        // Lost power or reset: the oscillator starts again before anything is tuned
+        status = registerWrite(dev, REG02, shadowValue(dev, REG02, FALSE));
+#ifdef SYSTICK_DELAY
+        start = getMillis();
+#endif
+        while (status == RDA_OK)
+        {
+            RDA_PROF_WAIT();
+#ifdef SYSTICK_DELAY
+            Delay(POWER_POLL);
+#endif
+            status = getStatus(dev, REG0B);
+            if (status != RDA_OK || dev->reg0B.refined.FM_READY)
+            {
+                break;
+            }
+#ifdef SYSTICK_DELAY
+            if ((getMillis() - start) > MAX_DELAY_AFTER_OSCILLATOR)
+            {
+                dev->lastError = RDA_TIMEOUT;
+                return RDA_TIMEOUT;
+            }
+#endif
+        }
+        if (status != RDA_OK)
+        {
+            return status;
+        }
+        diverged |= 1 << REG03;
+    }
+    if (!(diverged & (1 << REG03)))
+    {
+        return registerWriteBurst(dev, REG07, 0);
+    }
+    // The channel is lost, tune it again
+    dev->stcPending = FALSE;
+    dev->reg03.refined.TUNE = 1;
+    status = registerWriteBurst(dev, REG07, 1 << REG03);
+    if (status != RDA_OK)
+    {
+        return status;
+    }
+    return waitAndFinishTune(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the status cache and verification counters of RDA chip
+ * @param dev Device handle
+ * @param stats Filled with the counters
+ */
+void RDA_GetCacheStats(RDA_Handle* dev, RDA_CacheStats* stats)
+{
+    *stats = dev->cacheStats;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Start a batched register update on RDA chip
+ * @details Setters called until RDA_CommitUpdate only update the shadow registers.
+ * @param dev Device handle
+ */
+void RDA_BeginUpdate(RDA_Handle* dev)
+{
+    dev->batchUpdate = TRUE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Write all registers changed since RDA_BeginUpdate to RDA chip
+ * @details One sequential write from 0x02 up to the highest dirty register, one settle delay.
+ * @details A pending tune is waited for, as RDA_Tune would do.
+ * @param dev Device handle
+ */
+RDA_Status RDA_CommitUpdate(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    uint8_t dirty = dev->dirtyRegisters;
+    uint8_t lastReg = REG07;
+    RDA_Status status;
+
+    dev->batchUpdate = FALSE;
+    dev->dirtyRegisters = 0;
+    if (!dirty)
+    {
+        return RDA_OK;
+    }
+    while (!(dirty & (1 << lastReg)))
+    {
+        lastReg--;
+    }
+    status = registerWriteBurst(dev, lastReg, dirty);
+    if (status == RDA_OK && (dirty & (1 << REG03)) && dev->reg03.refined.TUNE)
+    {
+        status = waitAndFinishTune(dev);
+    }
+    return status;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the receiver settings of RDA chip for the preset store
+ * @param dev Device handle
+ * @param state Filled with the settings
+ */
+void RDA_GetState(RDA_Handle* dev, RDA_StoreEntry* state)
+{
+    state->frequency = dev->currentFrequency;
+    state->band = dev->currentFMBand;
+    state->space = dev->currentFMSpace;
+    state->volume = dev->currentVolume;
+    state->flags = (dev->reg02.refined.BASS ? RDA_STORE_BASS : 0) | (dev->reg02.refined.MONO ? RDA_STORE_MONO : 0);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Restore stored receiver settings on RDA chip
+ * @param dev Device handle
+ * @param state Settings
+ */
+RDA_Status RDA_RestoreState(RDA_Handle* dev, const RDA_StoreEntry* state)
+{
+    RDA_PROF_API();
+    BOOL nested = dev->batchUpdate;
+
+    RDA_BeginUpdate(dev);
+    RDA_SetBand(dev, state->band);
+    RDA_SetSpace(dev, state->space);
+    RDA_SetVolume(dev, state->volume);
+    RDA_SetBass(dev, (state->flags & RDA_STORE_BASS) ? TRUE : FALSE);
+    RDA_SetMono(dev, (state->flags & RDA_STORE_MONO) ? TRUE : FALSE);
+    RDA_Tune(dev, state->frequency);
+    return nested ? RDA_OK : RDA_CommitUpdate(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Start tuning a frequency on RDA chip without waiting for completion
+ * @details Drive the operation with RDA_TunePoll from the main loop, or let the timer service
+ * @details (RDA_TimerRun/RDA_TimerSleep) poll STC for it. Refused with RDA_ERROR between
+ * @details RDA_BeginUpdate and RDA_CommitUpdate, where the register write would only be deferred.
+ * @param dev Device handle
+ * @param frequency frequency in kHz
+ * @param callback called once when the tune completes, may be NULL
+ */
+RDA_Status RDA_TuneAsync(RDA_Handle* dev, uint32_t frequency, RDA_TuneCallback callback)
+{
+    RDA_PROF_API();
+    RDA_Status status;
+
+    if (dev->batchUpdate)
+    {
+        return RDA_ERROR;
+    }
+    dev->stcPending = FALSE;
+    dev->reg03.refined.CHAN = frequencyToChannel(dev, frequency);
+    dev->reg03.refined.TUNE = 1;
+    dev->reg03.refined.BAND = dev->currentFMBand;
+    dev->reg03.refined.SPACE = dev->currentFMSpace;
+    dev->reg03.refined.DIRECT_MODE = 0;
+    status = registerUpdate(dev, REG03);
+    if (status != RDA_OK)
+    {
+        return status;
+    }
+    dev->currentFrequency = channelToFrequency(dev, dev->reg03.refined.CHAN);
+    tuneStart(dev, callback, FALSE);
+    return RDA_OK;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Start a seek on RDA chip and track its completion
+ * @details Drive the operation with RDA_TunePoll from the main loop, or let the timer service
+ * @details (RDA_TimerRun/RDA_TimerSleep) poll STC for it. Refused with RDA_ERROR between
+ * @details RDA_BeginUpdate and RDA_CommitUpdate, where the register write would only be deferred.
+ * @param dev Device handle
+ * @param seek_mode if 0, wrap at the upper or lower band limit and continue seeking; 1 = stop seeking at the upper or lower band limit
+ * @param direction if 0, seek down; if 1, seek up.
+ * @param callback called once when the seek completes, may be NULL
+ */
+RDA_Status RDA_SeekAsync(RDA_Handle* dev, uint8_t seek_mode, uint8_t direction, RDA_TuneCallback callback)
+{
+    RDA_PROF_API();
+    RDA_Status status;
+
+    if (dev->batchUpdate)
+    {
+        return RDA_ERROR;
+    }
+    status = RDA_Seek(dev, seek_mode, direction);
+    if (status != RDA_OK)
+    {
+        return status;
+    }
+    tuneStart(dev, callback, TRUE);
+    return RDA_OK;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Step the asynchronous tune/seek on RDA chip
+ * @details Reads REG0A at most once every MIN_DELAY ms while an operation is pending. A tune that
+ * @details has not completed after TUNE_TIMEOUT ms (a seek after SCAN_SEEK_TIMEOUT ms) fails with
+ * @details RDA_TIMEOUT; with the interrupt enabled STC is read then, in case the EXTI edge was missed.
+ * @details On completion or bus error the callback is invoked and the final status is returned once,
+ * @details after that the state goes back to RDA_TUNE_IDLE.
+ * @param dev Device handle
+ * @return RDA_TuneStatus
+ */
+RDA_TuneStatus RDA_TunePoll(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    RDA_TuneStatus status;
+
+    if (dev->tuneStatus != RDA_TUNE_IN_PROGRESS)
+    {
+        return RDA_TUNE_IDLE;
+    }
+    if (dev->reg04.refined.STCIEN)
+    {
+        // Interrupt driven, a single REG0A read once GPIO2 fired. Past the deadline STC is
+        // read anyway, so a missed EXTI edge does not wedge the operation
+        if (!dev->stcPending && !tuneOverdue(dev))
+        {
+            return RDA_TUNE_IN_PROGRESS;
+        }
+    }
+#ifdef SYSTICK_DELAY
+    else if ((getMillis() - dev->tuneLastPoll) < MIN_DELAY)
+    {
+        return RDA_TUNE_IN_PROGRESS;
+    }
+    dev->tuneLastPoll = getMillis();
+#endif
+    dev->tunePolls++;
+    if (getStatus(dev, REG0A) != RDA_OK)
+    {
+        status = RDA_TUNE_ERROR;
+    }
+    else if (dev->reg0A.refined.STC == 0)
+    {
+        if (!tuneOverdue(dev))
+        {
+            return RDA_TUNE_IN_PROGRESS;
+        }
+        dev->lastError = RDA_TIMEOUT;
+        status = RDA_TUNE_ERROR;
+    }
+    else
+    {
+        status = RDA_TUNE_DONE;
+    }
+    if (status == RDA_TUNE_DONE)
+    {
+        dev->reg03.refined.TUNE = 0;
+        bootAudio(dev);
+    }
+    if (status == RDA_TUNE_DONE && dev->tuneSeeking)
+    {
+        // The chip clears SEEK by itself, keep the shadow in sync
+        dev->reg02.refined.SEEK = 0;
+        dev->currentFrequency = channelToFrequency(dev, dev->reg0A.refined.READCHAN);
+        if (dev->reg0A.refined.SF)
+        {
+            status = RDA_TUNE_SEEK_FAIL;
+        }
+    }
+    dev->tuneStatus = RDA_TUNE_IDLE;
+#ifdef SYSTICK_DELAY
+    RDA_TimerStop(&dev->tuneTimer);
+#endif
+    if (dev->tuneCallback)
+    {
+        dev->tuneCallback(dev, status);
+    }
+    return status;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Enable the seek/tune complete interrupt on GPIO2 of RDA chip
+ * @details GPIO2 pulses low for 5 ms when a seek or tune completes. The application routes
+ * @details the pin to an EXTI line and calls RDA_NotifySTC from the handler.
+ * @param dev Device handle
+ * @param value TRUE/FALSE
+ */
+RDA_Status RDA_SetTuneInterrupt(RDA_Handle* dev, BOOL value)
+{
+    RDA_PROF_API();
+    BOOL nested = dev->batchUpdate;
+
+    RDA_BeginUpdate(dev);
+    dev->reg04.refined.STCIEN = value;
+    dev->reg04.refined.GPIO2 = value ? 1 : 0; // 01 = Interrupt output
+    registerUpdate(dev, REG04);
+
+    dev->reg05.refined.INT_MODE = 0; // 5 ms pulse
+    registerUpdate(dev, REG05);
+    return nested ? RDA_OK : RDA_CommitUpdate(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Notify the driver that GPIO2 signalled seek/tune complete
+ * @details Safe to call from interrupt context, no bus access.
+ * @param dev Device handle
+ */
+void RDA_NotifySTC(RDA_Handle* dev)
+{
+    dev->stcPending = TRUE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the number of REG0A reads made waiting for the last tune or seek
+ * @details Each read is two bus transactions.
+ * @param dev Device handle
+ * @return uint32_t
+ */
+uint32_t RDA_GetTunePolls(RDA_Handle* dev)
+{
+    return dev->tunePolls;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the transfer queue register accesses of RDA chip go through
+ * @details Use it to queue asynchronous transfers or to init a port with it.
+ * @param dev Device handle
+ * @return RDA_XferQueue*
+ */
+RDA_XferQueue* RDA_GetXferQueue(RDA_Handle* dev)
+{
+    return &dev->queue;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Install the transfer port used for RDA chip register accesses
+ * @details Default is a polled port on the I2C port of the device. Call with no transfer pending.
+ * @param dev Device handle
+ * @param port Port operations, e.g. RDA_XferPortSTM32
+ * @param context Port state passed to the operations
+ */
+void RDA_SetXferPort(RDA_Handle* dev, const RDA_XferPort* port, void* context)
+{
+    RDA_XferInit(&dev->queue, port, context);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the bus retry budget of RDA chip register accesses
+ * @details A failed transfer recovers the bus (SCL clock-out, peripheral re-init) before each retry.
+ * @param dev Device handle
+ * @param retries retries per transfer, 0 = fail on first error
+ */
+void RDA_SetRetries(RDA_Handle* dev, uint8_t retries)
+{
+    dev->retries = retries;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the result of the last bus transfer to RDA chip
+ * @details Useful after getters, which cannot return a status.
+ * @param dev Device handle
+ * @return RDA_Status
+ */
+RDA_Status RDA_GetLastError(RDA_Handle* dev)
+{
+    return dev->lastError;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Read the status of RDA chip and decode a new RDS group
+ * @param dev Device handle
+ * @param rds Decoder
+ * @return RDA_RDS_xxx flags
+ */
+uint8_t RDA_ReadRDS(RDA_Handle* dev, RDA_RDS* rds)
+{
+    RDA_PROF_API();
+    RDA_RDSGroup group;
+
+    if (getStatusBurst(dev) != RDA_OK || !dev->reg0A.refined.RDSR)
+    {
+        return 0;
+    }
+    RDA_GetRDSBlocks(dev, group.blocks);
+    group.blera = dev->reg0B.refined.BLERA;
+    group.blerb = dev->reg0B.refined.BLERB;
+    return RDA_RDSDecodeGroup(rds, &group, dev->rdsPolicy ? dev->rdsPolicy : &RDA_RDSPolicyDefault);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the block acceptance policy of RDA_ReadRDS
+ * @param dev Device handle
+ * @param policy Policy, NULL for RDA_RDSPolicyDefault
+ */
+void RDA_SetRDSPolicy(RDA_Handle* dev, const RDA_RDSPolicy* policy)
+{
+    dev->rdsPolicy = policy;
+}
+
+/*
+ * Completion of the RDA_CaptureRDS burst read, runs in the context that completed the transfer
+ */
+static void rdsCaptured(RDA_Xfer* xfer)
+{
+    RDA_Handle* dev = xfer->context;
+    RDA_Reg0A reg0A = {.raw = dev->rdsWords[SH_REG0A]};
+    RDA_Reg0B reg0B = {.raw = dev->rdsWords[SH_REG0B]};
+    RDA_RDSRing* ring = dev->rdsRing;
+    RDA_RDSGroup group;
+
+    if (xfer->status == RDA_XFER_OK && reg0A.refined.RDSR && ring)
+    {
+        group.blocks[0] = dev->rdsWords[SH_REG0C];
+        group.blocks[1] = dev->rdsWords[SH_REG0D];
+        group.blocks[2] = dev->rdsWords[SH_REG0E];
+        group.blocks[3] = dev->rdsWords[SH_REG0F];
+        group.blera = reg0B.refined.BLERA;
+        group.blerb = reg0B.refined.BLERB;
+#ifdef SYSTICK_DELAY
+        group.timestamp = getMillis();
+#else
+        group.timestamp = 0;
+#endif
+        RDA_RDSRingPush(ring, &group);
+    }
+    dev->rdsCapturing = FALSE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the ring RDA_CaptureRDS fills
+ * @param dev Device handle
+ * @param ring Ring, see RDA_RDSRingInit; NULL stops the capture
+ */
+void RDA_SetRDSRing(RDA_Handle* dev, RDA_RDSRing* ring)
+{
+    dev->rdsRing = ring;
+}
+
+/**
+ * @ingroup GA03
+ * @brief TRUE once the settle time of the last write is over
+ */
+static BOOL writeSettled(RDA_Handle* dev)
+{
+#ifdef SYSTICK_DELAY
+    if (dev->settling && (int32_t)(dev->settleUntil - getMillis()) > 0)
+    {
+        return FALSE;
+    }
+#endif
+    return TRUE;
+}
+
+/**
+ * @ingroup GA03
+ * @brief TRUE when a read may be started from a timer interrupt
+ * @details Only a port with lock/unlock completes from its own interrupt; the polled port would
+ * @details run the whole transfer in the caller. The settle time of the last write must be over.
+ */
+static BOOL tickReadAllowed(RDA_Handle* dev)
+{
+    if (!dev->queue.port || !dev->queue.port->lock)
+    {
+        return FALSE;
+    }
+    return writeSettled(dev);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Queues the burst read of REG0A-REG0F, rdsCaptured pushes the group
+ */
+static BOOL captureStart(RDA_Handle* dev)
+{
+    RDA_Xfer* xfer = &dev->rdsXfer;
+
+    xfer->address = I2C_ADDR_FULL_ACCESS;
+    xfer->direction = RDA_XFER_READ;
+    xfer->reg = RDA_XFER_NO_REG;
+    xfer->length = SH_REG0F + 1;
+    xfer->data = dev->rdsWords;
+    xfer->callback = rdsCaptured;
+    xfer->context = dev;
+    dev->rdsCapturing = TRUE;
+    if (!RDA_XferSubmit(&dev->queue, xfer))
+    {
+        dev->rdsCapturing = FALSE;
+        return FALSE;
+    }
+    RDA_PROF_XFER(xfer);
+    return TRUE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Capture a new RDS group of RDA chip into the ring, from a timer interrupt
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_CaptureRDS(RDA_Handle* dev)
+{
+    RDA_PROF_IRQ();
+
+    if (!dev->rdsRing || dev->busOwned || dev->rdsCapturing || !tickReadAllowed(dev))
+    {
+        return FALSE;
+    }
+    return captureStart(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Capture a new RDS group of RDA chip into the ring, from the main loop or a task
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_CaptureRDSStep(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+
+    if (!dev->rdsRing || dev->busOwned || dev->rdsCapturing || !writeSettled(dev))
+    {
+        return FALSE;
+    }
+    if (!dev->queue.port)
+    {
+        RDA_XferInit(&dev->queue, &xferPolledPort, dev);
+    }
+    return captureStart(dev);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Ends a scan: the shadow registers follow the channel the chip stayed on
+ */
+static RDA_TuneStatus scanFinish(RDA_Handle* dev, RDA_TuneStatus status)
+{
+    dev->scanPhase = SCAN_IDLE;
+    dev->reg0A.raw = dev->scanStatus[SH_REG0A];
+    dev->reg0B.raw = dev->scanStatus[SH_REG0B];
+    dev->reg03.refined.CHAN = dev->reg0A.refined.READCHAN;
+    dev->currentFrequency = channelToFrequency(dev, dev->reg0A.refined.READCHAN);
+#ifdef SYSTICK_DELAY
+    dev->scanTable->time = getMillis() - dev->scanStarted;
+#endif
+    return status;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts the tune of the next scan channel, the write skips the settle delay of registerWrite
+ */
+static RDA_Status scanTune(RDA_Handle* dev, uint16_t channel)
+{
+    RDA_Xfer tune = {I2C_ADDR_DIRECT_ACCESS, RDA_XFER_WRITE, REG03, 1, (uint16_t*)&dev->reg03.raw};
+    RDA_Status result;
+
+    dev->stcPending = FALSE;
+    dev->reg03.refined.CHAN = channel;
+    dev->reg03.refined.TUNE = 1;
+    dev->reg03.refined.BAND = dev->currentFMBand;
+    dev->reg03.refined.SPACE = dev->currentFMSpace;
+    dev->reg03.refined.DIRECT_MODE = 0;
+    result = xferRun(dev, &tune);
+    dev->reg03.refined.TUNE = 0;
+    dev->scanPhase = SCAN_TUNING;
+#ifdef SYSTICK_DELAY
+    dev->scanPhaseStarted = getMillis();
+    dev->scanNextPoll = dev->scanPhaseStarted + SCAN_TUNE_TIME;
+#endif
+    return result;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts a hardware seek up that stops at the band limit
+ */
+static RDA_Status scanSeek(RDA_Handle* dev)
+{
+    uint16_t value;
+    RDA_Xfer seek = {I2C_ADDR_DIRECT_ACCESS, RDA_XFER_WRITE, REG02, 1, &value};
+
+    dev->stcPending = FALSE;
+    dev->reg02.refined.SKMODE = RDA_SEEK_STOP;
+    dev->reg02.refined.SEEKUP = RDA_SEEK_UP;
+    dev->reg02.refined.SEEK = 1;
+    value = dev->reg02.raw;
+    dev->reg02.refined.SEEK = 0; // The chip clears it on completion
+    dev->scanPhase = SCAN_SEEKING;
+#ifdef SYSTICK_DELAY
+    dev->scanPhaseStarted = getMillis();
+    dev->scanNextPoll = dev->scanPhaseStarted + SCAN_SEEK_POLL;
+#endif
+    return xferRun(dev, &seek);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Adds the channel the chip is on to the station table and moves to the next one
+ */
+static RDA_TuneStatus scanNext(RDA_Handle* dev, BOOL record)
+{
+    RDA_StationTable* table = dev->scanTable;
+    RDA_Reg0A reg0A = {.raw = dev->scanStatus[SH_REG0A]};
+    RDA_Reg0B reg0B = {.raw = dev->scanStatus[SH_REG0B]};
+    RDA_Station* station;
+    RDA_Status result;
+
+    if (record && table->count < table->capacity)
+    {
+        station = &table->stations[table->count++];
+        station->frequency = channelToFrequency(dev, reg0A.refined.READCHAN);
+        station->rssi = reg0B.refined.RSSI;
+        station->flags = (reg0A.refined.ST ? RDA_STATION_STEREO : 0) |
+                         (reg0A.refined.RDSS ? RDA_STATION_RDS : 0);
+    }
+    if (dev->scanChannel >= lastChannel(dev))
+    {
+        return scanFinish(dev, RDA_TUNE_DONE);
+    }
+    if (dev->scanMode == RDA_SCAN_SEEK)
+    {
+        result = scanSeek(dev);
+    }
+    else
+    {
+        result = scanTune(dev, ++dev->scanChannel);
+    }
+    return (result == RDA_OK) ? RDA_TUNE_IN_PROGRESS : scanFinish(dev, RDA_TUNE_ERROR);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Handles STC of a scan tune or seek
+ */
+static RDA_TuneStatus scanComplete(RDA_Handle* dev)
+{
+    RDA_StationTable* table = dev->scanTable;
+    RDA_Reg0A reg0A = {.raw = dev->scanStatus[SH_REG0A]};
+    RDA_Reg0B reg0B = {.raw = dev->scanStatus[SH_REG0B]};
+    uint16_t channel = reg0A.refined.READCHAN;
+
+    if (dev->scanPhase == SCAN_SEEKING)
+    {
+        if (reg0A.refined.SF || channel <= dev->scanChannel)
+        {
+            table->channels += lastChannel(dev) - dev->scanChannel;
+            return scanFinish(dev, RDA_TUNE_DONE); // Band limit
+        }
+        table->channels += channel - dev->scanChannel;
+        dev->scanChannel = channel;
+    }
+    else
+    {
+        table->channels++;
+    }
+    // The first channel of a seek scan is tuned, not found by a seek
+    if (!reg0B.refined.FM_TRUE && !(dev->scanPhase == SCAN_SEEKING))
+    {
+        return scanNext(dev, FALSE);
+    }
+#ifdef SYSTICK_DELAY
+    // RDS needs a few groups to synchronize, only stations are worth the wait
+    if (dev->reg02.refined.RDS_EN && !reg0A.refined.RDSS && table->count < table->capacity)
+    {
+        dev->scanPhase = SCAN_DWELL;
+        dev->scanPhaseStarted = getMillis();
+        dev->scanNextPoll = dev->scanPhaseStarted + SCAN_RDS_POLL;
+        return RDA_TUNE_IN_PROGRESS;
+    }
+#endif
+    return scanNext(dev, TRUE);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Start a scan of the current band of RDA chip
+ * @details Refused with RDA_ERROR while a tune, seek or scan is pending and between
+ * @details RDA_BeginUpdate and RDA_CommitUpdate.
+ * @param dev Device handle
+ * @param mode RDA_SCAN_STEP or RDA_SCAN_SEEK
+ * @param table Station table
+ * @return RDA_Status
+ */
+RDA_Status RDA_ScanStart(RDA_Handle* dev, uint8_t mode, RDA_StationTable* table)
+{
+    RDA_PROF_API();
+    RDA_Status result;
+
+    // scanTune writes REG03 past a batch, and a pending tune/seek would take the scan's STC
+    if (dev->tuneStatus == RDA_TUNE_IN_PROGRESS || dev->scanPhase != SCAN_IDLE || dev->batchUpdate)
+    {
+        return RDA_ERROR;
+    }
+    table->count = 0;
+    table->channels = 0;
+    table->time = 0;
+    dev->scanTable = table;
+    dev->scanMode = mode;
+    dev->scanChannel = 0;
+#ifdef SYSTICK_DELAY
+    dev->scanStarted = getMillis();
+#endif
+    // Both modes start on the first channel, a seek only looks at the channels after it
+    result = scanTune(dev, 0);
+    if (result != RDA_OK)
+    {
+        dev->scanPhase = SCAN_IDLE;
+    }
+    return result;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Step the scan of RDA chip
+ * @param dev Device handle
+ * @return RDA_TuneStatus
+ */
+RDA_TuneStatus RDA_ScanPoll(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+    RDA_Xfer read = {I2C_ADDR_FULL_ACCESS, RDA_XFER_READ, RDA_XFER_NO_REG, 2, dev->scanStatus};
+    RDA_Reg0A reg0A;
+#ifdef SYSTICK_DELAY
+    uint32_t now = getMillis();
+    uint32_t timeout = (dev->scanPhase == SCAN_SEEKING) ? SCAN_SEEK_TIMEOUT : TUNE_TIMEOUT;
+#endif
+
+    if (dev->scanPhase == SCAN_IDLE)
+    {
+        return RDA_TUNE_IDLE;
+    }
+    if (dev->scanPhase != SCAN_DWELL && dev->reg04.refined.STCIEN)
+    {
+        // Interrupt driven, no bus traffic until GPIO2 fired
+        if (!dev->stcPending)
+        {
+#ifdef SYSTICK_DELAY
+            if ((now - dev->scanPhaseStarted) > timeout)
+            {
+                dev->lastError = RDA_TIMEOUT;
+                return scanFinish(dev, RDA_TUNE_ERROR);
+            }
+#endif
+            return RDA_TUNE_IN_PROGRESS;
+        }
+    }
+#ifdef SYSTICK_DELAY
+    else if ((int32_t)(now - dev->scanNextPoll) < 0)
+    {
+        return RDA_TUNE_IN_PROGRESS;
+    }
+#endif
+
+    // A dwell only needs REG0A, REG0B keeps the value read at STC
+    read.length = (dev->scanPhase == SCAN_DWELL) ? 1 : 2;
+    if (xferRun(dev, &read) != RDA_OK)
+    {
+        return scanFinish(dev, RDA_TUNE_ERROR);
+    }
+    reg0A.raw = dev->scanStatus[SH_REG0A];
+
+    if (dev->scanPhase == SCAN_DWELL)
+    {
+#ifdef SYSTICK_DELAY
+        if (!reg0A.refined.RDSS && (now - dev->scanPhaseStarted) < SCAN_RDS_DWELL)
+        {
+            dev->scanNextPoll = now + SCAN_RDS_POLL;
+            return RDA_TUNE_IN_PROGRESS;
+        }
+#endif
+        return scanNext(dev, TRUE);
+    }
+    if (!reg0A.refined.STC)
+    {
+#ifdef SYSTICK_DELAY
+        if ((now - dev->scanPhaseStarted) > timeout)
+        {
+            dev->lastError = RDA_TIMEOUT;
+            return scanFinish(dev, RDA_TUNE_ERROR);
+        }
+        dev->scanNextPoll = now + ((dev->scanPhase == SCAN_SEEKING) ? SCAN_SEEK_POLL : MIN_DELAY);
+#endif
+        return RDA_TUNE_IN_PROGRESS;
+    }
+    return scanComplete(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Scan the current band of RDA chip
+ * @param dev Device handle
+ * @param mode RDA_SCAN_STEP or RDA_SCAN_SEEK
+ * @param table Station table
+ * @return RDA_Status
+ */
+RDA_Status RDA_Scan(RDA_Handle* dev, uint8_t mode, RDA_StationTable* table)
+{
+    RDA_PROF_API();
+    RDA_TuneStatus status;
+    RDA_Status result = RDA_ScanStart(dev, mode, table);
+
+    if (result != RDA_OK)
+    {
+        return result;
+    }
+    while ((status = RDA_ScanPoll(dev)) == RDA_TUNE_IN_PROGRESS)
+    {
+        RDA_HAL_Idle();
+    }
+    return (status == RDA_TUNE_DONE) ? RDA_OK : dev->lastError;
+}
+
+/*
+ * Completion of the RDA_MonitorTick read, runs in the context that completed the transfer
+ */
+static void monitorSampled(RDA_Xfer* xfer)
+{
+    RDA_Handle* dev = xfer->context;
+    RDA_Reg0A reg0A = {.raw = dev->monitorWords[SH_REG0A]};
+    RDA_Reg0B reg0B = {.raw = dev->monitorWords[SH_REG0B]};
+    RDA_Monitor* monitor = dev->monitor;
+    uint8_t flags = 0;
+
+    if (xfer->status == RDA_XFER_OK && reg0A.refined.STC && monitor)
+    {
+        flags |= reg0B.refined.FM_TRUE ? RDA_SAMPLE_FM_TRUE : 0;
+        flags |= reg0A.refined.ST ? RDA_SAMPLE_STEREO : 0;
+        if (reg0A.refined.RDSR)
+        {
+            flags |= RDA_SAMPLE_RDS;
+            flags |= reg0B.refined.BLERA ? RDA_SAMPLE_ERROR_A : 0;
+            flags |= reg0B.refined.BLERB ? RDA_SAMPLE_ERROR_B : 0;
+        }
+        RDA_MonitorPush(monitor, reg0A.refined.READCHAN, reg0B.refined.RSSI, flags);
+    }
+    dev->monitorReading = FALSE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the signal monitor RDA_MonitorTick feeds
+ * @param dev Device handle
+ * @param monitor Monitor; NULL stops monitoring
+ * @param period ms between samples
+ */
+void RDA_SetMonitor(RDA_Handle* dev, RDA_Monitor* monitor, uint16_t period)
+{
+    if (monitor)
+    {
+        RDA_MonitorInit(monitor);
+    }
+    dev->monitorPeriod = period;
+#ifdef SYSTICK_DELAY
+    dev->monitorLast = getMillis() - period;
+#endif
+    dev->monitor = monitor;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Queues the sequential read of REG0A/REG0B once the period elapsed, monitorSampled pushes the sample
+ */
+static BOOL monitorStart(RDA_Handle* dev)
+{
+    RDA_Xfer* xfer = &dev->monitorXfer;
+
+#ifdef SYSTICK_DELAY
+    if (getMillis() - dev->monitorLast < dev->monitorPeriod)
+    {
+        return FALSE;
+    }
+    dev->monitorLast = getMillis();
+#endif
+    xfer->address = I2C_ADDR_FULL_ACCESS;
+    xfer->direction = RDA_XFER_READ;
+    xfer->reg = RDA_XFER_NO_REG;
+    xfer->length = SH_REG0B + 1;
+    xfer->data = dev->monitorWords;
+    xfer->callback = monitorSampled;
+    xfer->context = dev;
+    dev->monitorReading = TRUE;
+    if (!RDA_XferSubmit(&dev->queue, xfer))
+    {
+        dev->monitorReading = FALSE;
+        return FALSE;
+    }
+    RDA_PROF_XFER(xfer);
+    return TRUE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Sample the signal quality of RDA chip into the monitor, from a timer interrupt
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_MonitorTick(RDA_Handle* dev)
+{
+    RDA_PROF_IRQ();
+
+    if (!dev->monitor || dev->busOwned || dev->monitorReading || !tickReadAllowed(dev))
+    {
+        return FALSE;
+    }
+    return monitorStart(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Sample the signal quality of RDA chip into the monitor, from the main loop or a task
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_MonitorStep(RDA_Handle* dev)
+{
+    RDA_PROF_API();
+
+    if (!dev->monitor || dev->busOwned || dev->monitorReading || !writeSettled(dev))
+    {
+        return FALSE;
+    }
+    if (!dev->queue.port)
+    {
+        RDA_XferInit(&dev->queue, &xferPolledPort, dev);
+    }
+    return monitorStart(dev);
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the signal statistics of RDA chip
+ * @param dev Device handle
+ * @param stats Filled with the statistics
+ * @return TRUE when the window holds samples
+ */
+BOOL RDA_GetSignalStats(RDA_Handle* dev, RDA_SignalStats* stats)
+{
+    if (!dev->monitor)
+    {
+        return FALSE;
+    }
+    return RDA_MonitorGetStats(dev->monitor, stats) ? TRUE : FALSE;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Waits for an RDS group on the channel an AF check is tuned to and compares its PI
+ * @details Burst reads REG0A-REG0F every AF_PI_POLL ms until a group with a clean block A is ready,
+ * @details for at most wait ms. The audio stays muted meanwhile.
+ * @return TRUE when block A carries pi
+ */
+static BOOL afVerify(RDA_Handle* dev, uint16_t pi, int32_t wait)
+{
+#ifdef SYSTICK_DELAY
+    uint32_t start = getMillis();
+#else
+    uint8_t polls = 0;
+#endif
+
+    while (getStatusBurst(dev) == RDA_OK)
+    {
+        if (dev->reg0A.refined.RDSR && dev->reg0B.refined.BLERA == 0)
+        {
+            return dev->reg0C.RDSA == pi;
+        }
+#ifdef SYSTICK_DELAY
+        if ((int32_t)(getMillis() - start) + AF_PI_POLL > wait)
+        {
+            break;
+        }
+        Delay(AF_PI_POLL);
+#else
+        if (++polls >= AF_PI_POLLS)
+        {
+            break;
+        }
+#endif
+    }
+    return FALSE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Check the alternative frequencies of the current program on RDA chip
+ * @param dev Device handle
+ * @param list AF list of the program
+ * @param muteWindow ms the audio may stay muted
+ * @param switched Set to TRUE when the chip moved to an AF, may be NULL
+ * @return RDA_Status
+ */
+RDA_Status RDA_AFCheck(RDA_Handle* dev, const RDA_AFList* list, uint16_t muteWindow, BOOL* switched)
+{
+    RDA_PROF_API();
+    BOOL muted = !dev->reg02.refined.DHIZ;
+    RDA_Status status;
+    uint32_t frequency;
+    uint16_t home;
+    uint16_t best;
+    uint16_t channel;
+    uint16_t candidateChannel;
+    uint8_t threshold;
+    uint8_t rssi;
+    uint8_t index;
+    uint8_t i;
+    int32_t wait = 0;
+#ifdef SYSTICK_DELAY
+    uint32_t start = 0;
+    uint32_t candidateStart;
+    uint32_t candidate = AF_TUNE_TIME;
+#endif
+
+    if (switched)
+    {
+        *switched = FALSE;
+    }
+    status = getSignal(dev);
+    if (status != RDA_OK || !list)
+    {
+        return status;
+    }
+    if (list->pi != dev->afPi)
+    {
+        // Another program, its list starts from the top
+        dev->afPi = list->pi;
+        dev->afNext = 0;
+    }
+    home = dev->reg0A.refined.READCHAN;
+    best = home;
+    channel = home;
+    threshold = dev->reg0B.refined.RSSI + AF_MARGIN;
+
+    for (i = 0; i < list->count; i++)
+    {
+        index = (dev->afNext + i) % list->count;
+        frequency = RDA_AF_FREQUENCY(list->codes[index]);
+        candidateChannel = frequencyToChannel(dev, frequency);
+        if (candidateChannel == home || channelToFrequency(dev, candidateChannel) != frequency)
+        {
+            continue; // The current channel, or not on the current band and space
+        }
+#ifdef SYSTICK_DELAY
+        // Room for this candidate and the tune back, the next check starts with the AFs left
+        if (channel == home)
+        {
+            start = getMillis();
+        }
+        if (getMillis() - start + 2 * candidate > muteWindow)
+        {
+            dev->afNext = index;
+            break;
+        }
+        candidateStart = getMillis();
+#endif
+        if (channel == home && !muted)
+        {
+            status = RDA_SetMute(dev, TRUE);
+            if (status != RDA_OK)
+            {
+                return status;
+            }
+        }
+        channel = candidateChannel;
+        status = RDA_SetChannel(dev, channel);
+        if (status == RDA_OK)
+        {
+            status = getSignal(dev);
+        }
+        if (status != RDA_OK)
+        {
+            break;
+        }
+#ifdef SYSTICK_DELAY
+        if (getMillis() - candidateStart > candidate)
+        {
+            candidate = getMillis() - candidateStart;
+        }
+        // The PI check gets what is left of the window after the tune back
+        wait = (int32_t)(muteWindow - (getMillis() - start) - candidate);
+#endif
+        rssi = dev->reg0B.refined.RSSI;
+        // A stronger channel is only taken when it carries the same program
+        if (dev->reg0B.refined.FM_TRUE && rssi > threshold && afVerify(dev, list->pi, wait))
+        {
+            best = channel;
+            threshold = rssi;
+        }
+    }
+    if (i == list->count)
+    {
+        dev->afNext = 0; // A full pass, the next check starts from the top
+    }
+
+    if (channel == home)
+    {
+        return status; // No candidate was tuned
+    }
+    if (channel != best)
+    {
+        // Keep the first error, but go back in any case
+        status = (RDA_SetChannel(dev, best) == RDA_OK) ? status : dev->lastError;
+    }
+    if (best != home)
+    {
+        dev->currentFrequency = channelToFrequency(dev, best);
+        if (switched)
+        {
+            *switched = TRUE;
+        }
+    }
+    if (!muted && RDA_SetMute(dev, FALSE) != RDA_OK && status == RDA_OK)
+    {
+        status = dev->lastError;
+    }
+    return status;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Set a wall clock from an RDS Clock-Time
+ * @param clock Clock
+ * @param time Accepted Clock-Time
+ * @param received getMillis() when the group was received
+ */
+void RDA_SyncClock(RDA_Clock* clock, const RDA_RDSTime* time, uint32_t received)
+{
+    clock->unixTime = RDA_RDSTimeToUnix(time);
+    clock->millis = received;
+    clock->offset = time->offset;
+    clock->valid = TRUE;
+}
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the time of a wall clock
+ * @param clock Clock
+ * @param local TRUE for local time, FALSE for UTC
+ * @return seconds since 1970-01-01
+ */
+uint32_t RDA_GetClock(const RDA_Clock* clock, BOOL local)
+{
+    uint32_t now;
+
+    if (!clock->valid)
+    {
+        return 0;
+    }
+    now = clock->unixTime;
+#ifdef SYSTICK_DELAY
+    now += (getMillis() - clock->millis) / 1000;
+#endif
+    if (local)
+    {
+        now += (int32_t)clock->offset * 1800;
+    }
+    return now;
 }
@@ -5,7 +5,11 @@
  extern "C" {
 #endif
 
-#include <stm32f10x_i2c.h>
+#include <RDA_HAL.h>
+#include <RDA_RDS.h>
+#include <RDA_Monitor.h>
+#include <RDA_Timer.h>
+#include <RDA_Store.h>
 
 typedef enum
 {
@@ -14,7 +18,19 @@ typedef enum
     MAX
 } BOOL;
 
+/**
+ * @brief Result of an RDA_* call that accesses the bus
+ */
+typedef enum
+{
+    RDA_OK,         //!< Success
+    RDA_ERROR,      //!< Bus error or invalid request
+    RDA_TIMEOUT,    //!< Bus event or tune did not happen within its budget
+    RDA_NACK        //!< The chip did not acknowledge
+} RDA_Status;
+
 #define MAX_DELAY_AFTER_OSCILLATOR 500  // Max delay after the crystal oscilator becomes active
+#define RDA_CACHE_WINDOW 10             //!< Default ms a status register read serves the getters, see RDA_SetCacheWindow
 
 #define I2C_ADDR_DIRECT_ACCESS  0x11    //!< Can be used to access a given register at a time.
 #define I2C_ADDR_FULL_ACCESS    0x10    //!< Can be used to access a set of register at a time.
@@ -43,6 +59,9 @@ typedef enum
 #define RDA_SEEK_DOWN  0     //!< Seek Up
 #define RDA_SEEK_UP    1     //!< Seek Down
 
+#define RDA_SCAN_STEP  0     //!< Scan by tuning every channel
+#define RDA_SCAN_SEEK  1     //!< Scan by chaining hardware seeks
+
 #define REG00 0x00
 #define REG02 0x02
 #define REG03 0x03
@@ -424,48 +443,294 @@ typedef union
 } RDA_Reg0F;
 
 
+/**
+ * @ingroup GA01
+ * @brief Asynchronous tune/seek status
+ */
+typedef enum
+{
+    RDA_TUNE_IDLE,          //!< No operation pending
+    RDA_TUNE_IN_PROGRESS,   //!< Waiting for STC
+    RDA_TUNE_DONE,          //!< Tune or seek completed
+    RDA_TUNE_SEEK_FAIL,     //!< Seek completed with SF set, no station found
+    RDA_TUNE_ERROR          //!< Bus error while polling, see RDA_GetLastError
+} RDA_TuneStatus;
+
+typedef struct RDA_Handle RDA_Handle;
+
+/**
+ * @ingroup GA01
+ * @brief Asynchronous tune/seek completion callback
+ */
+typedef void (*RDA_TuneCallback)(RDA_Handle* dev, RDA_TuneStatus status);
+
+#define RDA_STATION_STEREO  0x01    //!< Stereo indicator (ST) was set
+#define RDA_STATION_RDS     0x02    //!< RDS decoder synchronized (RDSS) within the dwell time
+
+/**
+ * @ingroup GA01
+ * @brief Station found by a band scan
+ */
+typedef struct
+{
+    uint32_t frequency;     //!< kHz
+    uint8_t rssi;           //!< REG0B RSSI
+    uint8_t flags;          //!< RDA_STATION_xxx
+} RDA_Station;
+
+/**
+ * @ingroup GA01
+ * @brief Station table filled by a band scan
+ * @details The application provides the entries; channels with FM_TRUE are recorded in band order.
+ */
+typedef struct
+{
+    RDA_Station* stations;  //!< Entries
+    uint8_t capacity;       //!< Number of entries
+    uint8_t count;          //!< Stations recorded
+    uint16_t channels;      //!< Channels visited
+    uint32_t time;          //!< Scan duration in ms (SysTick builds)
+} RDA_StationTable;
+
+/**
+ * @ingroup GA01
+ * @brief Status cache and shadow verification counters, see RDA_GetCacheStats
+ */
+typedef struct
+{
+    uint32_t hits;          //!< Getters served from status registers read within the staleness window
+    uint32_t misses;        //!< Getters that read the chip
+    uint32_t verifies;      //!< Read-backs of REG02-REG07
+    uint32_t resyncs;       //!< Read-backs that found the chip diverged and re-applied the shadow registers
+} RDA_CacheStats;
+
+/**
+ * @ingroup GA01
+ * @brief Wall clock on the millisecond timebase, set from the RDS Clock-Time
+ */
+typedef struct
+{
+    uint32_t unixTime;      //!< Seconds since 1970-01-01 UTC at the sync
+    uint32_t millis;        //!< getMillis() at the sync
+    int8_t offset;          //!< Local time offset in half hours
+    BOOL valid;             //!< Synced at least once
+} RDA_Clock;
+
+/**
+ * @ingroup GA01
+ * @brief Device handle: shadow registers and driver state of one RDA chip
+ * @details The application allocates one per chip and passes it to every call; RDA_Init binds it
+ * @details to its I2C port. Several chips (one per I2C bus, the addresses are fixed) run independently.
+ * @details A register write does not wait for the chip to settle, the next transfer of the handle
+ * @details waits for what is left of it (SYSTICK_DELAY).
+ * @details Fields are private to the driver.
+ */
+struct RDA_Handle
+{
+    // I2C port of the chip
+    RDA_BusTypeDef* I2Cx;
+    // Transfer queue, polled port on I2Cx unless RDA_SetXferPort installed another
+    RDA_XferQueue queue;
+    // REG01
+	RDA_Reg01 reg01;
+    // REG02
+	RDA_Reg02 reg02;
+    // REG03
+	RDA_Reg03 reg03;
+    // REG04
+	RDA_Reg04 reg04;
+    // REG05
+	RDA_Reg05 reg05;
+    // REG06
+	RDA_Reg06 reg06;
+    // REG07
+	RDA_Reg07 reg07;
+    // REG08
+	RDA_Reg08 reg08;
+    // REG0A
+	RDA_Reg0A reg0A;
+    // REG0B
+	RDA_Reg0B reg0B;
+    // REG0C
+	RDA_Reg0C reg0C;
+    // REG0D
+	RDA_Reg0D reg0D;
+    // REG0E
+	RDA_Reg0E reg0E;
+    // REG0F
+	RDA_Reg0F reg0F;
+    // FM frequency in kHz
+    uint32_t currentFrequency;
+    // FM band
+    uint8_t currentFMBand;
+    // FM space
+    uint8_t currentFMSpace;
+    // FM volume
+    uint8_t currentVolume;
+    // Dirty shadow registers (bit n = REG0n) pending a commit
+    uint8_t dirtyRegisters;
+    // Setters only mark registers dirty while TRUE
+    BOOL batchUpdate;
+    // Asynchronous tune/seek state
+    RDA_TuneStatus tuneStatus;
+    // TRUE when the pending operation is a seek
+    BOOL tuneSeeking;
+    // Called once when the pending tune/seek completes
+    RDA_TuneCallback tuneCallback;
+    // Time the pending tune/seek started and of its last STC poll
+    uint32_t tuneStarted;
+    uint32_t tuneLastPoll;
+    // Continuation that polls STC while a tune/seek is pending
+    RDA_Timer tuneTimer;
+    // Set by RDA_NotifySTC when GPIO2 signals seek/tune complete
+    volatile BOOL stcPending;
+    // REG0A reads made waiting for the last tune or seek
+    uint32_t tunePolls;
+    // Result of the last bus transfer
+    RDA_Status lastError;
+    // Bus recoveries and retries allowed per transfer
+    uint8_t retries;
+    // The chip settles after a write until settleUntil, the next transfer waits for it
+    BOOL settling;
+    uint32_t settleUntil;
+    // An application call is using the bus, RDA_CaptureRDS and RDA_CaptureRDSStep stay off it
+    volatile BOOL busOwned;
+    // Block acceptance policy of RDA_ReadRDS, NULL for RDA_RDSPolicyDefault
+    const RDA_RDSPolicy* rdsPolicy;
+    // Ring RDA_CaptureRDS feeds, NULL when capture is off
+    RDA_RDSRing* rdsRing;
+    // Burst read of REG0A-REG0F owned by RDA_CaptureRDS
+    RDA_Xfer rdsXfer;
+    uint16_t rdsWords[SH_REG0F + 1];
+    // rdsXfer is queued or on the bus
+    volatile BOOL rdsCapturing;
+    // Band scan, see RDA_ScanStart
+    RDA_StationTable* scanTable;
+    uint8_t scanMode;
+    uint8_t scanPhase;
+    uint16_t scanChannel;
+    uint16_t scanStatus[2];
+    uint32_t scanStarted;
+    uint32_t scanPhaseStarted;
+    uint32_t scanNextPoll;
+    // Signal monitor RDA_MonitorTick feeds, NULL when monitoring is off
+    RDA_Monitor* monitor;
+    // ms between samples
+    uint16_t monitorPeriod;
+    // Time of the last sample
+    uint32_t monitorLast;
+    // Sequential read of REG0A/REG0B owned by RDA_MonitorTick
+    RDA_Xfer monitorXfer;
+    uint16_t monitorWords[SH_REG0B + 1];
+    // monitorXfer is queued or on the bus
+    volatile BOOL monitorReading;
+    // AF the next RDA_AFCheck starts with when the last one ran out of mute window
+    uint8_t afNext;
+    // PI of the AF list afNext belongs to
+    uint16_t afPi;
+    // Staged power-up, see RDA_PowerUpStart
+    RDA_TuneStatus powerStatus;
+    uint32_t powerStarted;
+    uint32_t powerLastPoll;
+    // ms from RDA_PowerUpStart until FM_READY
+    uint32_t readyTime;
+    // ms from RDA_PowerUpStart until the first tune completed, 0 before
+    uint32_t bootTime;
+    // ms a status register read serves the getters, 0 = always read
+    uint16_t cacheWindow;
+    // Status registers read since the last write (bit SH_REGxx) and when
+    uint8_t statusFresh;
+    uint32_t statusTime[SH_REG0F + 1];
+    // Cache and verification counters
+    RDA_CacheStats cacheStats;
+};
+
+/**
+ * @ingroup RDA_API
+ * @brief Start the power-up of the RDA chip
+ * @details Resets the device handle, binds it to its I2C port and sets ENABLE, which starts the
+ * @details crystal oscillator. The oscillator needs up to MAX_DELAY_AFTER_OSCILLATOR ms; do other
+ * @details init work meanwhile and call RDA_PowerUpPoll until it completes.
+ * @param dev Device handle
+ * @param I2Cx I2C Port the chip is on
+ * @return RDA_Status
+ */
+RDA_Status RDA_PowerUpStart(RDA_Handle* dev, RDA_BusTypeDef* I2Cx);
+
+/**
+ * @ingroup RDA_API
+ * @brief Step the power-up of the RDA chip
+ * @details Reads REG0B at most once every 5 ms. Once FM_READY is set the configuration is written
+ * @details and RDA_TUNE_DONE is returned once, then RDA_TUNE_IDLE. RDA_TUNE_ERROR on a bus error, or
+ * @details with RDA_GetLastError RDA_TIMEOUT when FM_READY is not set within MAX_DELAY_AFTER_OSCILLATOR.
+ * @param dev Device handle
+ * @return RDA_TuneStatus
+ */
+RDA_TuneStatus RDA_PowerUpPoll(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the boot-to-first-audio time of RDA chip
+ * @details ms from RDA_PowerUpStart (or RDA_Init) until the first tune or seek completed.
+ * @param dev Device handle
+ * @return uint32_t ms, 0 while no tune completed yet
+ */
+uint32_t RDA_GetBootTime(RDA_Handle* dev);
+
 /**
  * @ingroup RDA_API
  * @brief Init the RDA chip
- * @param I2Cx I2C Port
+ * @details Resets the device handle and binds it to its I2C port, call before any other function.
+ * @details RDA_PowerUpStart and RDA_PowerUpPoll in one call: sleeps until the oscillator is stable.
+ * @param dev Device handle
+ * @param I2Cx I2C Port the chip is on
+ * @return RDA_Status, RDA_TIMEOUT when FM_READY is not set within MAX_DELAY_AFTER_OSCILLATOR
  */
-void RDA_Init(I2C_TypeDef* I2Cx);
+RDA_Status RDA_Init(RDA_Handle* dev, RDA_BusTypeDef* I2Cx);
 
 /**
  * @ingroup RDA_API
  * @brief De-Init the RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return RDA_Status
  */
-void RDA_DeInit(I2C_TypeDef* I2Cx);
+RDA_Status RDA_DeInit(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Soft reset the RDA chip
- * @param I2Cx I2C Port
+ * @details The chip returns to its power-on registers, also inside RDA_BeginUpdate/RDA_CommitUpdate.
+ * @details The shadow registers keep the settings; RDA_Resync applies them again.
+ * @param dev Device handle
+ * @return RDA_Status
  */
-void RDA_SoftReset(I2C_TypeDef* I2Cx);
+RDA_Status RDA_SoftReset(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Set frequency on RDA chip
- * @param I2Cx I2C Port
- * @param frequency frequency
+ * @details Tunes the nearest channel of the current band and space.
+ * @param dev Device handle
+ * @param frequency frequency in kHz, e.g. 104000 for 104.0 MHz
+ * @return RDA_Status
  */
-void RDA_Tune(I2C_TypeDef* I2Cx, uint16_t frequency);
+RDA_Status RDA_Tune(RDA_Handle* dev, uint32_t frequency);
 
 /**
  * @ingroup RDA_API
  * @brief Call manual seek down on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return RDA_Status
  */
-void RDA_ManualDown(I2C_TypeDef* I2Cx);
+RDA_Status RDA_ManualDown(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Call manual seek up on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return RDA_Status
  */
-void RDA_ManualUp(I2C_TypeDef* I2Cx);
+RDA_Status RDA_ManualUp(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
@@ -474,32 +739,35 @@ void RDA_ManualUp(I2C_TypeDef* I2Cx);
  * | ------ | ------- | 
  * |    0   | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 87.0 MHz |
  * | 1 or 2 | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 76.0 MHz |
- * |    3   | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 65.0 MHz |
- * @param I2Cx I2C Port
+ * |    3   | Frequency = Channel Spacing (kHz) x READCHAN[9:0]+ 65.0 MHz (50.0 MHz when MODE_50_60 = 0) |
+ * @param dev Device handle
+ * @return uint32_t frequency in kHz
  */
-uint16_t RDA_GetRealFrequency(I2C_TypeDef* I2Cx);
+uint32_t RDA_GetRealFrequency(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Call seek on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param seek_mode if 0, wrap at the upper or lower band limit and continue seeking; 1 = stop seeking at the upper or lower band limit
  * @param direction if 0, seek down; if 1, seek up.
+ * @return RDA_Status
  */
-void RDA_Seek(I2C_TypeDef* I2Cx, uint8_t seek_mode, uint8_t direction);
+RDA_Status RDA_Seek(RDA_Handle* dev, uint8_t seek_mode, uint8_t direction);
 
 /**
  * @ingroup RDA_API
  * @brief Set seek threshold on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value RSSI threshold
+ * @return RDA_Status
  */
-void RDA_SetSeekThreshold(I2C_TypeDef* I2Cx, uint8_t value);
+RDA_Status RDA_SetSeekThreshold(RDA_Handle* dev, uint8_t value);
 
 /**
  * @ingroup RDA_API
  * @brief Set FM band on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param band FM band
  * | Value | Description                 |
  * | ----- | --------------------------- |
@@ -507,13 +775,14 @@ void RDA_SetSeekThreshold(I2C_TypeDef* I2Cx, uint8_t value);
  * | 01    | 76–91 MHz (Japan)           |
  * | 10    | 76–108 MHz (world wide)     |
  * | 11    | 65 –76 MHz (East Europe) or 50-65MHz (see bit 9 of gegister 0x06) |
+ * @return RDA_Status
  */
-void RDA_SetBand(I2C_TypeDef* I2Cx, uint8_t band);
+RDA_Status RDA_SetBand(RDA_Handle* dev, uint8_t band);
 
 /**
  * @ingroup RDA_API
  * @brief Set FM space on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param space FM space
  * | Value | Description |
  * | ----- | ----------- |
@@ -521,166 +790,576 @@ void RDA_SetBand(I2C_TypeDef* I2Cx, uint8_t band);
  * | 01    | 200KHz      |
  * | 10    | 50KHz       |
  * | 11    | 25KHz       |
+ * @return RDA_Status
  */
-void RDA_SetSpace(I2C_TypeDef* I2Cx, uint8_t space);
+RDA_Status RDA_SetSpace(RDA_Handle* dev, uint8_t space);
 
 /**
  * @ingroup RDA_API
  * @brief Get the current RSSI
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @details RSSI - 000000(Min) 111111(Max) RSSI scale is logarithmic.
  * @return int32_t
  */
-int32_t RDA_GetQuality(I2C_TypeDef* I2Cx);
+int32_t RDA_GetQuality(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Set FM soft mute on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetSoftMute(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetSoftMute(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Set FM mute on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetMute(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetMute(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Set mono on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetMono(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetMono(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Set bass on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetBass(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetBass(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Get mono status on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return value TRUE/FALSE
  */
-BOOL RDA_GetSterioStatus(I2C_TypeDef* I2Cx);
+BOOL RDA_GetSterioStatus(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Set volume on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value 0-15 levels
+ * @return RDA_Status
  */
-void RDA_SetVolume(I2C_TypeDef* I2Cx, uint8_t value);
+RDA_Status RDA_SetVolume(RDA_Handle* dev, uint8_t value);
 
 /**
  * @ingroup RDA_API
  * @brief Get internal volume on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return uint8_t 0-15 levels
  */
-uint8_t RDA_GetVolume(I2C_TypeDef* I2Cx);
+uint8_t RDA_GetVolume(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Call volume up on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return RDA_Status
  */
-void RDA_SetVolumeUp(I2C_TypeDef* I2Cx);
+RDA_Status RDA_SetVolumeUp(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Call volume down on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return RDA_Status
  */
-void RDA_SetVolumeDown(I2C_TypeDef* I2Cx);
+RDA_Status RDA_SetVolumeDown(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Set FM De-Emphasis on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param deEmphasis deEmphasis
+ * @return RDA_Status
  */
-void RDA_SetFMDeEmphasis(I2C_TypeDef* I2Cx, uint8_t deEmphasis);
+RDA_Status RDA_SetFMDeEmphasis(RDA_Handle* dev, uint8_t deEmphasis);
 
 /**
  * @ingroup RDA_API
  * @brief Set RDS on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetRDS(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetRDS(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Set RBDS on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetRBDS(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetRBDS(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Get RDS Ready on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return TRUE/FALSE
  */
-BOOL RDA_GetRDSReady(I2C_TypeDef* I2Cx);
+BOOL RDA_GetRDSReady(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Get RDS Sync on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return TRUE/FALSE
  */
-BOOL RDA_GetRDSSync(I2C_TypeDef* I2Cx);
+BOOL RDA_GetRDSSync(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Get Block ID on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @return uint8_t
  */
-uint8_t RDA_GetBlockId(I2C_TypeDef* I2Cx);
+uint8_t RDA_GetBlockId(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
- * @brief Set volume down on RDA chip
- * @param I2Cx I2C Port
+ * @brief Get the error level of RDS block A on RDA chip
+ * @details 0 = no errors, 1 = 1-2 errors, 2 = 3-5 errors, 3 = 6+ errors (uncorrectable).
+ * @param dev Device handle
  * @return uint8_t
  */
-uint8_t RDA_GetErrorBlockB(I2C_TypeDef* I2Cx);
+uint8_t RDA_GetErrorBlockA(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the error level of RDS block B on RDA chip
+ * @details Same levels as RDA_GetErrorBlockA.
+ * @param dev Device handle
+ * @return uint8_t
+ */
+uint8_t RDA_GetErrorBlockB(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Get RDS info state on RDA chip
- * @param I2Cx I2C Port
+ * @details TRUE when RDS is synchronized and block B of the current group had no errors;
+ * @details REG0A and REG0B are read together.
+ * @param dev Device handle
  * @return TRUE/FALSE
  */
-BOOL RDA_GetRDSInfoState(I2C_TypeDef* I2Cx);
+BOOL RDA_GetRDSInfoState(RDA_Handle* dev);
 
 /**
  * @ingroup RDA_API
  * @brief Set RDS FIFO on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
  * @param value TRUE/FALSE
+ * @return RDA_Status
  */
-void RDA_SetRDSFifo(I2C_TypeDef* I2Cx, BOOL value);
+RDA_Status RDA_SetRDSFifo(RDA_Handle* dev, BOOL value);
 
 /**
  * @ingroup RDA_API
  * @brief Call clear RDS FIFO on RDA chip
- * @param I2Cx I2C Port
+ * @param dev Device handle
+ * @return RDA_Status
+ */
+RDA_Status RDA_ClearRDSFifo(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Refresh all status registers (0x0A to 0x0F) on RDA chip
+ * @details Single sequential read through I2C_ADDR_FULL_ACCESS instead of one read per register.
+ * @param dev Device handle
+ * @return RDA_Status
+ */
+RDA_Status RDA_RefreshStatus(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the RDS blocks of the last status refresh
+ * @details Served from the shadow registers, no bus access. Call RDA_RefreshStatus first.
+ * @param dev Device handle
+ * @param blocks array of 4 words, filled with blocks A, B, C and D
+ */
+void RDA_GetRDSBlocks(RDA_Handle* dev, uint16_t* blocks);
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the staleness window of the status getters of RDA chip
+ * @details Getters of REG0A/REG0B (channel, RSSI, stereo, RDS flags) use the shadow register when
+ * @details it was read less than window ms ago, by a getter, a tune poll or RDA_RefreshStatus.
+ * @details Any register write drops the cache. Without SYSTICK_DELAY the getters always read.
+ * @param dev Device handle
+ * @param window ms, 0 = read the chip on every call; RDA_CACHE_WINDOW after RDA_Init
+ */
+void RDA_SetCacheWindow(RDA_Handle* dev, uint16_t window);
+
+/**
+ * @ingroup RDA_API
+ * @brief Compare the writable registers of RDA chip with the shadow registers
+ * @details Reads REG02-REG07 back in one transfer. Bits the chip clears by itself (SOFT_RESET,
+ * @details SEEK, TUNE, RDS_FIFO_CLR) are not compared.
+ * @param dev Device handle
+ * @param diverged Filled with a bit per register that differs (bit n = REG0n), 0 when in sync
+ * @return RDA_Status
+ */
+RDA_Status RDA_Verify(RDA_Handle* dev, uint8_t* diverged);
+
+/**
+ * @ingroup RDA_API
+ * @brief Bring RDA chip back in line with the shadow registers, e.g. after a brown-out
+ * @details Verifies first and writes nothing when the chip is in sync. Otherwise REG02-REG07 go
+ * @details out in one sequential write; a chip that lost ENABLE is powered up first (waiting for
+ * @details FM_READY) and tuned again, so does a chip whose channel differs. Blocks until done;
+ * @details not while a tune, seek or scan is pending.
+ * @param dev Device handle
+ * @return RDA_Status, RDA_ERROR while an operation is pending
+ */
+RDA_Status RDA_Resync(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the status cache and verification counters of RDA chip
+ * @param dev Device handle
+ * @param stats Filled with the counters since RDA_Init
+ */
+void RDA_GetCacheStats(RDA_Handle* dev, RDA_CacheStats* stats);
+
+/**
+ * @ingroup RDA_API
+ * @brief Start a batched register update on RDA chip
+ * @details Setters called until RDA_CommitUpdate only update the shadow registers.
+ * @param dev Device handle
+ */
+void RDA_BeginUpdate(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Write all registers changed since RDA_BeginUpdate to RDA chip
+ * @details One sequential write from 0x02 up to the highest dirty register, one settle delay.
+ * @param dev Device handle
+ * @return RDA_Status
+ */
+RDA_Status RDA_CommitUpdate(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the receiver settings of RDA chip for the preset store
+ * @details Fills frequency, band, space, volume and the bass/mono flags; the PS name is left to the caller.
+ * @param dev Device handle
+ * @param state Filled with the settings
+ */
+void RDA_GetState(RDA_Handle* dev, RDA_StoreEntry* state);
+
+/**
+ * @ingroup RDA_API
+ * @brief Restore stored receiver settings on RDA chip
+ * @details One batched update: a single sequential write of REG02-REG05 that also starts the tune,
+ * @details then the tune is waited for.
+ * @param dev Device handle
+ * @param state Settings, see RDA_StoreGetState and RDA_StoreGetPreset
+ * @return RDA_Status
+ */
+RDA_Status RDA_RestoreState(RDA_Handle* dev, const RDA_StoreEntry* state);
+
+/**
+ * @ingroup RDA_API
+ * @brief Start tuning a frequency on RDA chip without waiting for completion
+ * @details Drive the operation with RDA_TunePoll from the main loop, or let the timer service
+ * @details (RDA_TimerRun/RDA_TimerSleep) poll STC for it. Refused with RDA_ERROR between
+ * @details RDA_BeginUpdate and RDA_CommitUpdate, where the register write would only be deferred.
+ * @param dev Device handle
+ * @param frequency frequency in kHz
+ * @param callback called once when the tune completes, may be NULL
+ * @return RDA_Status
+ */
+RDA_Status RDA_TuneAsync(RDA_Handle* dev, uint32_t frequency, RDA_TuneCallback callback);
+
+/**
+ * @ingroup RDA_API
+ * @brief Start a seek on RDA chip and track its completion
+ * @details Drive the operation with RDA_TunePoll from the main loop, or let the timer service
+ * @details (RDA_TimerRun/RDA_TimerSleep) poll STC for it. Refused with RDA_ERROR between
+ * @details RDA_BeginUpdate and RDA_CommitUpdate, where the register write would only be deferred.
+ * @param dev Device handle
+ * @param seek_mode if 0, wrap at the upper or lower band limit and continue seeking; 1 = stop seeking at the upper or lower band limit
+ * @param direction if 0, seek down; if 1, seek up.
+ * @param callback called once when the seek completes, may be NULL
+ * @return RDA_Status
+ */
+RDA_Status RDA_SeekAsync(RDA_Handle* dev, uint8_t seek_mode, uint8_t direction, RDA_TuneCallback callback);
+
+/**
+ * @ingroup RDA_API
+ * @brief Step the asynchronous tune/seek on RDA chip
+ * @details Returns the final status (RDA_TUNE_DONE or RDA_TUNE_SEEK_FAIL) once, then RDA_TUNE_IDLE.
+ * @details An operation past its deadline (500 ms, 3 s for a seek) ends with RDA_TUNE_ERROR and
+ * @details RDA_TIMEOUT; with the tune interrupt, STC is read first in case the edge was missed.
+ * @param dev Device handle
+ * @return RDA_TuneStatus
+ */
+RDA_TuneStatus RDA_TunePoll(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Enable the seek/tune complete interrupt on GPIO2 of RDA chip
+ * @details While enabled, tune and seek completion is taken from RDA_NotifySTC instead of polling REG0A.
+ * @details Configuring the EXTI line is up to the application.
+ * @param dev Device handle
+ * @param value TRUE/FALSE
+ * @return RDA_Status
+ */
+RDA_Status RDA_SetTuneInterrupt(RDA_Handle* dev, BOOL value);
+
+/**
+ * @ingroup RDA_API
+ * @brief Notify the driver that GPIO2 signalled seek/tune complete
+ * @details Call from the EXTI handler of the pin wired to GPIO2 (falling edge).
+ * @param dev Device handle
+ */
+void RDA_NotifySTC(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the number of REG0A reads made waiting for the last tune or seek
+ * @details Compare a polled and an interrupt driven run of the same tune for the polls GPIO2 saves.
+ * @param dev Device handle
+ * @return uint32_t
+ */
+uint32_t RDA_GetTunePolls(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the transfer queue register accesses of RDA chip go through
+ * @param dev Device handle
+ * @return RDA_XferQueue*
+ */
+RDA_XferQueue* RDA_GetXferQueue(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Install the transfer port used for RDA chip register accesses
+ * @details Default is a polled port on the I2C port of the device. Call with no transfer pending.
+ * @param dev Device handle
+ * @param port Port operations, e.g. RDA_XferPortSTM32
+ * @param context Port state passed to the operations
+ */
+void RDA_SetXferPort(RDA_Handle* dev, const RDA_XferPort* port, void* context);
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the bus retry budget of RDA chip register accesses
+ * @details A failed transfer recovers the bus (SCL clock-out, peripheral re-init) before each retry.
+ * @param dev Device handle
+ * @param retries retries per transfer, 0 = fail on first error
+ */
+void RDA_SetRetries(RDA_Handle* dev, uint8_t retries);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the result of the last bus transfer to RDA chip
+ * @details Useful after getters, which cannot return a status.
+ * @param dev Device handle
+ * @return RDA_Status
+ */
+RDA_Status RDA_GetLastError(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Read the status of RDA chip and decode a new RDS group
+ * @details One burst read of REG0A-REG0F; the blocks are decoded with their BLERA/BLERB levels
+ * @details under the policy of RDA_SetRDSPolicy when RDSR is set.
+ * @param dev Device handle
+ * @param rds Decoder, see RDA_RDSInit
+ * @return RDA_RDS_xxx flags of what changed, 0 when no group was ready or on a bus error
+ */
+uint8_t RDA_ReadRDS(RDA_Handle* dev, RDA_RDS* rds);
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the block acceptance policy of RDA_ReadRDS
+ * @details Groups captured with RDA_CaptureRDS carry their levels; pass the policy to RDA_RDSDecodeGroup.
+ * @param dev Device handle
+ * @param policy Policy, NULL for RDA_RDSPolicyDefault
+ */
+void RDA_SetRDSPolicy(RDA_Handle* dev, const RDA_RDSPolicy* policy);
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the ring RDA_CaptureRDS fills
+ * @details Set it before starting the interrupt that captures; drain it with RDA_RDSRingPop.
+ * @param dev Device handle
+ * @param ring Ring, see RDA_RDSRingInit; NULL stops the capture
+ */
+void RDA_SetRDSRing(RDA_Handle* dev, RDA_RDSRing* ring);
+
+/**
+ * @ingroup RDA_API
+ * @brief Capture a new RDS group of RDA chip into the ring
+ * @details Call from a timer interrupt at least every 80 ms, so no group is missed while the
+ * @details main loop is busy. Reads REG0A-REG0F through the transfer queue and pushes the blocks
+ * @details with BLERA/BLERB and a timestamp when RDSR is set. Does nothing while an application
+ * @details call is using the bus or the previous capture is still on the bus; the chip keeps a
+ * @details group for about 88 ms, so the next tick picks it up. Needs an interrupt driven port
+ * @details installed with RDA_SetXferPort (one with lock/unlock, e.g. RDA_XferPortSTM32): on the
+ * @details polled port, and during the settle time of a write, nothing is started. Without the
+ * @details interrupt port capture from a task with RDA_CaptureRDSStep.
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_CaptureRDS(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Capture a new RDS group of RDA chip into the ring, from the main loop or a task
+ * @details The thread context counterpart of RDA_CaptureRDS, on any port: on the polled port the
+ * @details read completes before it returns. Run it at least every 80 ms, from a task of a higher
+ * @details priority than the one that drains the ring. Does nothing during the settle time of a write.
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_CaptureRDSStep(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Scan the current band of RDA chip
+ * @details RDA_SCAN_STEP tunes every channel: one REG03 write and, once STC is set, one sequential
+ * @details read of REG0A/REG0B (no write settle delay). Channels with FM_TRUE are recorded.
+ * @details RDA_SCAN_SEEK chains hardware seeks that stop at the band limit and records every hit
+ * @details until SF is set; channels below SEEKTH are skipped by the chip without bus traffic.
+ * @details Stations are checked for RDS sync when RDS is enabled. The chip stays on the last channel visited.
+ * @details Refused like RDA_ScanStart.
+ * @param dev Device handle
+ * @param mode RDA_SCAN_STEP or RDA_SCAN_SEEK
+ * @param table Station table, stations and capacity set by the caller
+ * @return RDA_Status
+ */
+RDA_Status RDA_Scan(RDA_Handle* dev, uint8_t mode, RDA_StationTable* table);
+
+/**
+ * @ingroup RDA_API
+ * @brief Start a scan of the current band of RDA chip without waiting for it
+ * @details Drive it with RDA_ScanPoll. Scans of several devices can be polled in turn, so the
+ * @details tune time of one chip overlaps the others. The table must stay valid until the scan ends.
+ * @details Not while a tune, seek or scan is pending, nor between RDA_BeginUpdate and RDA_CommitUpdate.
+ * @param dev Device handle
+ * @param mode RDA_SCAN_STEP or RDA_SCAN_SEEK
+ * @param table Station table, stations and capacity set by the caller
+ * @return RDA_Status, RDA_ERROR while an operation is pending or an update is open
+ */
+RDA_Status RDA_ScanStart(RDA_Handle* dev, uint8_t mode, RDA_StationTable* table);
+
+/**
+ * @ingroup RDA_API
+ * @brief Step the scan of RDA chip
+ * @details Does no bus access until the next status poll is due (or GPIO2 fired with the STC
+ * @details interrupt enabled), at most one status read otherwise.
+ * @param dev Device handle
+ * @return RDA_TUNE_IN_PROGRESS, then RDA_TUNE_DONE or RDA_TUNE_ERROR once, then RDA_TUNE_IDLE
+ */
+RDA_TuneStatus RDA_ScanPoll(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Set the signal monitor RDA_MonitorTick or RDA_MonitorStep feeds
+ * @details Set it before starting the interrupt that samples. The monitor is emptied.
+ * @param dev Device handle
+ * @param monitor Monitor; NULL stops monitoring
+ * @param period ms between samples (SysTick builds), every tick samples otherwise
+ */
+void RDA_SetMonitor(RDA_Handle* dev, RDA_Monitor* monitor, uint16_t period);
+
+/**
+ * @ingroup RDA_API
+ * @brief Sample the signal quality of RDA chip into the monitor
+ * @details Call from a timer interrupt, alone or next to RDA_CaptureRDS. Once the period has
+ * @details elapsed, REG0A and REG0B are read together in one sequential read through the transfer
+ * @details queue; REG0C is not touched, so RDSR stays set for the RDS capture. Samples taken while
+ * @details a tune or seek is running (STC clear) are discarded. Does nothing while an application
+ * @details call is using the bus or the previous sample is still on the bus. Like RDA_CaptureRDS it
+ * @details needs an interrupt driven port and starts nothing during the settle time of a write;
+ * @details without that port sample from a task with RDA_MonitorStep.
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_MonitorTick(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Sample the signal quality of RDA chip into the monitor, from the main loop or a task
+ * @details The thread context counterpart of RDA_MonitorTick, on any port: on the polled port the
+ * @details read completes before it returns. Call it as often as convenient, a sample is taken
+ * @details once the period of RDA_SetMonitor has elapsed. Does nothing during the settle time of a write.
+ * @param dev Device handle
+ * @return TRUE when a read was started
+ */
+BOOL RDA_MonitorStep(RDA_Handle* dev);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the signal statistics of RDA chip
+ * @details Reads the monitor only, no bus access.
+ * @param dev Device handle
+ * @param stats Filled with the statistics of the monitor window
+ * @return TRUE when the window holds samples
+ */
+BOOL RDA_GetSignalStats(RDA_Handle* dev, RDA_SignalStats* stats);
+
+/**
+ * @ingroup RDA_API
+ * @brief Check the alternative frequencies of the current program on RDA chip
+ * @details Mutes the audio, tunes the AFs of the list one after the other through RDA_SetChannel
+ * @details and compares their REG0B RSSI (FM_TRUE set) with the current channel. The chip then
+ * @details stays on the best AF when it beats the current channel by a margin, or tunes back.
+ * @details In SysTick builds a candidate is only tried while it and the tune back fit into the
+ * @details mute window, based on the longest candidate so far; the next check starts with the AFs
+ * @details that were left, from the top after a full pass or for another program. AFs outside the
+ * @details current band and space are skipped. An AF that beats the best channel so far is only
+ * @details taken once an RDS group received on it carries the PI of the list; the audio stays
+ * @details muted while the check waits for it (a group takes about 88 ms), within what is left of
+ * @details the mute window. A mute window of 250 ms or more leaves room for it.
+ * @param dev Device handle
+ * @param list AF list of the program, see RDA_AFFind
+ * @param muteWindow ms the audio may stay muted
+ * @param switched Set to TRUE when the chip moved to an AF, may be NULL
+ * @return RDA_Status
+ */
+RDA_Status RDA_AFCheck(RDA_Handle* dev, const RDA_AFList* list, uint16_t muteWindow, BOOL* switched);
+
+/**
+ * @ingroup RDA_API
+ * @brief Set a wall clock from an RDS Clock-Time
+ * @details Call when RDA_RDSDecode reports RDA_RDS_CT_READY. The CT group is sent at the start of
+ * @details the minute, so the time is tied to the moment the group was received: the capture
+ * @details timestamp of the group (RDA_RDSGroup) or getMillis() right after RDA_ReadRDS.
+ * @details No bus access; a new sync each minute keeps the timebase drift out.
+ * @param clock Clock
+ * @param time Accepted Clock-Time, see RDA_RDS
+ * @param received getMillis() when the group was received
+ */
+void RDA_SyncClock(RDA_Clock* clock, const RDA_RDSTime* time, uint32_t received);
+
+/**
+ * @ingroup RDA_API
+ * @brief Get the time of a wall clock
+ * @details Adds the milliseconds since the sync to the Clock-Time (SysTick builds); the time of
+ * @details the sync is returned otherwise.
+ * @param clock Clock
+ * @param local TRUE for local time, FALSE for UTC
+ * @return seconds since 1970-01-01, 0 when the clock was never synced
  */
-void RDA_ClearRDSFifo(I2C_TypeDef* I2Cx);
+uint32_t RDA_GetClock(const RDA_Clock* clock, BOOL local);
 
 #ifdef __cplusplus
 }
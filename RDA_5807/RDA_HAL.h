@@ -0,0 +1,238 @@
+#ifndef __RDA_HAL_H
+#define __RDA_HAL_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_Xfer.h>
+
+/**
+ * @defgroup GA05 Hardware abstraction
+ * @brief Bus and timer services the driver runs on
+ * @details RDA_HAL_STM32.c implements them with the STM32 standard peripheral library,
+ * @details RDA_HAL_Linux.c (RDA_HAL_LINUX defined) forwards the bus to a host side device model
+ * @details and keeps a virtual millisecond clock, so host runs are fast and repeatable.
+ */
+
+#define RDA_FLASH_PAGE_SIZE 1024   //!< Flash erase page in bytes (STM32F10x medium density)
+
+#ifdef SYSTICK_DELAY
+#define RDA_I2C_TIMEOUT 5           //!< ms budget of a single bus event
+#else
+#define RDA_I2C_TIMEOUT 50000       //!< Loop budget of a single bus event
+#endif
+
+#ifdef RDA_HAL_LINUX
+
+/**
+ * @ingroup GA05
+ * @brief Host bus: register accesses are forwarded to a device model
+ */
+typedef struct RDA_BusTypeDef
+{
+    RDA_XferStatus (*write)(void* device, uint8_t address, uint8_t reg, const uint16_t* data, uint8_t length);
+    RDA_XferStatus (*read)(void* device, uint8_t address, uint8_t reg, uint16_t* data, uint8_t length);
+    void (*recover)(void* device);  //!< Bus recovery (SCL clocked out, STOP), may be NULL
+    void* device;
+} RDA_BusTypeDef;
+
+/**
+ * @ingroup GA05
+ * @brief Advance the virtual clock of the host backend
+ * @param ms milliseconds
+ */
+void RDA_HAL_Advance(uint32_t ms);
+
+/**
+ * @ingroup GA05
+ * @brief Advance the virtual clock of the host backend, used by device models for bus time
+ * @param us microseconds
+ */
+void RDA_HAL_AdvanceMicros(uint32_t us);
+
+/**
+ * @ingroup GA05
+ * @brief Get the milliseconds the driver spent waiting in Delay or RDA_HAL_Idle
+ * @return uint32_t
+ */
+uint32_t RDA_HAL_GetWaitMillis(void);
+
+/**
+ * @ingroup GA05
+ * @brief Get the milliseconds the driver slept in RDA_HAL_Idle, the part of the waits that is not Delay
+ * @return uint32_t
+ */
+uint32_t RDA_HAL_GetIdleMillis(void);
+
+/**
+ * @ingroup GA05
+ * @brief Back the flash with a file, stands in for the on-chip flash
+ * @details A missing file is created erased. Every erase and program is written through, so the
+ * @details contents survive the process like flash survives a reset.
+ * @param path file
+ * @param base first flash address
+ * @param size bytes, a multiple of RDA_FLASH_PAGE_SIZE
+ */
+void RDA_HAL_FlashFile(const char* path, uint32_t base, uint32_t size);
+
+/**
+ * @ingroup GA05
+ * @brief Cut the power after a number of programmed half-words, later programs and erases fail
+ * @param programs half-words that still succeed, 0 restores the power
+ */
+void RDA_HAL_FlashFailAfter(uint32_t programs);
+
+/**
+ * @ingroup GA05
+ * @brief Get the page erases since the flash file was opened
+ * @return uint32_t
+ */
+uint32_t RDA_HAL_FlashGetErases(void);
+
+/**
+ * @ingroup GA05
+ * @brief One-shot event of the virtual clock, stands in for an interrupt of the host backend
+ */
+typedef struct RDA_HAL_Alarm
+{
+    void (*fire)(struct RDA_HAL_Alarm* alarm);
+    void* context;
+    uint64_t at;                    //!< Virtual µs it fires at
+    struct RDA_HAL_Alarm* next;     //!< Next armed alarm
+} RDA_HAL_Alarm;
+
+/**
+ * @ingroup GA05
+ * @brief Arm an alarm, it fires once while the clock advances past its time
+ * @details Like the tick it also fires in the middle of a driver call, and it wakes RDA_HAL_Idle.
+ * @details Alarms are not nested; they may interrupt the tick, the tick does not interrupt them.
+ * @param alarm Alarm, re-armed when it was armed
+ * @param us microseconds from now
+ * @param fire function, called with the alarm
+ * @param context user data for the function
+ */
+void RDA_HAL_AlarmStart(RDA_HAL_Alarm* alarm, uint32_t us, void (*fire)(RDA_HAL_Alarm* alarm), void* context);
+
+/**
+ * @ingroup GA05
+ * @brief Disarm an alarm, nothing happens when it is not armed
+ * @param alarm Alarm
+ */
+void RDA_HAL_AlarmStop(RDA_HAL_Alarm* alarm);
+
+/**
+ * @ingroup GA05
+ * @brief Call a function every period of virtual time, stands in for a timer interrupt
+ * @details The tick runs while the clock advances, also in the middle of a driver call. It is not re-entered.
+ * @param tick function, NULL stops the tick
+ * @param period milliseconds
+ */
+void RDA_HAL_SetTick(void (*tick)(void), uint32_t period);
+
+#else
+
+#include <stm32f10x_i2c.h>
+
+/**
+ * @ingroup GA05
+ * @brief STM32 bus: the I2C peripheral
+ */
+typedef I2C_TypeDef RDA_BusTypeDef;
+
+#endif
+
+/**
+ * @ingroup GA05
+ * @brief Write words to the chip, high byte first
+ * @param bus Bus
+ * @param address 7-bit I2C address
+ * @param reg register address written first, RDA_XFER_NO_REG for sequential access
+ * @param data words
+ * @param length number of words
+ * @return RDA_XferStatus
+ */
+RDA_XferStatus RDA_HAL_Write(RDA_BusTypeDef* bus, uint8_t address, uint8_t reg, const uint16_t* data, uint8_t length);
+
+/**
+ * @ingroup GA05
+ * @brief Read words from the chip, also used for burst reads through the sequential access address
+ * @param bus Bus
+ * @param address 7-bit I2C address
+ * @param reg register address written first, RDA_XFER_NO_REG for sequential access
+ * @param data buffer
+ * @param length number of words
+ * @return RDA_XferStatus
+ */
+RDA_XferStatus RDA_HAL_Read(RDA_BusTypeDef* bus, uint8_t address, uint8_t reg, uint16_t* data, uint8_t length);
+
+/**
+ * @ingroup GA05
+ * @brief Free a stuck bus and re-initialise it
+ * @param bus Bus
+ */
+void RDA_HAL_Recover(RDA_BusTypeDef* bus);
+
+/**
+ * @ingroup GA05
+ * @brief Erase a flash page, all half-words read 0xFFFF afterwards
+ * @param address first address of the page
+ * @return 1 on success
+ */
+uint8_t RDA_HAL_FlashErase(uint32_t address);
+
+/**
+ * @ingroup GA05
+ * @brief Program an erased flash half-word and verify it
+ * @param address even address
+ * @param value half-word
+ * @return 1 on success
+ */
+uint8_t RDA_HAL_FlashProgram(uint32_t address, uint16_t value);
+
+/**
+ * @ingroup GA05
+ * @brief Read a flash half-word
+ * @param address even address
+ * @return uint16_t
+ */
+uint16_t RDA_HAL_FlashRead(uint32_t address);
+
+/**
+ * @ingroup GA05
+ * @brief Wait for the next event (interrupt or timer tick) instead of spinning
+ */
+void RDA_HAL_Idle(void);
+
+/**
+ * @ingroup GA05
+ * @brief Start the millisecond timebase
+ */
+void Delay_Init(void);
+
+/**
+ * @ingroup GA05
+ * @brief Get the millisecond timebase
+ * @return uint32_t
+ */
+uint32_t getMillis(void);
+
+/**
+ * @ingroup GA05
+ * @brief Get the microsecond timebase, for time accounting; wraps after about 71 minutes
+ * @return uint32_t
+ */
+uint32_t getMicros(void);
+
+/**
+ * @ingroup GA05
+ * @brief Wait for a number of milliseconds, sleeping in RDA_HAL_Idle between ticks
+ * @param delay milliseconds
+ */
+void Delay(uint32_t delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_HAL_H */
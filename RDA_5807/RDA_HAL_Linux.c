@@ -0,0 +1,296 @@
+#include <RDA_HAL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLASH_PROGRAM_US    52      // Half-word program time, STM32F10x datasheet typical
+#define FLASH_ERASE_US      20000   // Page erase time, datasheet minimum
+
+static uint64_t virtualMicros = 0;
+static uint64_t waitMicros = 0;
+static uint64_t idleMicros = 0;
+static void (*tickFunction)(void) = 0;
+static uint64_t tickPeriod = 0;
+static uint64_t tickNext = 0;
+static uint8_t inTick = 0;
+static RDA_HAL_Alarm* alarms = 0;   // Armed alarms, unordered
+static uint8_t inAlarm = 0;
+static FILE* flashFile = 0;
+static uint8_t* flashImage = 0;
+static uint32_t flashBase = 0;
+static uint32_t flashSize = 0;
+static uint32_t flashErases = 0;
+static uint32_t flashPrograms = 0;  // Half-words left before the power cut
+static uint8_t flashFailing = 0;    // A power cut is armed
+static uint8_t flashCut = 0;        // The power is cut, nothing is programmed or erased
+
+RDA_XferStatus RDA_HAL_Write(RDA_BusTypeDef* bus, uint8_t address, uint8_t reg, const uint16_t* data, uint8_t length)
+{
+    return bus->write(bus->device, address, reg, data, length);
+}
+
+RDA_XferStatus RDA_HAL_Read(RDA_BusTypeDef* bus, uint8_t address, uint8_t reg, uint16_t* data, uint8_t length)
+{
+    return bus->read(bus->device, address, reg, data, length);
+}
+
+void RDA_HAL_Recover(RDA_BusTypeDef* bus)
+{
+    // The device model decides what the clocks free
+    if (bus->recover)
+    {
+        bus->recover(bus->device);
+    }
+}
+
+/*
+ * Gets the armed alarm due first, NULL when none is armed
+ */
+static RDA_HAL_Alarm* alarmFirst(void)
+{
+    RDA_HAL_Alarm* first = alarms;
+    RDA_HAL_Alarm* alarm;
+
+    for (alarm = alarms; alarm; alarm = alarm->next)
+    {
+        if (alarm->at < first->at)
+        {
+            first = alarm;
+        }
+    }
+    return first;
+}
+
+void RDA_HAL_Idle(void)
+{
+    uint64_t wake = virtualMicros + 1000;
+    RDA_HAL_Alarm* alarm = inAlarm ? 0 : alarmFirst();
+
+    // Nothing else runs on the host, let time pass until the next millisecond or alarm
+    if (alarm && alarm->at > virtualMicros && alarm->at < wake)
+    {
+        wake = alarm->at;
+    }
+    waitMicros += wake - virtualMicros;
+    idleMicros += wake - virtualMicros;
+    RDA_HAL_AdvanceMicros((uint32_t)(wake - virtualMicros));
+}
+
+void RDA_HAL_Advance(uint32_t ms)
+{
+    RDA_HAL_AdvanceMicros(ms * 1000);
+}
+
+void RDA_HAL_AdvanceMicros(uint32_t us)
+{
+    uint64_t end = virtualMicros + us;
+    RDA_HAL_Alarm* alarm;
+    uint8_t ticking;
+
+    // Fire the alarms and ticks that fall into the interval at their own time. Alarms are not
+    // nested and may interrupt a tick, a tick does not interrupt an alarm
+    while (1)
+    {
+        alarm = inAlarm ? 0 : alarmFirst();
+        ticking = tickFunction && !inTick && !inAlarm && tickNext <= end;
+        if (alarm && alarm->at <= end && (!ticking || alarm->at <= tickNext))
+        {
+            if (virtualMicros < alarm->at)
+            {
+                virtualMicros = alarm->at;
+            }
+            RDA_HAL_AlarmStop(alarm);
+            inAlarm = 1;
+            alarm->fire(alarm);
+            inAlarm = 0;
+        }
+        else if (ticking)
+        {
+            if (virtualMicros < tickNext)
+            {
+                virtualMicros = tickNext;
+            }
+            tickNext += tickPeriod;
+            inTick = 1;
+            tickFunction();
+            inTick = 0;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (virtualMicros < end)
+    {
+        virtualMicros = end;
+    }
+}
+
+void RDA_HAL_SetTick(void (*tick)(void), uint32_t period)
+{
+    tickFunction = period ? tick : 0;
+    tickPeriod = (uint64_t)period * 1000;
+    tickNext = virtualMicros + tickPeriod;
+}
+
+void RDA_HAL_AlarmStart(RDA_HAL_Alarm* alarm, uint32_t us, void (*fire)(RDA_HAL_Alarm* alarm), void* context)
+{
+    RDA_HAL_AlarmStop(alarm);
+    alarm->fire = fire;
+    alarm->context = context;
+    alarm->at = virtualMicros + us;
+    alarm->next = alarms;
+    alarms = alarm;
+}
+
+void RDA_HAL_AlarmStop(RDA_HAL_Alarm* alarm)
+{
+    RDA_HAL_Alarm** link;
+
+    for (link = &alarms; *link; link = &(*link)->next)
+    {
+        if (*link == alarm)
+        {
+            *link = alarm->next;
+            return;
+        }
+    }
+}
+
+uint32_t RDA_HAL_GetWaitMillis(void)
+{
+    return (uint32_t)(waitMicros / 1000);
+}
+
+uint32_t RDA_HAL_GetIdleMillis(void)
+{
+    return (uint32_t)(idleMicros / 1000);
+}
+
+void Delay_Init(void)
+{
+}
+
+uint32_t getMillis(void)
+{
+    return (uint32_t)(virtualMicros / 1000);
+}
+
+uint32_t getMicros(void)
+{
+    return (uint32_t)virtualMicros;
+}
+
+void Delay(uint32_t delay)
+{
+    waitMicros += (uint64_t)delay * 1000;
+    RDA_HAL_Advance(delay);
+}
+
+/*
+ * Checks a flash address range against the backing file
+ */
+static uint8_t flashMapped(uint32_t address, uint32_t length)
+{
+    return flashImage && address >= flashBase && address - flashBase + length <= flashSize;
+}
+
+/*
+ * Writes a range of the image through to the file
+ */
+static void flashSync(uint32_t offset, uint32_t length)
+{
+    fseek(flashFile, offset, SEEK_SET);
+    fwrite(flashImage + offset, 1, length, flashFile);
+    fflush(flashFile);
+}
+
+void RDA_HAL_FlashFile(const char* path, uint32_t base, uint32_t size)
+{
+    if (flashFile)
+    {
+        fclose(flashFile);
+        free(flashImage);
+    }
+    flashImage = malloc(size);
+    memset(flashImage, 0xFF, size);
+    flashBase = base;
+    flashSize = size;
+    flashErases = 0;
+    flashFailing = 0;
+    flashCut = 0;
+    flashFile = fopen(path, "r+b");
+    if (flashFile && fread(flashImage, 1, size, flashFile) == size)
+    {
+        return;
+    }
+    // Missing or short, start erased
+    if (flashFile)
+    {
+        fclose(flashFile);
+    }
+    memset(flashImage, 0xFF, size);
+    flashFile = fopen(path, "w+b");
+    flashSync(0, size);
+}
+
+void RDA_HAL_FlashFailAfter(uint32_t programs)
+{
+    flashPrograms = programs;
+    flashFailing = (programs != 0);
+    flashCut = 0;
+}
+
+uint32_t RDA_HAL_FlashGetErases(void)
+{
+    return flashErases;
+}
+
+uint8_t RDA_HAL_FlashErase(uint32_t address)
+{
+    if (flashCut || !flashMapped(address, RDA_FLASH_PAGE_SIZE) || (address - flashBase) % RDA_FLASH_PAGE_SIZE)
+    {
+        return 0;
+    }
+    RDA_HAL_AdvanceMicros(FLASH_ERASE_US);
+    memset(flashImage + address - flashBase, 0xFF, RDA_FLASH_PAGE_SIZE);
+    flashSync(address - flashBase, RDA_FLASH_PAGE_SIZE);
+    flashErases++;
+    return 1;
+}
+
+uint8_t RDA_HAL_FlashProgram(uint32_t address, uint16_t value)
+{
+    uint32_t offset = address - flashBase;
+
+    if (flashCut || !flashMapped(address, 2) || (address & 1))
+    {
+        return 0;
+    }
+    if (flashFailing && flashPrograms-- == 0)
+    {
+        flashCut = 1;
+        return 0;
+    }
+    // Like the STM32F10x, only an erased half-word can be programmed
+    if (RDA_HAL_FlashRead(address) != 0xFFFF)
+    {
+        return 0;
+    }
+    RDA_HAL_AdvanceMicros(FLASH_PROGRAM_US);
+    flashImage[offset] = value & 0xFF;
+    flashImage[offset + 1] = value >> 8;
+    flashSync(offset, 2);
+    return 1;
+}
+
+uint16_t RDA_HAL_FlashRead(uint32_t address)
+{
+    uint32_t offset = address - flashBase;
+
+    if (!flashMapped(address, 2))
+    {
+        return 0xFFFF;
+    }
+    return flashImage[offset] | ((uint16_t)flashImage[offset + 1] << 8);
+}
@@ -0,0 +1,358 @@
+#include <RDA_HAL.h>
+#include <RDA_Prof.h>
+#include <stm32f10x_gpio.h>
+#include <stm32f10x_flash.h>
+
+typedef union {
+    struct
+    {
+        uint8_t low;
+        uint8_t high;
+    } write;
+    uint16_t all;
+} wordToByte;
+
+#ifdef SYSTICK_DELAY
+#define MS_CORE (SystemCoreClock / 1000)
+__IO uint32_t systickValue = 0;
+
+void Delay_Init(void)
+{
+	SystemCoreClockUpdate(); // Update SystemCoreClock variable
+	SysTick_Config(MS_CORE); // 1 Milli second
+}
+
+uint32_t getMillis(void)
+{
+	return systickValue;
+}
+
+uint32_t getMicros(void)
+{
+	uint32_t ms;
+	uint32_t count;
+
+	// Read again when the tick interrupt ran in between
+	do
+	{
+		ms = systickValue;
+		count = SysTick->VAL;
+	}
+	while (ms != systickValue);
+	// SysTick counts down from MS_CORE - 1
+	return ms * 1000 + (MS_CORE - 1 - count) / (MS_CORE / 1000);
+}
+
+void Delay(uint32_t delay)
+{
+	uint32_t startMs = getMillis();
+	// Sleep between ticks instead of spinning, SysTick wakes the core every millisecond
+	while ((getMillis() - startMs) < delay)
+	{
+		RDA_HAL_Idle();
+	}
+}
+
+/*
+ * SysTick Interrupt Handler
+ */
+void SysTick_Handler()
+{
+	systickValue++;
+}
+#endif
+
+/*
+ * Starts a bus wait budget
+ */
+static uint32_t i2cWaitStart()
+{
+#ifdef SYSTICK_DELAY
+	return getMillis();
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Checks a bus wait budget, counts loops when SysTick is not available
+ */
+static uint8_t i2cTimedOut(uint32_t* start)
+{
+#ifdef SYSTICK_DELAY
+	return (getMillis() - *start) > RDA_I2C_TIMEOUT;
+#else
+	return ++(*start) > RDA_I2C_TIMEOUT;
+#endif
+}
+
+/* This function waits for an I2C event within the RDA_I2C_TIMEOUT budget
+ * A NACK from the slave ends the wait with a STOP condition
+ */
+RDA_XferStatus I2C_WaitEvent(I2C_TypeDef* I2Cx, uint32_t event)
+{
+	uint32_t start = i2cWaitStart();
+
+	while(!I2C_CheckEvent(I2Cx, event))
+	{
+		RDA_PROF_WAIT();
+		if(I2C_GetFlagStatus(I2Cx, I2C_FLAG_AF))
+		{
+			I2C_ClearFlag(I2Cx, I2C_FLAG_AF);
+			I2C_GenerateSTOP(I2Cx, ENABLE);
+			return RDA_XFER_NACK;
+		}
+		if(i2cTimedOut(&start))
+		{
+			return RDA_XFER_TIMEOUT;
+		}
+	}
+	return RDA_XFER_OK;
+}
+
+RDA_XferStatus I2C_Start(I2C_TypeDef* I2Cx, uint8_t address, uint8_t direction)
+{
+	uint32_t start = i2cWaitStart();
+	RDA_XferStatus status;
+
+	// Wait until I2Cx is not busy anymore
+	while(I2C_GetFlagStatus(I2Cx, I2C_FLAG_BUSY))
+	{
+		RDA_PROF_WAIT();
+		if(i2cTimedOut(&start))
+		{
+			return RDA_XFER_TIMEOUT;
+		}
+	}
+	// Send I2Cx START condition 
+	I2C_GenerateSTART(I2Cx, ENABLE);
+	// Wait for I2Cx EV5 --- Slave has acknowledged start condition
+	status = I2C_WaitEvent(I2Cx, I2C_EVENT_MASTER_MODE_SELECT);
+	if(status != RDA_XFER_OK)
+	{
+		return status;
+	}
+	// Send slave Address for write 
+	I2C_Send7bitAddress(I2Cx, address << 1, direction);
+	/* Wait for I2Cx EV6, check if
+	 * either slave has acknowledged Master transmitter or
+	 * master receiver mode, depending on the transmission
+	 * direction
+	 */
+	if(direction == I2C_Direction_Transmitter)
+    {
+		return I2C_WaitEvent(I2Cx, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED);
+	}
+	return I2C_WaitEvent(I2Cx, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED);
+}
+
+/* This function transmits one byte to the slave device
+ * Parameters:
+ * I2Cx --- the I2C peripheral e.g.I2C1, I2C2
+ * data --- the data byte to be transmitted
+ */
+RDA_XferStatus I2C_Write(I2C_TypeDef* I2Cx, uint8_t data)
+{
+	I2C_SendData(I2Cx, data);
+	// Wait for I2Cx EV8_2 --- byte has been transmitted
+	return I2C_WaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED);
+}
+
+/* This function reads one word (high byte first) from the slave device
+ * and based on mode, acknowledges the word (requests another word)
+ */
+RDA_XferStatus I2C_Read(I2C_TypeDef* I2Cx, uint8_t mode, uint16_t *buffer)
+{
+    wordToByte data = {};
+    RDA_XferStatus status;
+	// Wait until one byte has been received
+	status = I2C_WaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED);
+	if(status != RDA_XFER_OK)
+	{
+		return status;
+	}
+	// Read data from I2Cx data register and return data byte
+	data.write.high = I2C_ReceiveData(I2Cx);
+    if(mode)
+    {
+        // Enable acknowledge of recieved data
+        I2C_AcknowledgeConfig(I2Cx, ENABLE);
+    }
+    else
+    {
+        // Disable acknowledge of received data
+        // NACK also generates stop condition after last byte received
+        // See reference manual for more info
+        I2C_AcknowledgeConfig(I2Cx, DISABLE);
+        I2C_GenerateSTOP(I2Cx, ENABLE);
+    }
+    // Wait until one byte has been received
+	status = I2C_WaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED);
+	if(status != RDA_XFER_OK)
+	{
+		return status;
+	}
+	// Read data from I2Cx data register and return data byte
+	data.write.low = I2C_ReceiveData(I2Cx);
+    // Copy the data to buffer
+	*buffer = data.all;
+	return RDA_XFER_OK;
+}
+
+/* This funtion issues a stop condition and therefore
+ * releases the bus
+ */
+void I2C_Stop(I2C_TypeDef* I2Cx)
+{
+	// Send I2Cx STOP condition 
+	I2C_GenerateSTOP(I2Cx, ENABLE);
+}
+
+/*
+ * Half SCL period of the recovery clock, about 100kHz
+ */
+static void i2cRecoveryDelay()
+{
+	__IO uint32_t loops = SystemCoreClock / 800000;
+	while (loops--);
+}
+
+/* This function frees a bus held low by the slave and re-initialises the peripheral
+ * SCL is clocked out by hand (up to 9 pulses) until SDA is released, then a STOP
+ * is generated and the I2C configuration is restored after a peripheral reset.
+ * Uses the default pins: I2C1 on PB6 (SCL) / PB7 (SDA), I2C2 on PB10 (SCL) / PB11 (SDA)
+ */
+void RDA_HAL_Recover(I2C_TypeDef* I2Cx)
+{
+	GPIO_InitTypeDef GPIO_InitStructure;
+	uint16_t scl = (I2Cx == I2C1) ? GPIO_Pin_6 : GPIO_Pin_10;
+	uint16_t sda = (I2Cx == I2C1) ? GPIO_Pin_7 : GPIO_Pin_11;
+	// Configuration bits of CR1 (SMBUS..NOSTRETCH) and the timing registers
+	uint16_t cr1 = I2Cx->CR1 & 0x00FE;
+	uint16_t cr2 = I2Cx->CR2;
+	uint16_t ccr = I2Cx->CCR;
+	uint16_t trise = I2Cx->TRISE;
+	uint16_t oar1 = I2Cx->OAR1;
+	uint8_t i;
+
+	I2C_Cmd(I2Cx, DISABLE);
+	GPIO_SetBits(GPIOB, scl | sda);
+	GPIO_InitStructure.GPIO_Pin = scl | sda;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_2MHz;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_OD;
+	GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+	for (i = 0; i < 9 && !GPIO_ReadInputDataBit(GPIOB, sda); i++)
+	{
+		GPIO_ResetBits(GPIOB, scl);
+		i2cRecoveryDelay();
+		GPIO_SetBits(GPIOB, scl);
+		i2cRecoveryDelay();
+	}
+	// STOP condition, SDA rises while SCL is high
+	GPIO_ResetBits(GPIOB, sda);
+	i2cRecoveryDelay();
+	GPIO_SetBits(GPIOB, sda);
+	i2cRecoveryDelay();
+
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_OD;
+	GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+	// A glitch can leave BUSY stuck, only a software reset clears it
+	I2C_SoftwareResetCmd(I2Cx, ENABLE);
+	I2C_SoftwareResetCmd(I2Cx, DISABLE);
+	I2Cx->CR2 = cr2;
+	I2Cx->OAR1 = oar1;
+	I2Cx->CCR = ccr;
+	I2Cx->TRISE = trise;
+	I2Cx->CR1 = cr1;
+	I2C_Cmd(I2Cx, ENABLE);
+}
+
+RDA_XferStatus RDA_HAL_Write(I2C_TypeDef* I2Cx, uint8_t address, uint8_t reg, const uint16_t* data, uint8_t length)
+{
+    RDA_XferStatus status = I2C_Start(I2Cx, address, I2C_Direction_Transmitter);
+    wordToByte word = {};
+    uint8_t i;
+
+    if (status == RDA_XFER_OK && reg != RDA_XFER_NO_REG)
+    {
+        status = I2C_Write(I2Cx, reg); // Write address of the reg
+    }
+    for (i = 0; status == RDA_XFER_OK && i < length; i++)
+    {
+        word.all = data[i];
+        status = I2C_Write(I2Cx, word.write.high); // Write byte by byte to the slave
+        if (status == RDA_XFER_OK)
+        {
+            status = I2C_Write(I2Cx, word.write.low);
+        }
+    }
+    I2C_Stop(I2Cx);
+    return status;
+}
+
+RDA_XferStatus RDA_HAL_Read(I2C_TypeDef* I2Cx, uint8_t address, uint8_t reg, uint16_t* data, uint8_t length)
+{
+    RDA_XferStatus status;
+    uint8_t i;
+
+    if (reg != RDA_XFER_NO_REG)
+    {
+        status = I2C_Start(I2Cx, address, I2C_Direction_Transmitter);
+        if (status == RDA_XFER_OK)
+        {
+            status = I2C_Write(I2Cx, reg); // Request specific register access
+        }
+        I2C_Stop(I2Cx);
+        if (status != RDA_XFER_OK)
+        {
+            return status;
+        }
+    }
+    // Acknowledge every word except the last one
+    I2C_AcknowledgeConfig(I2Cx, ENABLE);
+    status = I2C_Start(I2Cx, address, I2C_Direction_Receiver);
+    for (i = 0; status == RDA_XFER_OK && i < length; i++)
+    {
+        status = I2C_Read(I2Cx, (i + 1 < length), &data[i]);
+    }
+    I2C_Stop(I2Cx);
+    return status;
+}
+
+void RDA_HAL_Idle(void)
+{
+#ifdef SYSTICK_DELAY
+    // SysTick wakes the core at least every millisecond
+    __WFI();
+#endif
+}
+
+uint8_t RDA_HAL_FlashErase(uint32_t address)
+{
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ErasePage(address);
+    FLASH_Lock();
+    return status == FLASH_COMPLETE;
+}
+
+uint8_t RDA_HAL_FlashProgram(uint32_t address, uint16_t value)
+{
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ProgramHalfWord(address, value);
+    FLASH_Lock();
+    return status == FLASH_COMPLETE && *(__IO uint16_t*)address == value;
+}
+
+uint16_t RDA_HAL_FlashRead(uint32_t address)
+{
+    // Flash is memory mapped
+    return *(__IO uint16_t*)address;
+}
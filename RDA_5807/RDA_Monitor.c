@@ -0,0 +1,162 @@
+#include <RDA_Monitor.h>
+
+#define WINDOW_SLOT(index)  ((index) & (RDA_MONITOR_WINDOW - 1))
+#define PERCENT(n, total)   ((uint8_t)(((uint16_t)(n) * 100 + (total) / 2) / (total)))
+
+// Keeps the compiler from moving state accesses across the sequence updates, see RDA_RDS.c
+#define MONITOR_BARRIER() __asm__ volatile ("" ::: "memory")
+
+/*
+ * Empties the window without touching the sequence counter
+ */
+static void monitorClear(RDA_Monitor* monitor, uint16_t channel)
+{
+    monitor->maxCount = 0;
+    monitor->minCount = 0;
+    monitor->count = 0;
+    monitor->channel = channel;
+    monitor->rssiSum = 0;
+    monitor->fmTrueCount = 0;
+    monitor->stereoCount = 0;
+    monitor->rdsBlocks = 0;
+    monitor->rdsErrors = 0;
+    monitor->total = 0;
+}
+
+/*
+ * Removes the counters of the sample that leaves the window
+ */
+static void monitorEvict(RDA_Monitor* monitor, uint8_t slot)
+{
+    uint8_t flags = monitor->flags[slot];
+
+    monitor->rssiSum -= monitor->rssi[slot];
+    monitor->fmTrueCount -= (flags & RDA_SAMPLE_FM_TRUE) ? 1 : 0;
+    monitor->stereoCount -= (flags & RDA_SAMPLE_STEREO) ? 1 : 0;
+    if (flags & RDA_SAMPLE_RDS)
+    {
+        monitor->rdsBlocks -= 2;
+        monitor->rdsErrors -= ((flags & RDA_SAMPLE_ERROR_A) ? 1 : 0) + ((flags & RDA_SAMPLE_ERROR_B) ? 1 : 0);
+    }
+}
+
+void RDA_MonitorInit(RDA_Monitor* monitor)
+{
+    monitor->next = 0;
+    monitor->sequence = 0;
+    monitorClear(monitor, 0);
+}
+
+void RDA_MonitorPush(RDA_Monitor* monitor, uint16_t channel, uint8_t rssi, uint8_t flags)
+{
+    uint8_t sample = monitor->next;
+    uint8_t oldest = (uint8_t)(sample - RDA_MONITOR_WINDOW);
+    uint8_t slot = WINDOW_SLOT(sample);
+    uint8_t back;
+
+    monitor->sequence++;
+    MONITOR_BARRIER();
+
+    if (monitor->count && channel != monitor->channel)
+    {
+        monitorClear(monitor, channel);
+    }
+    monitor->channel = channel;
+
+    if (monitor->count == RDA_MONITOR_WINDOW)
+    {
+        monitorEvict(monitor, slot);
+        monitor->count--;
+        // The evicted sample can only be at the front of a queue
+        if (monitor->maxCount && monitor->maxQueue[monitor->maxFront] == oldest)
+        {
+            monitor->maxFront = WINDOW_SLOT(monitor->maxFront + 1);
+            monitor->maxCount--;
+        }
+        if (monitor->minCount && monitor->minQueue[monitor->minFront] == oldest)
+        {
+            monitor->minFront = WINDOW_SLOT(monitor->minFront + 1);
+            monitor->minCount--;
+        }
+    }
+
+    // Samples that can no longer be the maximum (minimum) leave from the back
+    while (monitor->maxCount)
+    {
+        back = WINDOW_SLOT(monitor->maxFront + monitor->maxCount - 1);
+        if (monitor->rssi[WINDOW_SLOT(monitor->maxQueue[back])] > rssi)
+        {
+            break;
+        }
+        monitor->maxCount--;
+    }
+    monitor->maxQueue[WINDOW_SLOT(monitor->maxFront + monitor->maxCount)] = sample;
+    monitor->maxCount++;
+    while (monitor->minCount)
+    {
+        back = WINDOW_SLOT(monitor->minFront + monitor->minCount - 1);
+        if (monitor->rssi[WINDOW_SLOT(monitor->minQueue[back])] < rssi)
+        {
+            break;
+        }
+        monitor->minCount--;
+    }
+    monitor->minQueue[WINDOW_SLOT(monitor->minFront + monitor->minCount)] = sample;
+    monitor->minCount++;
+
+    monitor->rssi[slot] = rssi;
+    monitor->flags[slot] = flags;
+    monitor->rssiSum += rssi;
+    monitor->fmTrueCount += (flags & RDA_SAMPLE_FM_TRUE) ? 1 : 0;
+    monitor->stereoCount += (flags & RDA_SAMPLE_STEREO) ? 1 : 0;
+    if (flags & RDA_SAMPLE_RDS)
+    {
+        monitor->rdsBlocks += 2;
+        monitor->rdsErrors += ((flags & RDA_SAMPLE_ERROR_A) ? 1 : 0) + ((flags & RDA_SAMPLE_ERROR_B) ? 1 : 0);
+    }
+    monitor->count++;
+    monitor->total++;
+    monitor->next = sample + 1;
+
+    MONITOR_BARRIER();
+    monitor->sequence++;
+}
+
+uint8_t RDA_MonitorGetStats(const RDA_Monitor* monitor, RDA_SignalStats* stats)
+{
+    uint8_t sequence;
+    uint8_t count;
+
+    do
+    {
+        sequence = monitor->sequence;
+        MONITOR_BARRIER();
+        count = monitor->count;
+        stats->channel = monitor->channel;
+        stats->samples = count;
+        stats->total = monitor->total;
+        stats->rdsBlocks = monitor->rdsBlocks;
+        if (count)
+        {
+            stats->rssiMax = monitor->rssi[WINDOW_SLOT(monitor->maxQueue[monitor->maxFront])];
+            stats->rssiMin = monitor->rssi[WINDOW_SLOT(monitor->minQueue[monitor->minFront])];
+            stats->rssiAvg = (uint8_t)((monitor->rssiSum + count / 2) / count);
+            stats->fmTrue = PERCENT(monitor->fmTrueCount, count);
+            stats->stereo = PERCENT(monitor->stereoCount, count);
+            stats->rdsErrors = monitor->rdsBlocks ? PERCENT(monitor->rdsErrors, monitor->rdsBlocks) : 0;
+        }
+        else
+        {
+            stats->rssiMax = 0;
+            stats->rssiMin = 0;
+            stats->rssiAvg = 0;
+            stats->fmTrue = 0;
+            stats->stereo = 0;
+            stats->rdsErrors = 0;
+        }
+        MONITOR_BARRIER();
+    }
+    while ((sequence & 1) || sequence != monitor->sequence);
+
+    return count ? 1 : 0;
+}
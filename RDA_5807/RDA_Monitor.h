@@ -0,0 +1,108 @@
+#ifndef __RDA_MONITOR_H
+#define __RDA_MONITOR_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @defgroup GA08 Signal monitor
+ * @brief Rolling signal quality statistics over the last RDA_MONITOR_WINDOW samples
+ * @details Each sample is one REG0A/REG0B pair. Sums and counters are updated as a sample enters
+ * @details and the oldest one leaves; minimum and maximum RSSI come from two monotonic queues,
+ * @details so a sample costs O(1) (amortised) and reading the statistics costs O(1) as well.
+ * @details Samples are pushed from interrupt or timer context and the statistics are read by the
+ * @details application; a sequence counter lets the reader retry a copy the producer interrupted.
+ * @details Only depends on stdint, the same code runs on the target and on Linux.
+ */
+
+#define RDA_MONITOR_WINDOW  32      //!< Samples the statistics cover (power of two, at most 128)
+
+// RDA_MonitorPush sample flags
+#define RDA_SAMPLE_FM_TRUE  0x01    //!< FM_TRUE: the channel is a station
+#define RDA_SAMPLE_STEREO   0x02    //!< ST: stereo pilot locked
+#define RDA_SAMPLE_RDS      0x04    //!< RDSR: blocks A and B of a new group were received
+#define RDA_SAMPLE_ERROR_A  0x08    //!< Block A had errors (BLERA not 0)
+#define RDA_SAMPLE_ERROR_B  0x10    //!< Block B had errors (BLERB not 0)
+
+/**
+ * @ingroup GA08
+ * @brief Signal statistics over the window
+ * @details Ratios are in percent. rdsErrors is the share of RDS blocks A/B with errors; it is 0
+ * @details when no group was received in the window (rdsBlocks 0).
+ */
+typedef struct
+{
+    uint16_t channel;       //!< Channel the samples were taken on
+    uint8_t samples;        //!< Samples in the window
+    uint8_t rssiMin;        //!< Minimum RSSI
+    uint8_t rssiAvg;        //!< Average RSSI, rounded
+    uint8_t rssiMax;        //!< Maximum RSSI
+    uint8_t fmTrue;         //!< Samples with FM_TRUE, %
+    uint8_t stereo;         //!< Samples with the stereo pilot locked, %
+    uint8_t rdsErrors;      //!< RDS blocks with errors, %
+    uint8_t rdsBlocks;      //!< RDS blocks the error ratio is based on
+    uint32_t total;         //!< Samples since the last reset
+} RDA_SignalStats;
+
+/**
+ * @ingroup GA08
+ * @brief Monitor state, allocated by the application
+ */
+typedef struct
+{
+    uint8_t rssi[RDA_MONITOR_WINDOW];       //!< Sample RSSI, by sequence number
+    uint8_t flags[RDA_MONITOR_WINDOW];      //!< Sample RDA_SAMPLE_xxx flags
+    uint8_t maxQueue[RDA_MONITOR_WINDOW];   //!< Sequence numbers of decreasing RSSI, front is the maximum
+    uint8_t minQueue[RDA_MONITOR_WINDOW];   //!< Sequence numbers of increasing RSSI, front is the minimum
+    uint8_t maxFront;                       //!< Queue slot of the maximum
+    uint8_t maxCount;                       //!< Entries in maxQueue
+    uint8_t minFront;                       //!< Queue slot of the minimum
+    uint8_t minCount;                       //!< Entries in minQueue
+    uint8_t next;                           //!< Sequence number of the next sample
+    uint8_t count;                          //!< Samples in the window
+    uint16_t channel;                       //!< Channel of the samples in the window
+    uint16_t rssiSum;                       //!< Sum of the RSSI in the window
+    uint8_t fmTrueCount;                    //!< Samples with RDA_SAMPLE_FM_TRUE
+    uint8_t stereoCount;                    //!< Samples with RDA_SAMPLE_STEREO
+    uint8_t rdsBlocks;                      //!< RDS blocks in the window (2 per RDA_SAMPLE_RDS)
+    uint8_t rdsErrors;                      //!< RDS blocks with errors
+    uint32_t total;                         //!< Samples since the last reset
+    volatile uint8_t sequence;              //!< Odd while a push is updating the state
+} RDA_Monitor;
+
+/**
+ * @ingroup GA08
+ * @brief Empty the window, call while the producer is stopped
+ * @param monitor Monitor
+ */
+void RDA_MonitorInit(RDA_Monitor* monitor);
+
+/**
+ * @ingroup GA08
+ * @brief Add a sample, producer side
+ * @details A sample on another channel than the window empties it first, so the statistics
+ * @details never mix two stations.
+ * @param monitor Monitor
+ * @param channel READCHAN of the sample
+ * @param rssi RSSI of the sample
+ * @param flags RDA_SAMPLE_xxx
+ */
+void RDA_MonitorPush(RDA_Monitor* monitor, uint16_t channel, uint8_t rssi, uint8_t flags);
+
+/**
+ * @ingroup GA08
+ * @brief Get the statistics of the window, consumer side
+ * @param monitor Monitor
+ * @param stats Filled with the statistics
+ * @return 1 when the window holds samples, 0 when it is empty
+ */
+uint8_t RDA_MonitorGetStats(const RDA_Monitor* monitor, RDA_SignalStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_MONITOR_H */
@@ -0,0 +1,155 @@
+#include <RDA_Prof.h>
+
+#ifdef RDA_PROFILE
+
+#include <stdio.h>
+
+#define PROF_LINE 96            // Characters of a dump line
+#define PROF_OUTSIDE "(outside)" // Name of entry 0
+
+static RDA_ProfEntry table[RDA_PROF_SLOTS] = {{PROF_OUTSIDE}};
+// Entry of the API function the application is in, NULL outside
+static RDA_ProfEntry* current;
+
+/*
+ * Finds the entry of a function, takes a free one on its first call; the names are the
+ * __func__ arrays, so the pointer identifies the function
+ */
+static RDA_ProfEntry* profEntry(const char* name)
+{
+    uint8_t i;
+
+    for (i = 1; i < RDA_PROF_SLOTS; i++)
+    {
+        if (table[i].name == name)
+        {
+            return &table[i];
+        }
+        if (!table[i].name)
+        {
+            table[i].name = name;
+            return &table[i];
+        }
+    }
+    // Table full, costs outside any API function from here
+    return &table[0];
+}
+
+/*
+ * Entry charged with a cost
+ */
+static RDA_ProfEntry* profCharged(void)
+{
+    return current ? current : &table[0];
+}
+
+RDA_ProfScope RDA_ProfEnter(const char* name)
+{
+    RDA_ProfScope scope = {0, 0};
+
+    if (current)
+    {
+        return scope;
+    }
+    current = profEntry(name);
+    current->calls++;
+    scope.entry = current;
+#ifdef SYSTICK_DELAY
+    scope.start = getMicros();
+#endif
+    return scope;
+}
+
+void RDA_ProfLeave(RDA_ProfScope* scope)
+{
+    if (!scope->entry)
+    {
+        return;
+    }
+#ifdef SYSTICK_DELAY
+    scope->entry->ticks += getMicros() - scope->start;
+#endif
+    current = 0;
+}
+
+RDA_ProfScope RDA_ProfIrqEnter(void)
+{
+    RDA_ProfScope scope = {current, 0};
+
+    // The interrupted call must not be charged, entry 0 is until the interrupt returns
+    current = 0;
+    return scope;
+}
+
+void RDA_ProfIrqLeave(RDA_ProfScope* scope)
+{
+    current = scope->entry;
+}
+
+void RDA_ProfXfer(const RDA_Xfer* xfer)
+{
+    RDA_ProfEntry* entry = profCharged();
+
+    // Address byte and data; a read at a register address writes the address first
+    entry->transactions++;
+    entry->bytes += 1 + 2 * xfer->length;
+    if (xfer->reg != RDA_XFER_NO_REG)
+    {
+        entry->bytes += (xfer->direction == RDA_XFER_READ) ? 2 : 1;
+        entry->transactions += (xfer->direction == RDA_XFER_READ);
+    }
+}
+
+void RDA_ProfWait(void)
+{
+    profCharged()->waits++;
+}
+
+void RDA_ProfReset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < RDA_PROF_SLOTS; i++)
+    {
+        table[i] = (RDA_ProfEntry){0};
+    }
+    table[0].name = PROF_OUTSIDE;
+    current = 0;
+}
+
+const RDA_ProfEntry* RDA_ProfGet(uint8_t index)
+{
+    return (index < RDA_PROF_SLOTS && table[index].name) ? &table[index] : 0;
+}
+
+void RDA_ProfDump(RDA_ProfPrint print)
+{
+    RDA_ProfEntry total = {"total", 0, 0, 0, 0, 0};
+    const RDA_ProfEntry* entry;
+    char line[PROF_LINE];
+    uint8_t i;
+
+    print("function                  calls  transfers      bytes      waits        us");
+    for (i = 0; i <= RDA_PROF_SLOTS; i++)
+    {
+        entry = (i < RDA_PROF_SLOTS) ? RDA_ProfGet(i) : &total;
+        if (!entry || (i == 0 && !entry->transactions && !entry->waits))
+        {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%-22s %8lu %10lu %10lu %10lu %9lu", entry->name, (unsigned long)entry->calls,
+                 (unsigned long)entry->transactions, (unsigned long)entry->bytes, (unsigned long)entry->waits,
+                 (unsigned long)entry->ticks);
+        print(line);
+        if (i < RDA_PROF_SLOTS)
+        {
+            total.calls += entry->calls;
+            total.transactions += entry->transactions;
+            total.bytes += entry->bytes;
+            total.waits += entry->waits;
+            total.ticks += entry->ticks;
+        }
+    }
+}
+
+#endif
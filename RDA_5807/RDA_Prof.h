@@ -0,0 +1,109 @@
+#ifndef __RDA_PROF_H
+#define __RDA_PROF_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_HAL.h>
+
+/**
+ * @defgroup GA12 Bus instrumentation
+ * @brief Bus cost of every RDA_* call, compiled in with RDA_PROFILE
+ * @details Instrumented API functions open a scope with RDA_PROF_API; the transfers, bytes on the
+ * @details wire and wait-loop iterations counted while it is open go to that function, and so
+ * @details does the time until it returns. A call nested in another API function counts for the
+ * @details outer one, the function the application called. Calls made from an interrupt
+ * @details (RDA_CaptureRDS, RDA_MonitorTick) open RDA_PROF_IRQ instead: their costs go to entry 0,
+ * @details not to the call the interrupt landed in, which still counts the interrupt in its time.
+ * @details Wait loops are the settle and transfer completion waits of the driver, the STC polls
+ * @details of waitAndFinishTune and the flag waits of I2C_Start/I2C_WaitEvent on the STM32.
+ * @details Without RDA_PROFILE the hooks expand to nothing and RDA_Prof.c is empty, the build is
+ * @details the same as without instrumentation. The scope uses the GCC cleanup attribute.
+ */
+
+#define RDA_PROF_SLOTS      56      //!< Table entries, the first one collects costs outside any API function
+
+/**
+ * @ingroup GA12
+ * @brief Costs of one API function
+ */
+typedef struct
+{
+    const char* name;       //!< Function name, NULL for a free slot
+    uint32_t calls;         //!< Calls from the application
+    uint32_t transactions;  //!< Bus transactions (START to STOP), retries included
+    uint32_t bytes;         //!< Bytes on the wire, address bytes included
+    uint32_t waits;         //!< Wait-loop iterations
+    uint32_t ticks;         //!< Time inside the function, us (SysTick builds)
+} RDA_ProfEntry;
+
+/**
+ * @ingroup GA12
+ * @brief Line sink of RDA_ProfDump, e.g. a UART or puts
+ */
+typedef void (*RDA_ProfPrint)(const char* line);
+
+#ifdef RDA_PROFILE
+
+/**
+ * @ingroup GA12
+ * @brief Open scope of an instrumented call
+ */
+typedef struct
+{
+    RDA_ProfEntry* entry;   //!< Entry charged, NULL in a nested call; the interrupted one in an interrupt scope
+    uint32_t start;         //!< getMicros() at the call
+} RDA_ProfScope;
+
+RDA_ProfScope RDA_ProfEnter(const char* name);
+void RDA_ProfLeave(RDA_ProfScope* scope);
+RDA_ProfScope RDA_ProfIrqEnter(void);
+void RDA_ProfIrqLeave(RDA_ProfScope* scope);
+void RDA_ProfXfer(const RDA_Xfer* xfer);
+void RDA_ProfWait(void);
+
+// First statement of an instrumented function
+#define RDA_PROF_API()      RDA_ProfScope rdaProfScope __attribute__((cleanup(RDA_ProfLeave))) = RDA_ProfEnter(__func__)
+// First statement of an instrumented function called from an interrupt
+#define RDA_PROF_IRQ()      RDA_ProfScope rdaProfScope __attribute__((cleanup(RDA_ProfIrqLeave))) = RDA_ProfIrqEnter()
+// A transfer was started
+#define RDA_PROF_XFER(xfer) RDA_ProfXfer(xfer)
+// One iteration of a wait loop
+#define RDA_PROF_WAIT()     RDA_ProfWait()
+
+/**
+ * @ingroup GA12
+ * @brief Clear the table
+ */
+void RDA_ProfReset(void);
+
+/**
+ * @ingroup GA12
+ * @brief Get a table entry
+ * @param index 0 to RDA_PROF_SLOTS - 1, entry 0 collects costs outside any API function
+ * @return the entry, NULL for a free slot
+ */
+const RDA_ProfEntry* RDA_ProfGet(uint8_t index);
+
+/**
+ * @ingroup GA12
+ * @brief Print the table, one line per function that was called, and a total line
+ * @param print Line sink, lines come without line end
+ */
+void RDA_ProfDump(RDA_ProfPrint print);
+
+#else
+
+#define RDA_PROF_API()
+#define RDA_PROF_IRQ()
+#define RDA_PROF_XFER(xfer)
+#define RDA_PROF_WAIT()
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_PROF_H */
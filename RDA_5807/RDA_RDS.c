@@ -0,0 +1,524 @@
+#include <RDA_RDS.h>
+
+// Block B fields
+#define GROUP_TYPE(b)   ((b) >> 12)
+#define GROUP_B(b)      (((b) >> 11) & 1)
+#define GROUP_TP(b)     (((b) >> 10) & 1)
+#define GROUP_PTY(b)    (((b) >> 5) & 0x1F)
+#define GROUP_TA(b)     (((b) >> 4) & 1)      // 0A/0B
+#define GROUP_MS(b)     (((b) >> 3) & 1)      // 0A/0B
+#define GROUP_AB(b)     (((b) >> 4) & 1)      // 2A/2B
+
+#define RT_END          0x0D                  // Carriage return ends a shorter text
+
+// Text character votes, see rdsVote
+#define VOTE_MAX        3                     // Weight of a clean block, votes saturate there
+#define VOTE_VALID      3                     // Votes a character needs to count as received
+#define LEVEL_SKIP      0xFF                  // Block rejected by the acceptance policy
+
+// AF codes of block C, group 0A
+#define AF_FIRST        1                     // 87.6 MHz
+#define AF_LAST         204                   // 107.9 MHz
+#define AF_COUNT_BASE   224                   // 224 + n: a list of n AFs follows
+#define AF_COUNT_LAST   249
+#define AF_LFMF         250                   // The next code is an LF/MF frequency
+
+// Clock-Time, group 4A
+#define CT_MJD_MIN      51544                 // 2000-01-01, earlier dates are bit errors
+#define CT_OFFSET_MAX   24                    // 12 hours
+#define MJD_UNIX        40587                 // 1970-01-01
+
+#define RING_SLOT(index) ((index) & (RDA_RDS_RING_SIZE - 1))
+
+const RDA_RDSPolicy RDA_RDSPolicyDefault = {{1, 1, 2, 2}};
+
+// Keeps the compiler from moving slot accesses across the index update. Enough on a
+// single core Cortex-M3; the hardware does not reorder its own loads and stores.
+#define RING_BARRIER() __asm__ volatile ("" ::: "memory")
+
+/*
+ * Blanks the RadioText for a new message
+ */
+static void rdsClearText(RDA_RDS* rds, uint8_t versionB, uint8_t ab)
+{
+    uint8_t length = versionB ? RDA_RDS_RT_LENGTH / 2 : RDA_RDS_RT_LENGTH;
+    uint8_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        rds->rt[i] = ' ';
+        rds->rtVotes[i] = 0;
+    }
+    rds->rt[length] = 0;
+    rds->rtValid = 0;
+    rds->rtNeeded = RDA_RDS_RT_DONE;
+    rds->rtAB = ab;
+    rds->rtVersionB = versionB;
+}
+
+/*
+ * Votes for a text character received with an error level. A clean block replaces the
+ * character, corrected blocks add their weight to it when they agree and take it away
+ * when they do not, so a single miscorrected block cannot overwrite a confirmed character.
+ */
+static void rdsVote(char* chars, uint8_t* votes, char c, uint8_t level)
+{
+    uint8_t weight = (level == 0) ? VOTE_MAX : (level == 1) ? 2 : 1;
+
+    if (*votes && *chars == c)
+    {
+        *votes = (*votes + weight > VOTE_MAX) ? VOTE_MAX : *votes + weight;
+    }
+    else if (*votes > weight)
+    {
+        *votes -= weight;
+    }
+    else
+    {
+        *chars = c;
+        *votes = weight;
+    }
+}
+
+/*
+ * Group 0A/0B: two PS characters in block D
+ */
+static uint8_t rdsDecodePS(RDA_RDS* rds, uint16_t blockB, uint16_t blockD, uint8_t levelD)
+{
+    uint8_t segment = blockB & 0x03;
+    uint8_t bit = 1 << segment;
+    char* chars = &rds->ps[segment * 2];
+    uint8_t* votes = &rds->psVotes[segment * 2];
+    char first = chars[0];
+    char second = chars[1];
+    uint8_t result = 0;
+
+    if (rds->ta != GROUP_TA(blockB) || rds->ms != GROUP_MS(blockB))
+    {
+        rds->ta = GROUP_TA(blockB);
+        rds->ms = GROUP_MS(blockB);
+        result |= RDA_RDS_FLAGS_CHANGED;
+    }
+    if (levelD == LEVEL_SKIP)
+    {
+        return result;
+    }
+    rdsVote(&chars[0], &votes[0], (char)(blockD >> 8), levelD);
+    rdsVote(&chars[1], &votes[1], (char)blockD, levelD);
+    if ((rds->psValid & bit) && (chars[0] != first || chars[1] != second))
+    {
+        // The name changed under us, start collecting again
+        rds->psValid = 0;
+    }
+    if (rds->psValid != RDA_RDS_PS_DONE && votes[0] >= VOTE_VALID && votes[1] >= VOTE_VALID)
+    {
+        rds->psValid |= bit;
+        if (rds->psValid == RDA_RDS_PS_DONE)
+        {
+            result |= RDA_RDS_PS_READY;
+        }
+    }
+    return result;
+}
+
+/*
+ * Group 2A: four RT characters in blocks C and D, 2B: two in block D.
+ * The end of a shorter text is kept as NUL, so it votes like any other character.
+ */
+static uint8_t rdsDecodeRT(RDA_RDS* rds, uint16_t blockB, uint16_t blockC, uint16_t blockD, uint8_t levelC, uint8_t levelD)
+{
+    uint8_t versionB = GROUP_B(blockB);
+    uint8_t segment = blockB & 0x0F;
+    uint8_t complete = (rds->rtValid & rds->rtNeeded) == rds->rtNeeded;
+    uint8_t valid = 1;
+    uint8_t chars[4];
+    uint8_t levels[4] = {levelC, levelC, levelD, levelD};
+    uint8_t count;
+    uint8_t position;
+    uint8_t i;
+
+    if (GROUP_AB(blockB) != rds->rtAB || versionB != rds->rtVersionB)
+    {
+        rdsClearText(rds, versionB, GROUP_AB(blockB));
+        complete = 0;
+    }
+    if (versionB)
+    {
+        chars[0] = blockD >> 8;
+        chars[1] = blockD;
+        levels[0] = levelD;
+        levels[1] = levelD;
+        count = 2;
+    }
+    else
+    {
+        chars[0] = blockC >> 8;
+        chars[1] = blockC;
+        chars[2] = blockD >> 8;
+        chars[3] = blockD;
+        count = 4;
+    }
+
+    position = segment * count;
+    for (i = 0; i < count; i++)
+    {
+        if (levels[i] != LEVEL_SKIP)
+        {
+            rdsVote(&rds->rt[position + i], &rds->rtVotes[position + i], (chars[i] == RT_END) ? 0 : chars[i], levels[i]);
+        }
+        if (rds->rtVotes[position + i] < VOTE_VALID)
+        {
+            valid = 0;
+        }
+        else if (rds->rt[position + i] == 0)
+        {
+            rds->rtNeeded = (uint16_t)((2UL << segment) - 1);
+            break;
+        }
+    }
+    if (valid)
+    {
+        rds->rtValid |= 1 << segment;
+    }
+
+    if (!complete && (rds->rtValid & rds->rtNeeded) == rds->rtNeeded)
+    {
+        return RDA_RDS_RT_READY;
+    }
+    return 0;
+}
+
+/*
+ * Fills the date of the MJD, integer form of the conversion in annex G of the RDS standard
+ */
+static void rdsDate(RDA_RDSTime* time)
+{
+    uint32_t year = (time->mjd * 100 - 1507820) / 36525;
+    uint32_t days = time->mjd - year * 36525 / 100;
+    uint32_t month = (days * 10000 - 149561000) / 306001;
+    uint8_t k = (month == 14 || month == 15) ? 1 : 0;
+
+    time->day = days - 14956 - month * 306001 / 10000;
+    time->month = month - 1 - k * 12;
+    time->year = 1900 + year + k;
+}
+
+/*
+ * Group 4A: Clock-Time in blocks B, C and D, sent once a minute. A time is only taken when
+ * the CT group before it had the same offset and the previous minute, so a corrupted group
+ * needs a second, matching corruption to get through; a lost group delays the next time by a minute.
+ */
+static uint8_t rdsDecodeCT(RDA_RDS* rds, uint16_t blockB, uint16_t blockC, uint16_t blockD)
+{
+    RDA_RDSTime time;
+    uint32_t minutes;
+    uint8_t confirmed;
+
+    time.mjd = ((uint32_t)(blockB & 0x03) << 15) | (blockC >> 1);
+    time.hour = ((blockC & 1) << 4) | (blockD >> 12);
+    time.minute = (blockD >> 6) & 0x3F;
+    time.offset = blockD & 0x1F;
+    if (blockD & 0x20)
+    {
+        time.offset = -time.offset;
+    }
+    if (time.mjd < CT_MJD_MIN || time.hour > 23 || time.minute > 59 || time.offset > CT_OFFSET_MAX ||
+        time.offset < -CT_OFFSET_MAX)
+    {
+        return 0;
+    }
+
+    minutes = time.mjd * 1440 + time.hour * 60 + time.minute;
+    confirmed = rds->timeCandidateValid && rds->timeCandidateOffset == time.offset &&
+                minutes == rds->timeCandidate + 1;
+    rds->timeCandidate = minutes;
+    rds->timeCandidateOffset = time.offset;
+    rds->timeCandidateValid = 1;
+    if (!confirmed)
+    {
+        return 0;
+    }
+    rdsDate(&time);
+    rds->time = time;
+    rds->timeValid = 1;
+    return RDA_RDS_CT_READY;
+}
+
+/*
+ * Adds an AF code to a list unless it is already there
+ */
+static uint8_t afAdd(RDA_AFList* list, uint8_t code)
+{
+    uint8_t i;
+
+    for (i = 0; i < list->count; i++)
+    {
+        if (list->codes[i] == code)
+        {
+            return 0;
+        }
+    }
+    if (list->count >= RDA_AF_MAX || (list->expected && list->count >= list->expected))
+    {
+        return 0;
+    }
+    list->codes[list->count++] = code;
+    return 1;
+}
+
+/*
+ * Finds the list of a program, or takes the oldest one for it
+ */
+static RDA_AFList* afList(RDA_AFTable* table, uint16_t pi)
+{
+    RDA_AFList* oldest = &table->lists[0];
+    uint8_t i;
+
+    for (i = 0; i < RDA_AF_PROGRAMS; i++)
+    {
+        if (table->lists[i].pi == pi)
+        {
+            return &table->lists[i];
+        }
+        if (table->lists[i].used < oldest->used)
+        {
+            oldest = &table->lists[i];
+        }
+    }
+    oldest->pi = pi;
+    oldest->expected = 0;
+    oldest->count = 0;
+    return oldest;
+}
+
+/*
+ * Decodes a group whose blocks passed the policy, LEVEL_SKIP marks the blocks that did not
+ */
+static uint8_t rdsDecode(RDA_RDS* rds, const uint16_t* blocks, const uint8_t* levels)
+{
+    uint16_t blockB = blocks[1];
+    uint8_t result = 0;
+
+    if (levels[1] == LEVEL_SKIP)
+    {
+        // Without block B the group type is unknown
+        rds->rejected++;
+        return 0;
+    }
+    rds->groups++;
+    if (levels[0] != LEVEL_SKIP && blocks[0] != rds->pi)
+    {
+        rds->pi = blocks[0];
+        result |= RDA_RDS_PI_CHANGED;
+    }
+    if (GROUP_PTY(blockB) != rds->pty)
+    {
+        rds->pty = GROUP_PTY(blockB);
+        result |= RDA_RDS_PTY_CHANGED;
+    }
+    if (GROUP_TP(blockB) != rds->tp)
+    {
+        rds->tp = GROUP_TP(blockB);
+        result |= RDA_RDS_FLAGS_CHANGED;
+    }
+
+    switch (GROUP_TYPE(blockB))
+    {
+        case 0:
+            result |= rdsDecodePS(rds, blockB, blocks[3], levels[3]);
+            break;
+        case 2:
+            result |= rdsDecodeRT(rds, blockB, blocks[2], blocks[3], levels[2], levels[3]);
+            break;
+        case 4:
+            if (!GROUP_B(blockB) && levels[2] != LEVEL_SKIP && levels[3] != LEVEL_SKIP)
+            {
+                result |= rdsDecodeCT(rds, blockB, blocks[2], blocks[3]);
+            }
+            break;
+        default:
+            break;
+    }
+    return result;
+}
+
+void RDA_RDSInit(RDA_RDS* rds)
+{
+    uint8_t i;
+
+    rds->pi = 0;
+    rds->pty = 0;
+    rds->tp = 0;
+    rds->ta = 0;
+    rds->ms = 0;
+    for (i = 0; i < RDA_RDS_PS_LENGTH; i++)
+    {
+        rds->ps[i] = ' ';
+        rds->psVotes[i] = 0;
+    }
+    rds->ps[RDA_RDS_PS_LENGTH] = 0;
+    rds->psValid = 0;
+    rdsClearText(rds, 0, 0);
+    rds->timeValid = 0;
+    rds->timeCandidateValid = 0;
+    rds->groups = 0;
+    rds->rejected = 0;
+}
+
+uint8_t RDA_RDSDecode(RDA_RDS* rds, const uint16_t* blocks)
+{
+    static const uint8_t clean[4] = {0, 0, 0, 0};
+
+    return rdsDecode(rds, blocks, clean);
+}
+
+uint8_t RDA_RDSDecodeGroup(RDA_RDS* rds, const RDA_RDSGroup* group, const RDA_RDSPolicy* policy)
+{
+    // REG0B has no levels of its own for blocks C and D, they are judged by BLERB
+    uint8_t levels[4] = {group->blera, group->blerb, group->blerb, group->blerb};
+    uint8_t i;
+
+    for (i = 0; i < 4; i++)
+    {
+        if (levels[i] > policy->maxLevel[i])
+        {
+            levels[i] = LEVEL_SKIP;
+        }
+    }
+    return rdsDecode(rds, group->blocks, levels);
+}
+
+uint32_t RDA_RDSTimeToUnix(const RDA_RDSTime* time)
+{
+    return (time->mjd - MJD_UNIX) * 86400 + (uint32_t)time->hour * 3600 + (uint32_t)time->minute * 60;
+}
+
+void RDA_AFTableInit(RDA_AFTable* table)
+{
+    uint8_t i;
+
+    for (i = 0; i < RDA_AF_PROGRAMS; i++)
+    {
+        table->lists[i].pi = 0;
+        table->lists[i].expected = 0;
+        table->lists[i].count = 0;
+        table->lists[i].used = 0;
+    }
+    table->clock = 0;
+}
+
+uint8_t RDA_AFDecode(RDA_AFTable* table, const uint16_t* blocks)
+{
+    uint8_t codes[2] = {blocks[2] >> 8, blocks[2]};
+    uint8_t complete;
+    uint8_t added = 0;
+    RDA_AFList* list;
+    uint8_t i;
+
+    if (GROUP_TYPE(blocks[1]) != 0 || GROUP_B(blocks[1]) || !blocks[0])
+    {
+        return 0;
+    }
+    list = afList(table, blocks[0]);
+    list->used = ++table->clock;
+    complete = RDA_AFComplete(list);
+
+    for (i = 0; i < 2; i++)
+    {
+        if (codes[i] >= AF_COUNT_BASE && codes[i] <= AF_COUNT_LAST)
+        {
+            if (list->expected != codes[i] - AF_COUNT_BASE)
+            {
+                // Another list, start collecting again
+                list->expected = codes[i] - AF_COUNT_BASE;
+                list->count = 0;
+                complete = 0;
+            }
+        }
+        else if (codes[i] >= AF_FIRST && codes[i] <= AF_LAST)
+        {
+            added |= afAdd(list, codes[i]);
+        }
+        else if (codes[i] == AF_LFMF)
+        {
+            break;
+        }
+    }
+
+    if (!complete && RDA_AFComplete(list))
+    {
+        return RDA_RDS_AF_READY | (added ? RDA_RDS_AF_CHANGED : 0);
+    }
+    return added ? RDA_RDS_AF_CHANGED : 0;
+}
+
+const RDA_AFList* RDA_AFFind(const RDA_AFTable* table, uint16_t pi)
+{
+    uint8_t i;
+
+    for (i = 0; i < RDA_AF_PROGRAMS; i++)
+    {
+        if (pi && table->lists[i].pi == pi)
+        {
+            return &table->lists[i];
+        }
+    }
+    return 0;
+}
+
+uint8_t RDA_AFComplete(const RDA_AFList* list)
+{
+    return list->expected && list->count == list->expected;
+}
+
+uint8_t RDA_RDSHasPS(const RDA_RDS* rds)
+{
+    return rds->psValid == RDA_RDS_PS_DONE;
+}
+
+uint8_t RDA_RDSHasRT(const RDA_RDS* rds)
+{
+    return rds->rtValid && (rds->rtValid & rds->rtNeeded) == rds->rtNeeded;
+}
+
+void RDA_RDSRingInit(RDA_RDSRing* ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+}
+
+uint8_t RDA_RDSRingPush(RDA_RDSRing* ring, const RDA_RDSGroup* group)
+{
+    uint8_t head = ring->head;
+
+    if ((uint8_t)(head - ring->tail) >= RDA_RDS_RING_SIZE)
+    {
+        ring->dropped++;
+        return 0;
+    }
+    ring->groups[RING_SLOT(head)] = *group;
+    RING_BARRIER();
+    ring->head = head + 1;
+    return 1;
+}
+
+uint8_t RDA_RDSRingPop(RDA_RDSRing* ring, RDA_RDSGroup* group)
+{
+    uint8_t tail = ring->tail;
+
+    if (tail == ring->head)
+    {
+        return 0;
+    }
+    RING_BARRIER();
+    *group = ring->groups[RING_SLOT(tail)];
+    RING_BARRIER();
+    ring->tail = tail + 1;
+    return 1;
+}
+
+uint8_t RDA_RDSRingCount(const RDA_RDSRing* ring)
+{
+    return (uint8_t)(ring->head - ring->tail);
+}
@@ -0,0 +1,289 @@
+#ifndef __RDA_RDS_H
+#define __RDA_RDS_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @defgroup GA07 RDS decoder
+ * @brief Incremental decoder for the groups read from REG0C-REG0F
+ * @details Groups 0A/0B give the Program Service name, TA/TP and PTY, groups 2A/2B the RadioText.
+ * @details Group 4A gives the Clock-Time, accepted once two consecutive groups a minute apart agree.
+ * @details The Alternative Frequency lists of group 0A are kept per program in a separate table,
+ * @details so they survive the decoder reset of a retune.
+ * @details Characters are written straight into the visible strings; a bitmap per segment tells
+ * @details which parts are valid, so partial names build up without a second buffer.
+ * @details Captured groups carry the REG0B error levels: an acceptance policy drops the blocks
+ * @details that are too damaged, and the PS/RT characters of corrected blocks are voted on across
+ * @details repeated groups, so a weak signal still converges on the right text.
+ * @details Only depends on stdint, the same code runs on the target and on Linux.
+ */
+
+#define RDA_RDS_PS_LENGTH   8       //!< Program Service name characters
+#define RDA_RDS_RT_LENGTH   64      //!< RadioText characters (2A, 2B carries 32)
+
+#define RDA_RDS_RING_SIZE   16      //!< Groups the capture ring holds (power of two), about 1.4 s of RDS
+
+#define RDA_AF_MAX          25      //!< AFs of a method A list
+#define RDA_AF_PROGRAMS     4       //!< Programs (PI codes) an AF table keeps lists for
+#define RDA_AF_FREQUENCY(code) (87500UL + (uint32_t)(code) * 100)   //!< AF code 1-204 to kHz
+
+#define RDA_RDS_PS_DONE     0x0F    //!< All 4 PS segments received
+#define RDA_RDS_RT_DONE     0xFFFF  //!< All 16 RT segments received
+
+// RDA_RDSDecode result flags
+#define RDA_RDS_PI_CHANGED  0x01    //!< New program identification
+#define RDA_RDS_PTY_CHANGED 0x02    //!< New program type
+#define RDA_RDS_FLAGS_CHANGED 0x04  //!< TA, TP or MS changed
+#define RDA_RDS_PS_READY    0x08    //!< PS completed with this group
+#define RDA_RDS_RT_READY    0x10    //!< RT completed with this group
+#define RDA_RDS_AF_CHANGED  0x20    //!< RDA_AFDecode: an AF was added to the list
+#define RDA_RDS_AF_READY    0x40    //!< RDA_AFDecode: the list completed with this group
+#define RDA_RDS_CT_READY    0x80    //!< A new Clock-Time was accepted with this group
+
+/**
+ * @ingroup GA07
+ * @brief Clock-Time of group 4A
+ * @details The time is UTC; local time is UTC plus offset half hours. The group is sent at the
+ * @details start of the minute.
+ */
+typedef struct
+{
+    uint32_t mjd;           //!< Modified Julian Day
+    uint16_t year;          //!< Date of the MJD
+    uint8_t month;          //!< 1-12
+    uint8_t day;            //!< 1-31
+    uint8_t hour;           //!< UTC hour, 0-23
+    uint8_t minute;         //!< UTC minute, 0-59
+    int8_t offset;          //!< Local time offset in half hours, -24 to 24
+} RDA_RDSTime;
+
+/**
+ * @ingroup GA07
+ * @brief RDS decoder state
+ */
+typedef struct
+{
+    uint16_t pi;                            //!< Program identification
+    uint8_t pty;                            //!< Program type
+    uint8_t tp;                             //!< Traffic program
+    uint8_t ta;                             //!< Traffic announcement
+    uint8_t ms;                             //!< Music (1) / speech (0)
+    char ps[RDA_RDS_PS_LENGTH + 1];         //!< Program Service name, NUL terminated
+    uint8_t psValid;                        //!< Received PS segments, bit n = characters 2n and 2n+1
+    char rt[RDA_RDS_RT_LENGTH + 1];         //!< RadioText, NUL terminated
+    uint16_t rtValid;                       //!< Received RT segments
+    uint16_t rtNeeded;                      //!< Segments up to the end of the text
+    uint8_t rtAB;                           //!< Text A/B flag, a toggle clears the text
+    uint8_t rtVersionB;                     //!< Text comes from 2B groups (2 characters per segment)
+    uint8_t psVotes[RDA_RDS_PS_LENGTH];     //!< Votes for the PS characters
+    uint8_t rtVotes[RDA_RDS_RT_LENGTH];     //!< Votes for the RT characters
+    RDA_RDSTime time;                       //!< Last accepted Clock-Time
+    uint8_t timeValid;                      //!< time holds an accepted Clock-Time
+    uint32_t timeCandidate;                 //!< Minutes since MJD 0 of the last plausible CT group
+    int8_t timeCandidateOffset;             //!< Offset of that group
+    uint8_t timeCandidateValid;             //!< A CT group waits for its confirmation
+    uint32_t groups;                        //!< Groups decoded
+    uint32_t rejected;                      //!< Groups dropped by the acceptance policy
+} RDA_RDS;
+
+/**
+ * @ingroup GA07
+ * @brief Block acceptance policy
+ * @details Highest error level taken from each block: 0 = no errors, 1 = 1-2 corrected errors,
+ * @details 2 = 3-5 corrected errors, 3 = uncorrectable. REG0B only reports blocks A (BLERA) and B
+ * @details (BLERB), blocks C and D are judged by BLERB. A group whose block B is rejected is
+ * @details dropped; a rejected block A keeps the PI, rejected blocks C/D keep their characters.
+ */
+typedef struct
+{
+    uint8_t maxLevel[4];                    //!< Blocks A, B, C and D
+} RDA_RDSPolicy;
+
+/**
+ * @ingroup GA07
+ * @brief Default policy: PI and group type from blocks with at most 1-2 errors, text characters
+ * @brief from blocks with up to 5 corrected errors (they are voted on)
+ */
+extern const RDA_RDSPolicy RDA_RDSPolicyDefault;
+
+/**
+ * @ingroup GA07
+ * @brief Alternative Frequency list of one program (method A)
+ */
+typedef struct
+{
+    uint16_t pi;                    //!< Program identification, 0 = unused entry
+    uint8_t expected;               //!< AFs announced by the list header, 0 until it was received
+    uint8_t count;                  //!< AFs received
+    uint8_t codes[RDA_AF_MAX];      //!< AF codes 1-204, see RDA_AF_FREQUENCY
+    uint32_t used;                  //!< Table clock of the last update, the oldest list is replaced
+} RDA_AFList;
+
+/**
+ * @ingroup GA07
+ * @brief AF lists of the last RDA_AF_PROGRAMS programs received
+ */
+typedef struct
+{
+    RDA_AFList lists[RDA_AF_PROGRAMS];
+    uint32_t clock;                 //!< Updates so far
+} RDA_AFTable;
+
+/**
+ * @ingroup GA07
+ * @brief A captured RDS group
+ */
+typedef struct
+{
+    uint16_t blocks[4];     //!< Blocks A, B, C and D
+    uint8_t blera;          //!< Block A error level (REG0B BLERA)
+    uint8_t blerb;          //!< Block B error level (REG0B BLERB)
+    uint32_t timestamp;     //!< getMillis() at capture
+} RDA_RDSGroup;
+
+/**
+ * @ingroup GA07
+ * @brief Single producer / single consumer ring of captured groups
+ * @details The producer (interrupt or timer context) only writes head, the consumer (application)
+ * @details only writes tail, so neither side needs to mask interrupts. A full ring drops the new group.
+ */
+typedef struct
+{
+    RDA_RDSGroup groups[RDA_RDS_RING_SIZE];
+    volatile uint8_t head;      //!< Next free slot, written by the producer
+    volatile uint8_t tail;      //!< Oldest group, written by the consumer
+    volatile uint32_t dropped;  //!< Groups lost because the ring was full
+} RDA_RDSRing;
+
+/**
+ * @ingroup GA07
+ * @brief Clear the decoder, call after every tune or seek
+ * @param rds Decoder
+ */
+void RDA_RDSInit(RDA_RDS* rds);
+
+/**
+ * @ingroup GA07
+ * @brief Decode one group
+ * @details The blocks are taken as error free.
+ * @param rds Decoder
+ * @param blocks blocks A, B, C and D
+ * @return RDA_RDS_xxx flags of what changed
+ */
+uint8_t RDA_RDSDecode(RDA_RDS* rds, const uint16_t* blocks);
+
+/**
+ * @ingroup GA07
+ * @brief Decode one captured group with its error levels
+ * @details Blocks above the policy levels are ignored. A PS or RT character from a clean block
+ * @details is taken as is; one from a corrected block has to be confirmed by another group
+ * @details (1-2 errors) or two (3-5 errors) before its segment counts as received.
+ * @param rds Decoder
+ * @param group Blocks and BLERA/BLERB levels
+ * @param policy Acceptance policy, e.g. &RDA_RDSPolicyDefault
+ * @return RDA_RDS_xxx flags of what changed
+ */
+uint8_t RDA_RDSDecodeGroup(RDA_RDS* rds, const RDA_RDSGroup* group, const RDA_RDSPolicy* policy);
+
+/**
+ * @ingroup GA07
+ * @brief Check whether all PS segments were received
+ * @param rds Decoder
+ * @return 1 when complete
+ */
+uint8_t RDA_RDSHasPS(const RDA_RDS* rds);
+
+/**
+ * @ingroup GA07
+ * @brief Check whether all RT segments up to the end of the text were received
+ * @param rds Decoder
+ * @return 1 when complete
+ */
+uint8_t RDA_RDSHasRT(const RDA_RDS* rds);
+
+/**
+ * @ingroup GA07
+ * @brief Convert a Clock-Time to seconds since 1970-01-01 UTC
+ * @param time Clock-Time
+ * @return uint32_t
+ */
+uint32_t RDA_RDSTimeToUnix(const RDA_RDSTime* time);
+
+/**
+ * @ingroup GA07
+ * @brief Forget all AF lists
+ * @param table AF table
+ */
+void RDA_AFTableInit(RDA_AFTable* table);
+
+/**
+ * @ingroup GA07
+ * @brief Add the AFs of a group 0A to the list of its program
+ * @details Block C carries two codes: a list header (224 + number of AFs) or AFs (1-204);
+ * @details fillers and LF/MF frequencies are skipped. A header with another count restarts the list.
+ * @details Other groups are ignored, so every group can be passed.
+ * @param table AF table
+ * @param blocks blocks A, B, C and D
+ * @return RDA_RDS_AF_CHANGED and RDA_RDS_AF_READY flags
+ */
+uint8_t RDA_AFDecode(RDA_AFTable* table, const uint16_t* blocks);
+
+/**
+ * @ingroup GA07
+ * @brief Get the AF list of a program
+ * @param table AF table
+ * @param pi Program identification
+ * @return the list, NULL when no group 0A of the program was received
+ */
+const RDA_AFList* RDA_AFFind(const RDA_AFTable* table, uint16_t pi);
+
+/**
+ * @ingroup GA07
+ * @brief Check whether all AFs announced by the list header were received
+ * @param list AF list
+ * @return 1 when complete
+ */
+uint8_t RDA_AFComplete(const RDA_AFList* list);
+
+/**
+ * @ingroup GA07
+ * @brief Empty a ring, call while the producer is stopped
+ * @param ring Ring
+ */
+void RDA_RDSRingInit(RDA_RDSRing* ring);
+
+/**
+ * @ingroup GA07
+ * @brief Add a group, producer side
+ * @param ring Ring
+ * @param group Group to copy in
+ * @return 1 when stored, 0 when the ring was full and the group was dropped
+ */
+uint8_t RDA_RDSRingPush(RDA_RDSRing* ring, const RDA_RDSGroup* group);
+
+/**
+ * @ingroup GA07
+ * @brief Take the oldest group, consumer side
+ * @param ring Ring
+ * @param group Filled with the group
+ * @return 1 when a group was taken, 0 when the ring is empty
+ */
+uint8_t RDA_RDSRingPop(RDA_RDSRing* ring, RDA_RDSGroup* group);
+
+/**
+ * @ingroup GA07
+ * @brief Get the number of groups waiting in a ring
+ * @param ring Ring
+ * @return uint8_t
+ */
+uint8_t RDA_RDSRingCount(const RDA_RDSRing* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_RDS_H */
@@ -0,0 +1,168 @@
+#include <RDA_Sched.h>
+
+#ifdef SYSTICK_DELAY
+
+// Task lists by priority
+static RDA_Task* tasks[RDA_TASK_PRIORITIES];
+// Task each priority starts looking at next, the one after the last that ran
+static RDA_Task* resume[RDA_TASK_PRIORITIES];
+static uint32_t startMicros;
+static uint32_t idleMicros;
+static uint32_t timerMicros;
+
+/*
+ * Timer callback of delayed and periodic posts
+ */
+static void taskTimer(RDA_Timer* timer)
+{
+    RDA_Task* task = timer->context;
+    uint32_t late;
+
+    if (task->period)
+    {
+        // Keep to the period grid when the callback ran late
+        late = getMillis() - timer->deadline;
+        RDA_TimerStart(timer, (late < task->period) ? task->period - late : 0, taskTimer, task);
+    }
+    task->posted = 1;
+}
+
+/*
+ * Finds the next posted task: highest priority first, round robin within a priority
+ */
+static RDA_Task* schedNext(void)
+{
+    RDA_Task* first;
+    RDA_Task* task;
+    uint8_t priority;
+
+    for (priority = 0; priority < RDA_TASK_PRIORITIES; priority++)
+    {
+        first = resume[priority] ? resume[priority] : tasks[priority];
+        task = first;
+        while (task)
+        {
+            if (task->posted)
+            {
+                resume[priority] = task->next;
+                return task;
+            }
+            task = task->next ? task->next : tasks[priority];
+            if (task == first)
+            {
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+void RDA_SchedInit(void)
+{
+    RDA_Task* task;
+    uint8_t priority;
+
+    for (priority = 0; priority < RDA_TASK_PRIORITIES; priority++)
+    {
+        for (task = tasks[priority]; task; task = task->next)
+        {
+            RDA_TimerStop(&task->timer);
+        }
+        tasks[priority] = 0;
+        resume[priority] = 0;
+    }
+    startMicros = getMicros();
+    idleMicros = 0;
+    timerMicros = 0;
+}
+
+void RDA_TaskAdd(RDA_Task* task, const char* name, uint8_t priority, RDA_TaskFunction run, void* context)
+{
+    RDA_Task** link;
+
+    priority = (priority < RDA_TASK_PRIORITIES) ? priority : RDA_PRIORITY_LOW;
+    task->next = 0;
+    task->run = run;
+    task->context = context;
+    task->name = name;
+    task->priority = priority;
+    task->posted = 0;
+    task->period = 0;
+    task->timer.armed = 0;
+    task->runs = 0;
+    task->runMicros = 0;
+    task->maxMicros = 0;
+    // Behind the tasks added before, they take turns in that order
+    for (link = &tasks[priority]; *link; link = &(*link)->next);
+    *link = task;
+}
+
+void RDA_TaskPost(RDA_Task* task)
+{
+    task->posted = 1;
+}
+
+void RDA_TaskPostIn(RDA_Task* task, uint32_t delay)
+{
+    RDA_TimerStart(&task->timer, delay, taskTimer, task);
+}
+
+void RDA_TaskSetPeriod(RDA_Task* task, uint16_t period)
+{
+    task->period = period;
+    if (period)
+    {
+        RDA_TimerStart(&task->timer, period, taskTimer, task);
+    }
+    else
+    {
+        RDA_TimerStop(&task->timer);
+    }
+}
+
+uint8_t RDA_SchedStep(void)
+{
+    uint32_t start = getMicros();
+    uint32_t time;
+    RDA_Task* task;
+
+    if (RDA_TimerRun())
+    {
+        time = getMicros();
+        timerMicros += time - start;
+        start = time;
+    }
+    task = schedNext();
+    if (!task)
+    {
+        // A post from an interrupt right before the sleep waits for the next tick at most
+        RDA_HAL_Idle();
+        idleMicros += getMicros() - start;
+        return 0;
+    }
+    // Cleared first, so a post while the task runs runs it again
+    task->posted = 0;
+    task->run(task);
+    time = getMicros() - start;
+    task->runs++;
+    task->runMicros += time;
+    task->maxMicros = (time > task->maxMicros) ? time : task->maxMicros;
+    return 1;
+}
+
+void RDA_SchedRun(void)
+{
+    while (1)
+    {
+        RDA_SchedStep();
+    }
+}
+
+void RDA_SchedGetStats(RDA_SchedStats* stats)
+{
+    stats->elapsed = getMicros() - startMicros;
+    stats->idle = idleMicros;
+    stats->timers = timerMicros;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef __RDA_SCHED_H
+#define __RDA_SCHED_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_Timer.h>
+
+/**
+ * @defgroup GA10 Task scheduler
+ * @brief Cooperative run-to-completion tasks on top of the timer service
+ * @details Each priority has its own task list; the highest priority with a posted task runs
+ * @details first, tasks of one priority take turns. A task runs until it returns, so it must not
+ * @details wait: long work posts itself again or arms a timer for the rest.
+ * @details Posting only sets a flag, so interrupts may post. Delayed and periodic posts use the
+ * @details task's own RDA_Timer. When nothing is posted the scheduler sleeps in RDA_HAL_Idle.
+ * @details Every task keeps its run count and run time on the microsecond timebase, the
+ * @details scheduler the time spent in timer callbacks and asleep. On the Linux HAL the clock is
+ * @details virtual, so a host run schedules the same way every time.
+ */
+
+#define RDA_TASK_PRIORITIES     3   //!< Number of priorities
+
+#define RDA_PRIORITY_HIGH       0   //!< Completions that others wait on
+#define RDA_PRIORITY_NORMAL     1   //!< Periodic driver work
+#define RDA_PRIORITY_LOW        2   //!< User interface and background jobs
+
+struct RDA_Task;
+
+/**
+ * @ingroup GA10
+ * @brief Task function, runs to completion
+ */
+typedef void (*RDA_TaskFunction)(struct RDA_Task* task);
+
+/**
+ * @ingroup GA10
+ * @brief Task, allocated by the application; must stay valid once added
+ */
+typedef struct RDA_Task
+{
+    struct RDA_Task* next;      //!< Next task of the same priority
+    RDA_TaskFunction run;       //!< Called once per post
+    void* context;              //!< User data for the task function
+    const char* name;           //!< Name for reports
+    uint8_t priority;           //!< RDA_PRIORITY_xxx
+    volatile uint8_t posted;    //!< Set by a post, cleared when the task starts
+    uint16_t period;            //!< ms between periodic posts, 0 when not periodic
+    RDA_Timer timer;            //!< Delayed and periodic posts
+    uint32_t runs;              //!< Times the task ran
+    uint32_t runMicros;         //!< Run time, us
+    uint32_t maxMicros;         //!< Longest run, us
+} RDA_Task;
+
+/**
+ * @ingroup GA10
+ * @brief Time accounting of the scheduler, us since RDA_SchedInit
+ * @details elapsed minus idle, timers and the run time of the tasks is the scheduler overhead.
+ */
+typedef struct
+{
+    uint32_t elapsed;           //!< Time since RDA_SchedInit
+    uint32_t idle;              //!< Asleep with nothing posted
+    uint32_t timers;            //!< In timer callbacks (RDA_TimerRun)
+} RDA_SchedStats;
+
+#ifdef SYSTICK_DELAY
+
+/**
+ * @ingroup GA10
+ * @brief Remove all tasks, stop their timers and reset the accounting
+ */
+void RDA_SchedInit(void);
+
+/**
+ * @ingroup GA10
+ * @brief Add a task to the scheduler, once per task
+ * @param task Task
+ * @param name Name for reports
+ * @param priority RDA_PRIORITY_xxx
+ * @param run Task function
+ * @param context User data for the task function
+ */
+void RDA_TaskAdd(RDA_Task* task, const char* name, uint8_t priority, RDA_TaskFunction run, void* context);
+
+/**
+ * @ingroup GA10
+ * @brief Post a task, also from an interrupt
+ * @details Posts while the task is already posted are merged, the task runs once.
+ * @param task Task
+ */
+void RDA_TaskPost(RDA_Task* task);
+
+/**
+ * @ingroup GA10
+ * @brief Post a task after a delay, a periodic task continues its period from there
+ * @param task Task
+ * @param delay ms
+ */
+void RDA_TaskPostIn(RDA_Task* task, uint32_t delay);
+
+/**
+ * @ingroup GA10
+ * @brief Post a task every period ms, first after one period
+ * @details A late post does not shift the following ones.
+ * @param task Task
+ * @param period ms, 0 stops the periodic posts
+ */
+void RDA_TaskSetPeriod(RDA_Task* task, uint16_t period);
+
+/**
+ * @ingroup GA10
+ * @brief Run the due timers and then the next posted task, sleep when nothing is posted
+ * @return 1 when a task ran
+ */
+uint8_t RDA_SchedStep(void);
+
+/**
+ * @ingroup GA10
+ * @brief Run the scheduler forever, the main loop of the application
+ */
+void RDA_SchedRun(void);
+
+/**
+ * @ingroup GA10
+ * @brief Get the time accounting of the scheduler
+ * @param stats Filled with the times
+ */
+void RDA_SchedGetStats(RDA_SchedStats* stats);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_SCHED_H */
@@ -0,0 +1,329 @@
+#include <RDA_Store.h>
+
+#define STORE_MAGIC         0x5253  // "RS", written last into a page header
+#define STORE_VERSION       1       // Record layout
+#define HEADER_WORDS        4       // Magic, version, generation low/high
+#define RECORD_WORDS        10      // Tag, frequency (2), band/space, volume/flags, PS (4), CRC
+#define HEADER_BYTES        (HEADER_WORDS * 2)
+#define RECORD_BYTES        RDA_STORE_RECORD
+#define ERASED              0xFFFF
+
+// Record tags: 0xA5 marker, type and preset slot
+#define TAG_STATE           0xA510
+#define TAG_PRESET(slot)    (0xA520 | (slot))
+#define TAG_IS_PRESET(tag)  (((tag) & 0xFFF0) == 0xA520 && ((tag) & 0x000F) < RDA_STORE_PRESETS)
+
+/*
+ * First address of a page of the store
+ */
+static uint32_t storePage(const RDA_Store* store, uint8_t page)
+{
+    return store->base + (uint32_t)page * RDA_FLASH_PAGE_SIZE;
+}
+
+/*
+ * CRC-16/CCITT of record words, low byte first
+ */
+static uint16_t storeCrc(const uint16_t* words, uint8_t count)
+{
+    uint16_t crc = 0xFFFF;
+    uint8_t byte;
+    uint8_t bit;
+
+    for (byte = 0; byte < count * 2; byte++)
+    {
+        crc ^= (uint16_t)((words[byte / 2] >> ((byte & 1) * 8)) & 0xFF) << 8;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/*
+ * Empties an entry
+ */
+static void entryClear(RDA_StoreEntry* entry)
+{
+    uint8_t i;
+
+    entry->frequency = 0;
+    entry->band = 0;
+    entry->space = 0;
+    entry->volume = 0;
+    entry->flags = 0;
+    for (i = 0; i <= RDA_STORE_PS; i++)
+    {
+        entry->ps[i] = 0;
+    }
+}
+
+/*
+ * Copies an entry, the PS name is cut to RDA_STORE_PS characters and padded with NULs
+ */
+static void entryCopy(RDA_StoreEntry* to, const RDA_StoreEntry* from)
+{
+    uint8_t end = 0;
+    uint8_t i;
+
+    to->frequency = from->frequency;
+    to->band = from->band;
+    to->space = from->space;
+    to->volume = from->volume;
+    to->flags = from->flags;
+    for (i = 0; i < RDA_STORE_PS; i++)
+    {
+        end |= (from->ps[i] == 0);
+        to->ps[i] = end ? 0 : from->ps[i];
+    }
+    to->ps[RDA_STORE_PS] = 0;
+}
+
+/*
+ * Compares a stored entry with a new one
+ */
+static uint8_t entryEqual(const RDA_StoreEntry* stored, const RDA_StoreEntry* entry)
+{
+    RDA_StoreEntry copy;
+    uint8_t i;
+
+    entryCopy(&copy, entry);
+    if (stored->frequency != copy.frequency || stored->band != copy.band || stored->space != copy.space ||
+        stored->volume != copy.volume || stored->flags != copy.flags)
+    {
+        return 0;
+    }
+    for (i = 0; i < RDA_STORE_PS; i++)
+    {
+        if (stored->ps[i] != copy.ps[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Programs a record: tag first and CRC last, so a cut record never looks valid
+ */
+static uint8_t storeProgram(uint32_t address, uint16_t tag, const RDA_StoreEntry* entry)
+{
+    uint16_t words[RECORD_WORDS];
+    uint8_t i;
+
+    words[0] = tag;
+    words[1] = entry->frequency & 0xFFFF;
+    words[2] = entry->frequency >> 16;
+    words[3] = entry->band | ((uint16_t)entry->space << 8);
+    words[4] = entry->volume | ((uint16_t)entry->flags << 8);
+    for (i = 0; i < RDA_STORE_PS / 2; i++)
+    {
+        words[5 + i] = (uint8_t)entry->ps[2 * i] | ((uint16_t)(uint8_t)entry->ps[2 * i + 1] << 8);
+    }
+    words[RECORD_WORDS - 1] = storeCrc(words, RECORD_WORDS - 1);
+    for (i = 0; i < RECORD_WORDS; i++)
+    {
+        if (!RDA_HAL_FlashProgram(address + 2 * i, words[i]))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Reads a record back into the RAM copy, records with a bad CRC or tag are skipped
+ */
+static void storeLoad(RDA_Store* store, uint32_t address)
+{
+    uint16_t words[RECORD_WORDS];
+    RDA_StoreEntry* entry;
+    uint8_t i;
+
+    for (i = 0; i < RECORD_WORDS; i++)
+    {
+        words[i] = RDA_HAL_FlashRead(address + 2 * i);
+    }
+    if (words[RECORD_WORDS - 1] != storeCrc(words, RECORD_WORDS - 1))
+    {
+        return;
+    }
+    if (words[0] == TAG_STATE)
+    {
+        entry = &store->state;
+    }
+    else if (TAG_IS_PRESET(words[0]))
+    {
+        entry = &store->presets[words[0] & 0x000F];
+    }
+    else
+    {
+        return;
+    }
+    entry->frequency = words[1] | ((uint32_t)words[2] << 16);
+    entry->band = words[3] & 0xFF;
+    entry->space = words[3] >> 8;
+    entry->volume = words[4] & 0xFF;
+    entry->flags = words[4] >> 8;
+    for (i = 0; i < RDA_STORE_PS / 2; i++)
+    {
+        entry->ps[2 * i] = words[5 + i] & 0xFF;
+        entry->ps[2 * i + 1] = words[5 + i] >> 8;
+    }
+    entry->ps[RDA_STORE_PS] = 0;
+}
+
+/*
+ * Reads a page header, returns 1 when the page holds a store
+ */
+static uint8_t storeHeader(const RDA_Store* store, uint8_t page, uint32_t* generation)
+{
+    uint32_t address = storePage(store, page);
+
+    *generation = RDA_HAL_FlashRead(address + 4) | ((uint32_t)RDA_HAL_FlashRead(address + 6) << 16);
+    return RDA_HAL_FlashRead(address) == STORE_MAGIC && RDA_HAL_FlashRead(address + 2) == STORE_VERSION &&
+           *generation != 0xFFFFFFFF;
+}
+
+/*
+ * Writes the RAM copy into the other page and makes it the active one
+ */
+static uint8_t storeCompact(RDA_Store* store)
+{
+    uint8_t page = store->page ^ 1;
+    uint32_t address = storePage(store, page);
+    uint32_t generation = store->generation + 1;
+    uint16_t next = HEADER_BYTES;
+    uint8_t slot;
+
+    if (!RDA_HAL_FlashErase(address))
+    {
+        return 0;
+    }
+    if (store->state.frequency)
+    {
+        if (!storeProgram(address + next, TAG_STATE, &store->state))
+        {
+            return 0;
+        }
+        next += RECORD_BYTES;
+    }
+    for (slot = 0; slot < RDA_STORE_PRESETS; slot++)
+    {
+        if (store->presets[slot].frequency)
+        {
+            if (!storeProgram(address + next, TAG_PRESET(slot), &store->presets[slot]))
+            {
+                return 0;
+            }
+            next += RECORD_BYTES;
+        }
+    }
+    // The header makes the page valid, magic last
+    if (!RDA_HAL_FlashProgram(address + 4, generation & 0xFFFF) ||
+        !RDA_HAL_FlashProgram(address + 6, generation >> 16) ||
+        !RDA_HAL_FlashProgram(address + 2, STORE_VERSION) ||
+        !RDA_HAL_FlashProgram(address, STORE_MAGIC))
+    {
+        return 0;
+    }
+    store->page = page;
+    store->generation = generation;
+    store->next = next;
+    store->records += next / RECORD_BYTES;
+    store->compactions++;
+    return 1;
+}
+
+/*
+ * Appends a record of an entry the RAM copy already holds, compacts a full page instead
+ */
+static uint8_t storeAppend(RDA_Store* store, uint16_t tag, const RDA_StoreEntry* entry)
+{
+    uint32_t address = storePage(store, store->page) + store->next;
+
+    if (store->next + RECORD_BYTES > RDA_FLASH_PAGE_SIZE)
+    {
+        return storeCompact(store);
+    }
+    // The slot is used up even when programming fails half way
+    store->next += RECORD_BYTES;
+    store->records++;
+    return storeProgram(address, tag, entry);
+}
+
+uint8_t RDA_StoreOpen(RDA_Store* store, uint32_t base)
+{
+    uint32_t generation[2];
+    uint8_t valid[2];
+    uint32_t address;
+    uint8_t slot;
+
+    store->base = base;
+    store->records = 0;
+    store->compactions = 0;
+    entryClear(&store->state);
+    for (slot = 0; slot < RDA_STORE_PRESETS; slot++)
+    {
+        entryClear(&store->presets[slot]);
+    }
+
+    valid[0] = storeHeader(store, 0, &generation[0]);
+    valid[1] = storeHeader(store, 1, &generation[1]);
+    if (!valid[0] && !valid[1])
+    {
+        // Format: compact the empty RAM copy into page 0
+        store->page = 1;
+        store->generation = 0;
+        return storeCompact(store);
+    }
+    // Both valid when a compaction was cut before the old page was reused, the newer one wins
+    store->page = (!valid[0] || (valid[1] && (int32_t)(generation[1] - generation[0]) > 0)) ? 1 : 0;
+    store->generation = generation[store->page];
+
+    address = storePage(store, store->page);
+    for (store->next = HEADER_BYTES; store->next + RECORD_BYTES <= RDA_FLASH_PAGE_SIZE; store->next += RECORD_BYTES)
+    {
+        if (RDA_HAL_FlashRead(address + store->next) == ERASED)
+        {
+            break;
+        }
+        storeLoad(store, address + store->next);
+    }
+    return 1;
+}
+
+uint8_t RDA_StoreSaveState(RDA_Store* store, const RDA_StoreEntry* state)
+{
+    if (entryEqual(&store->state, state))
+    {
+        return 1;
+    }
+    entryCopy(&store->state, state);
+    return storeAppend(store, TAG_STATE, &store->state);
+}
+
+uint8_t RDA_StoreSavePreset(RDA_Store* store, uint8_t slot, const RDA_StoreEntry* preset)
+{
+    if (slot >= RDA_STORE_PRESETS)
+    {
+        return 0;
+    }
+    if (entryEqual(&store->presets[slot], preset))
+    {
+        return 1;
+    }
+    entryCopy(&store->presets[slot], preset);
+    return storeAppend(store, TAG_PRESET(slot), &store->presets[slot]);
+}
+
+const RDA_StoreEntry* RDA_StoreGetState(const RDA_Store* store)
+{
+    return store->state.frequency ? &store->state : 0;
+}
+
+const RDA_StoreEntry* RDA_StoreGetPreset(const RDA_Store* store, uint8_t slot)
+{
+    return (slot < RDA_STORE_PRESETS && store->presets[slot].frequency) ? &store->presets[slot] : 0;
+}
@@ -0,0 +1,109 @@
+#ifndef __RDA_STORE_H
+#define __RDA_STORE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_HAL.h>
+
+/**
+ * @defgroup GA11 Preset store
+ * @brief Last state and station presets in two flash pages, wear-leveled
+ * @details Every save appends a record behind the last one in the active page; a page is only
+ * @details erased when the other one is full, so each record slot is programmed once per erase.
+ * @details A full page is compacted into the other: the latest state and presets are written
+ * @details there first and its header last, so a power cut at any point leaves one valid page.
+ * @details Records carry a CRC written last, a record cut short is skipped when mounting.
+ * @details RDA_StoreOpen reads the flash once, after that the latest entries come from RAM.
+ * @details Saving an entry equal to the stored one writes nothing.
+ */
+
+#define RDA_STORE_PRESETS   8       //!< Preset slots
+#define RDA_STORE_PS        8       //!< PS name characters
+#define RDA_STORE_RECORD    20      //!< Flash bytes per saved entry
+
+// RDA_StoreEntry flags
+#define RDA_STORE_BASS      0x01    //!< Bass boost on
+#define RDA_STORE_MONO      0x02    //!< Forced mono
+
+/**
+ * @ingroup GA11
+ * @brief A station with the receiver settings it is listened with
+ */
+typedef struct
+{
+    uint32_t frequency;             //!< kHz, 0 for an empty entry
+    uint8_t band;                   //!< FM band
+    uint8_t space;                  //!< FM space
+    uint8_t volume;                 //!< 0 to 15
+    uint8_t flags;                  //!< RDA_STORE_xxx
+    char ps[RDA_STORE_PS + 1];      //!< PS name seen on the station, "" when none
+} RDA_StoreEntry;
+
+/**
+ * @ingroup GA11
+ * @brief Store state, allocated by the application
+ */
+typedef struct
+{
+    uint32_t base;                              //!< Address of the first of the two pages
+    uint8_t page;                               //!< Active page, 0 or 1
+    uint16_t next;                              //!< Offset of the next free record in the active page
+    uint32_t generation;                        //!< Header generation of the active page
+    RDA_StoreEntry state;                       //!< Last state, frequency 0 when none is stored
+    RDA_StoreEntry presets[RDA_STORE_PRESETS];  //!< Presets, frequency 0 for an empty slot
+    uint32_t records;                           //!< Records written since the store was opened
+    uint32_t compactions;                       //!< Page changes since the store was opened
+} RDA_Store;
+
+/**
+ * @ingroup GA11
+ * @brief Mount the store, formats it when neither page holds one
+ * @param store Store
+ * @param base First address of two RDA_FLASH_PAGE_SIZE pages reserved for the store
+ * @return 1 on success, 0 on a flash error while formatting
+ */
+uint8_t RDA_StoreOpen(RDA_Store* store, uint32_t base);
+
+/**
+ * @ingroup GA11
+ * @brief Save the last state
+ * @param store Store
+ * @param state State
+ * @return 1 on success, 0 on a flash error (the RAM copy holds the state anyway)
+ */
+uint8_t RDA_StoreSaveState(RDA_Store* store, const RDA_StoreEntry* state);
+
+/**
+ * @ingroup GA11
+ * @brief Save a preset, an entry with frequency 0 clears the slot
+ * @param store Store
+ * @param slot 0 to RDA_STORE_PRESETS - 1
+ * @param preset Preset
+ * @return 1 on success, 0 on a flash error or a bad slot
+ */
+uint8_t RDA_StoreSavePreset(RDA_Store* store, uint8_t slot, const RDA_StoreEntry* preset);
+
+/**
+ * @ingroup GA11
+ * @brief Get the last state
+ * @param store Store
+ * @return the state, 0 when none is stored
+ */
+const RDA_StoreEntry* RDA_StoreGetState(const RDA_Store* store);
+
+/**
+ * @ingroup GA11
+ * @brief Get a preset
+ * @param store Store
+ * @param slot 0 to RDA_STORE_PRESETS - 1
+ * @return the preset, 0 for an empty or bad slot
+ */
+const RDA_StoreEntry* RDA_StoreGetPreset(const RDA_Store* store, uint8_t slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_STORE_H */
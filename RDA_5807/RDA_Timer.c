@@ -0,0 +1,89 @@
+#include <RDA_Timer.h>
+
+#ifdef SYSTICK_DELAY
+
+// Armed timers, earliest deadline first
+static RDA_Timer* timers = 0;
+
+/*
+ * Deadline order that survives the wrap of getMillis(), deadlines are less than 2^31 ms apart
+ */
+static uint8_t timerBefore(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+void RDA_TimerStart(RDA_Timer* timer, uint32_t delay, RDA_TimerCallback callback, void* context)
+{
+    RDA_Timer** link = &timers;
+
+    RDA_TimerStop(timer);
+    timer->deadline = getMillis() + delay;
+    timer->callback = callback;
+    timer->context = context;
+    // Behind the timers with the same deadline, so they run in the order they were started
+    while (*link && !timerBefore(timer->deadline, (*link)->deadline))
+    {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+    timer->armed = 1;
+}
+
+void RDA_TimerStop(RDA_Timer* timer)
+{
+    RDA_Timer** link = &timers;
+
+    if (!timer->armed)
+    {
+        return;
+    }
+    while (*link && *link != timer)
+    {
+        link = &(*link)->next;
+    }
+    if (*link)
+    {
+        *link = timer->next;
+    }
+    timer->armed = 0;
+}
+
+uint8_t RDA_TimerRun(void)
+{
+    RDA_Timer* timer;
+    uint8_t count = 0;
+
+    while (timers && !timerBefore(getMillis(), timers->deadline))
+    {
+        timer = timers;
+        timers = timer->next;
+        timer->armed = 0;
+        timer->callback(timer);
+        count++;
+    }
+    return count;
+}
+
+void RDA_TimerSleep(void)
+{
+    if (RDA_TimerRun())
+    {
+        return;
+    }
+    // SysTick or any other interrupt ends the sleep
+    RDA_HAL_Idle();
+}
+
+uint8_t RDA_TimerNext(uint32_t* wait)
+{
+    if (!timers)
+    {
+        return 0;
+    }
+    *wait = timerBefore(getMillis(), timers->deadline) ? timers->deadline - getMillis() : 0;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef __RDA_TIMER_H
+#define __RDA_TIMER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_HAL.h>
+
+/**
+ * @defgroup GA09 Timer service
+ * @brief One-shot deadline callbacks on the millisecond timebase
+ * @details Timers are kept in a list sorted by deadline, so finding the next one is O(1).
+ * @details Callbacks run from RDA_TimerRun or RDA_TimerSleep in the main loop, never from an
+ * @details interrupt, and may start timers again (periodic work re-arms itself).
+ * @details RDA_TimerSleep puts the core to sleep (RDA_HAL_Idle, WFI on the STM32) until the next
+ * @details deadline or interrupt instead of spinning. Needs the SysTick timebase (SYSTICK_DELAY).
+ */
+
+struct RDA_Timer;
+
+/**
+ * @ingroup GA09
+ * @brief Timer callback, runs in the main loop
+ */
+typedef void (*RDA_TimerCallback)(struct RDA_Timer* timer);
+
+/**
+ * @ingroup GA09
+ * @brief Timer, allocated by its owner; must stay valid while armed
+ */
+typedef struct RDA_Timer
+{
+    struct RDA_Timer* next;     //!< Next armed timer, later deadline
+    uint32_t deadline;          //!< getMillis() the callback is due
+    RDA_TimerCallback callback; //!< Called once when due
+    void* context;              //!< User data for the callback
+    uint8_t armed;              //!< In the list
+} RDA_Timer;
+
+#ifdef SYSTICK_DELAY
+
+/**
+ * @ingroup GA09
+ * @brief Arm a timer, a timer already armed is moved to the new deadline
+ * @param timer Timer
+ * @param delay ms from now
+ * @param callback Called once when due
+ * @param context User data for the callback
+ */
+void RDA_TimerStart(RDA_Timer* timer, uint32_t delay, RDA_TimerCallback callback, void* context);
+
+/**
+ * @ingroup GA09
+ * @brief Disarm a timer, nothing happens when it is not armed
+ * @param timer Timer
+ */
+void RDA_TimerStop(RDA_Timer* timer);
+
+/**
+ * @ingroup GA09
+ * @brief Run the callbacks that are due
+ * @return number of callbacks run
+ */
+uint8_t RDA_TimerRun(void);
+
+/**
+ * @ingroup GA09
+ * @brief Run the callbacks that are due, otherwise sleep until the next deadline or interrupt
+ * @details Call in the main loop. Returns after every wake-up, so work flagged by interrupts is
+ * @details picked up right away.
+ */
+void RDA_TimerSleep(void);
+
+/**
+ * @ingroup GA09
+ * @brief Get the ms until the next deadline
+ * @param wait Filled with the ms, 0 when a callback is due
+ * @return 1 when a timer is armed
+ */
+uint8_t RDA_TimerNext(uint32_t* wait);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_TIMER_H */
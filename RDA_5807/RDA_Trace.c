@@ -0,0 +1,112 @@
+#include <RDA_Trace.h>
+
+// Ring the transfers go to, NULL when not recording
+static RDA_Trace* attached;
+
+/*
+ * Byte of the ring at a free running position
+ */
+static uint8_t* traceByte(const RDA_Trace* trace, uint32_t position)
+{
+    return &trace->buffer[position % trace->size];
+}
+
+/*
+ * Appends bytes, the room was made before
+ */
+static void tracePut(RDA_Trace* trace, const uint8_t* data, uint8_t length)
+{
+    uint8_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        *traceByte(trace, trace->head++) = data[i];
+    }
+}
+
+void RDA_TraceInit(RDA_Trace* trace, uint8_t* buffer, uint32_t size)
+{
+    trace->buffer = buffer;
+    trace->size = size;
+    trace->dumping = 0;
+    RDA_TraceClear(trace);
+}
+
+void RDA_TraceAttach(RDA_Trace* trace)
+{
+    attached = trace;
+}
+
+void RDA_TraceRecord(const RDA_Xfer* xfer, uint32_t started)
+{
+    RDA_Trace* trace = attached;
+    uint32_t need = RDA_TRACE_RECORD + 2 * xfer->length;
+    uint8_t header[RDA_TRACE_RECORD];
+    uint8_t word[2];
+    uint8_t i;
+
+    if (!trace)
+    {
+        return;
+    }
+    if (need > trace->size || trace->dumping)
+    {
+        trace->dropped++;
+        return;
+    }
+    // Oldest records out until the new one fits, the word count is the last header byte
+    while (trace->size - (trace->head - trace->tail) < need)
+    {
+        trace->tail += RDA_TRACE_RECORD + 2 * *traceByte(trace, trace->tail + RDA_TRACE_RECORD - 1);
+        trace->dropped++;
+    }
+    header[0] = started;
+    header[1] = started >> 8;
+    header[2] = started >> 16;
+    header[3] = started >> 24;
+    header[4] = xfer->address;
+    header[5] = (xfer->direction == RDA_XFER_READ ? RDA_TRACE_READ : 0) | ((xfer->status & 0x07) << 1);
+    header[6] = xfer->reg;
+    header[7] = xfer->length;
+    tracePut(trace, header, RDA_TRACE_RECORD);
+    for (i = 0; i < xfer->length; i++)
+    {
+        word[0] = xfer->data[i];
+        word[1] = xfer->data[i] >> 8;
+        tracePut(trace, word, 2);
+    }
+    trace->records++;
+}
+
+void RDA_TraceDump(RDA_Trace* trace, RDA_TraceWrite write, void* context)
+{
+    uint8_t header[RDA_TRACE_HEADER] = {'R', 'D', 'A', 'T', RDA_TRACE_VERSION, RDA_TRACE_RECORD, 0, 0};
+    uint32_t start;
+    uint32_t used;
+
+    // Set before the ring is looked at: a completion from here on leaves head and tail alone
+    trace->dumping = 1;
+    start = trace->tail % trace->size;
+    used = trace->head - trace->tail;
+    write(context, header, RDA_TRACE_HEADER);
+    if (start + used > trace->size)
+    {
+        // Wrapped: the end of the buffer, then its start
+        write(context, &trace->buffer[start], trace->size - start);
+        used -= trace->size - start;
+        start = 0;
+    }
+    if (used)
+    {
+        write(context, &trace->buffer[start], used);
+    }
+    trace->dumping = 0;
+}
+
+void RDA_TraceClear(RDA_Trace* trace)
+{
+    trace->head = 0;
+    trace->tail = 0;
+    trace->records = 0;
+    trace->dropped = 0;
+}
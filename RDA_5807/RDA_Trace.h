@@ -0,0 +1,97 @@
+#ifndef __RDA_TRACE_H
+#define __RDA_TRACE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_HAL.h>
+
+/**
+ * @defgroup GA13 Bus trace
+ * @brief Every transfer on the bus recorded into a RAM ring, dumped on request
+ * @details The transfer queues record each transfer into the attached ring when it completes, whichever
+ * @details port ran it (RDA_HAL_Write/RDA_HAL_Read or the interrupt port) and for every handle, so
+ * @details the trace may start before RDA_Init and covers the power-up. A full ring drops its oldest records.
+ * @details Dump format, all numbers little-endian:
+ * @details - header: "RDAT", version, record header size, two zero bytes
+ * @details - per transfer: start time in us (4), address (1), flags (1: bit 0 read, bits 1-3
+ * @details   RDA_XferStatus), register or RDA_XFER_NO_REG (1), word count (1), then the words (2 each)
+ * @details host/i2c_replay reads the dump: lists it, replays it against the chip model and diffs two.
+ */
+
+#define RDA_TRACE_VERSION   1       //!< Dump format version
+#define RDA_TRACE_HEADER    8       //!< Dump header bytes
+#define RDA_TRACE_RECORD    8       //!< Record header bytes, the words follow
+
+#define RDA_TRACE_READ      0x01    //!< Flags: read transfer
+#define RDA_TRACE_STATUS(flags) (((flags) >> 1) & 0x07) //!< Flags: RDA_XferStatus of the transfer
+
+/**
+ * @ingroup GA13
+ * @brief Trace ring, allocated by the application
+ */
+typedef struct RDA_Trace
+{
+    uint8_t* buffer;        //!< Ring storage
+    uint32_t size;          //!< Bytes of storage
+    volatile uint32_t head; //!< Bytes written, free running
+    volatile uint32_t tail; //!< Bytes dropped or cleared, free running
+    uint32_t records;       //!< Transfers recorded
+    uint32_t dropped;       //!< Records dropped for room or while dumping
+    volatile uint8_t dumping;   //!< RDA_TraceDump is reading the ring, nothing is recorded
+} RDA_Trace;
+
+/**
+ * @ingroup GA13
+ * @brief Dump sink, e.g. a UART or a file
+ */
+typedef void (*RDA_TraceWrite)(void* context, const uint8_t* data, uint32_t length);
+
+/**
+ * @ingroup GA13
+ * @brief Init a trace ring
+ * @param trace Trace
+ * @param buffer Storage, a transfer takes RDA_TRACE_RECORD bytes plus 2 per word
+ * @param size Bytes of storage
+ */
+void RDA_TraceInit(RDA_Trace* trace, uint8_t* buffer, uint32_t size);
+
+/**
+ * @ingroup GA13
+ * @brief Record the bus transfers into a ring
+ * @param trace Trace, see RDA_TraceInit; NULL stops the recording
+ */
+void RDA_TraceAttach(RDA_Trace* trace);
+
+/**
+ * @ingroup GA13
+ * @brief Record a completed transfer, called by the transfer queue
+ * @param xfer Transfer
+ * @param started getMicros() when the transfer started on the bus of its queue
+ */
+void RDA_TraceRecord(const RDA_Xfer* xfer, uint32_t started);
+
+/**
+ * @ingroup GA13
+ * @brief Write the header and the records, oldest first
+ * @details Transfers that complete in interrupts meanwhile are counted as dropped, not recorded,
+ * @details so the ring does not move under the sink.
+ * @param trace Trace
+ * @param write Sink
+ * @param context Passed to the sink
+ */
+void RDA_TraceDump(RDA_Trace* trace, RDA_TraceWrite write, void* context);
+
+/**
+ * @ingroup GA13
+ * @brief Drop all records
+ * @param trace Trace
+ */
+void RDA_TraceClear(RDA_Trace* trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_TRACE_H */
@@ -0,0 +1,128 @@
+#include <RDA_Xfer.h>
+#include <RDA_Trace.h>
+#include <stddef.h>
+
+#define XFER_SLOT(index) ((index) & (RDA_XFER_QUEUE_SIZE - 1))
+
+static void xferLock(RDA_XferQueue* queue)
+{
+    if (queue->port->lock)
+    {
+        queue->port->lock(queue->portContext);
+    }
+}
+
+static void xferUnlock(RDA_XferQueue* queue)
+{
+    if (queue->port->unlock)
+    {
+        queue->port->unlock(queue->portContext);
+    }
+}
+
+/**
+ * @ingroup GA04
+ * @brief Starts queued transfers while the bus is idle
+ * @details A synchronous port completes inside start(); the loop then picks the next
+ * @details descriptor instead of recursing through RDA_XferComplete.
+ */
+static void xferKick(RDA_XferQueue* queue)
+{
+    RDA_Xfer* xfer;
+
+    xferLock(queue);
+    if (queue->starting || queue->active || queue->halted || queue->head == queue->tail)
+    {
+        xferUnlock(queue);
+        return;
+    }
+    queue->starting = 1;
+    do
+    {
+        queue->active = 1;
+        xfer = queue->slots[XFER_SLOT(queue->tail)];
+        xferUnlock(queue);
+#ifdef SYSTICK_DELAY
+        queue->started = getMicros();
+#endif
+        queue->port->start(queue->portContext, xfer);
+        xferLock(queue);
+    }
+    while (!queue->active && queue->head != queue->tail);
+    queue->starting = 0;
+    xferUnlock(queue);
+}
+
+void RDA_XferInit(RDA_XferQueue* queue, const RDA_XferPort* port, void* portContext)
+{
+    queue->port = port;
+    queue->portContext = portContext;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->active = 0;
+    queue->starting = 0;
+    queue->halted = 0;
+    queue->started = 0;
+}
+
+uint8_t RDA_XferSubmit(RDA_XferQueue* queue, RDA_Xfer* xfer)
+{
+    xferLock(queue);
+    if ((uint8_t)(queue->head - queue->tail) >= RDA_XFER_QUEUE_SIZE)
+    {
+        xferUnlock(queue);
+        return 0;
+    }
+    xfer->status = RDA_XFER_PENDING;
+    queue->slots[XFER_SLOT(queue->head)] = xfer;
+    queue->head++;
+    xferUnlock(queue);
+
+    xferKick(queue);
+    return 1;
+}
+
+void RDA_XferComplete(RDA_XferQueue* queue, RDA_XferStatus status)
+{
+    RDA_Xfer* xfer;
+
+    if (!queue->active)
+    {
+        return; // Spurious completion
+    }
+    xfer = queue->slots[XFER_SLOT(queue->tail)];
+    queue->tail++;
+    queue->active = 0;
+
+    xfer->status = status;
+    RDA_TraceRecord(xfer, queue->started);
+    if (xfer->callback)
+    {
+        xfer->callback(xfer);
+    }
+    xferKick(queue);
+}
+
+void RDA_XferAbort(RDA_XferQueue* queue)
+{
+    xferLock(queue);
+    queue->halted = 1;
+    if (queue->active && queue->port->abort)
+    {
+        queue->port->abort(queue->portContext);
+    }
+    xferUnlock(queue);
+    // Does nothing when the transfer completed in the meantime
+    RDA_XferComplete(queue, RDA_XFER_TIMEOUT);
+}
+
+void RDA_XferResume(RDA_XferQueue* queue)
+{
+    queue->halted = 0;
+    xferKick(queue);
+}
+
+uint8_t RDA_XferBusy(RDA_XferQueue* queue)
+{
+    return queue->active || queue->head != queue->tail;
+}
@@ -0,0 +1,144 @@
+#ifndef __RDA_XFER_H
+#define __RDA_XFER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define RDA_XFER_QUEUE_SIZE 8       //!< Descriptors that can be queued at a time (power of two)
+#define RDA_XFER_NO_REG     0xFF    //!< Descriptor has no register address phase (sequential access)
+
+#define RDA_XFER_WRITE      0       //!< Write words to the chip
+#define RDA_XFER_READ       1       //!< Read words from the chip
+
+/**
+ * @ingroup GA04
+ * @brief Transfer result
+ */
+typedef enum
+{
+    RDA_XFER_PENDING,   //!< Queued or on the bus
+    RDA_XFER_OK,        //!< Completed
+    RDA_XFER_ERROR,     //!< Bus error, reported by the port
+    RDA_XFER_TIMEOUT,   //!< A bus event did not happen within its budget
+    RDA_XFER_NACK       //!< The chip did not acknowledge
+} RDA_XferStatus;
+
+struct RDA_Xfer;
+
+/**
+ * @ingroup GA04
+ * @brief Transfer completion callback, called from the context that completed the transfer
+ */
+typedef void (*RDA_XferCallback)(struct RDA_Xfer* xfer);
+
+/**
+ * @ingroup GA04
+ * @brief Transfer descriptor
+ * @details A write sends [reg] followed by the words, high byte first.
+ * @details A read with a register first writes reg (STOP), then reads the words.
+ * @details The descriptor and its data must stay valid until the transfer completes.
+ */
+typedef struct RDA_Xfer
+{
+    uint8_t address;                //!< 7-bit I2C address (I2C_ADDR_DIRECT_ACCESS or I2C_ADDR_FULL_ACCESS)
+    uint8_t direction;              //!< RDA_XFER_WRITE or RDA_XFER_READ
+    uint8_t reg;                    //!< Register address, RDA_XFER_NO_REG for sequential access
+    uint8_t length;                 //!< Number of 16-bit words
+    uint16_t* data;                 //!< Words to write or read buffer
+    RDA_XferCallback callback;      //!< Optional completion callback
+    void* context;                  //!< User data for the callback
+    volatile RDA_XferStatus status; //!< Updated by the engine
+} RDA_Xfer;
+
+/**
+ * @ingroup GA04
+ * @brief Bus port the transfer engine runs on
+ * @details start() puts one descriptor on the bus and returns; the port reports the end with
+ * @details RDA_XferComplete, from an interrupt or directly from start().
+ * @details lock()/unlock() mask the port interrupt and may be NULL when completion is synchronous.
+ * @details abort() stops the transfer on the bus without reporting it, called with the port locked;
+ * @details it may be NULL when completion is synchronous.
+ */
+typedef struct
+{
+    void (*start)(void* port, RDA_Xfer* xfer);
+    void (*lock)(void* port);
+    void (*unlock)(void* port);
+    void (*abort)(void* port);
+} RDA_XferPort;
+
+/**
+ * @ingroup GA04
+ * @brief Transfer queue
+ */
+typedef struct
+{
+    const RDA_XferPort* port;
+    void* portContext;
+    RDA_Xfer* slots[RDA_XFER_QUEUE_SIZE];
+    volatile uint8_t head;          //!< Next free slot, written by submitters
+    volatile uint8_t tail;          //!< Transfer on the bus, written by completion
+    volatile uint8_t active;        //!< A transfer is on the bus
+    uint8_t starting;               //!< Guards against re-entrant starts from synchronous ports
+    volatile uint8_t halted;        //!< Set by RDA_XferAbort, nothing starts until RDA_XferResume
+    uint32_t started;               //!< getMicros() when the transfer on the bus started, for the trace
+} RDA_XferQueue;
+
+/**
+ * @ingroup GA04
+ * @brief Init a transfer queue on a port
+ * @param queue Transfer queue
+ * @param port Port operations
+ * @param portContext Passed back to every port operation
+ */
+void RDA_XferInit(RDA_XferQueue* queue, const RDA_XferPort* port, void* portContext);
+
+/**
+ * @ingroup GA04
+ * @brief Queue a transfer, it starts right away when the bus is idle
+ * @param queue Transfer queue
+ * @param xfer Transfer descriptor
+ * @return 1 when queued, 0 when the queue is full
+ */
+uint8_t RDA_XferSubmit(RDA_XferQueue* queue, RDA_Xfer* xfer);
+
+/**
+ * @ingroup GA04
+ * @brief Report the end of the transfer on the bus, called by the port
+ * @param queue Transfer queue
+ * @param status RDA_XFER_OK or the failure
+ */
+void RDA_XferComplete(RDA_XferQueue* queue, RDA_XferStatus status);
+
+/**
+ * @ingroup GA04
+ * @brief Give up the transfer on the bus, it completes with RDA_XFER_TIMEOUT
+ * @details The port stops it and the queue halts, so the bus can be recovered before
+ * @details the queued transfers go out with RDA_XferResume.
+ * @param queue Transfer queue
+ */
+void RDA_XferAbort(RDA_XferQueue* queue);
+
+/**
+ * @ingroup GA04
+ * @brief Start the queued transfers again after RDA_XferAbort
+ * @param queue Transfer queue
+ */
+void RDA_XferResume(RDA_XferQueue* queue);
+
+/**
+ * @ingroup GA04
+ * @brief Check whether transfers are queued or on the bus
+ * @param queue Transfer queue
+ * @return 1 when busy
+ */
+uint8_t RDA_XferBusy(RDA_XferQueue* queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_XFER_H */
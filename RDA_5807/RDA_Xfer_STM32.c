@@ -0,0 +1,202 @@
+#include <RDA_Xfer_STM32.h>
+
+#define PHASE_REG       0   // Register address byte
+#define PHASE_RESTART   1   // Register sent, repeated START for the read
+#define PHASE_DATA      2   // Data bytes
+
+// SR1/SR2 bits as returned by I2C_GetLastEvent
+#define EVENT_SB    0x00000001
+#define EVENT_ADDR  0x00000002
+#define EVENT_BTF   0x00000004
+#define EVENT_RXNE  0x00000040
+#define EVENT_TXE   0x00000080
+#define EVENT_TRA   0x00040000
+
+#define PORT_IT (I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR)
+
+static void portLock(void* context)
+{
+    RDA_XferSTM32* port = context;
+    NVIC_DisableIRQ(port->eventIRQ);
+    NVIC_DisableIRQ(port->errorIRQ);
+}
+
+static void portUnlock(void* context)
+{
+    RDA_XferSTM32* port = context;
+    NVIC_EnableIRQ(port->eventIRQ);
+    NVIC_EnableIRQ(port->errorIRQ);
+}
+
+static void portStart(void* context, RDA_Xfer* xfer)
+{
+    RDA_XferSTM32* port = context;
+
+    port->xfer = xfer;
+    port->phase = (xfer->reg == RDA_XFER_NO_REG) ? PHASE_DATA : PHASE_REG;
+    port->index = 0;
+    port->count = xfer->length * 2;
+    I2C_ITConfig(port->I2Cx, PORT_IT, ENABLE);
+    I2C_GenerateSTART(port->I2Cx, ENABLE);
+}
+
+/*
+ * Drops the transfer on the bus, e.g. when SB never came on a stuck bus
+ * The caller recovers the peripheral with RDA_HAL_Recover afterwards
+ */
+static void portAbort(void* context)
+{
+    RDA_XferSTM32* port = context;
+
+    I2C_ITConfig(port->I2Cx, PORT_IT, DISABLE);
+    I2C_GenerateSTOP(port->I2Cx, ENABLE);
+    port->xfer = 0;
+}
+
+const RDA_XferPort RDA_XferPortSTM32 = {portStart, portLock, portUnlock, portAbort};
+
+/*
+ * Releases the bus and reports the transfer to the queue
+ */
+static void portFinish(RDA_XferSTM32* port, RDA_XferStatus status)
+{
+    I2C_GenerateSTOP(port->I2Cx, ENABLE);
+    I2C_ITConfig(port->I2Cx, PORT_IT, DISABLE);
+    port->xfer = 0;
+    RDA_XferComplete(port->queue, status);
+}
+
+/*
+ * Gets the next byte to transmit, words go out high byte first
+ */
+static uint8_t portTxByte(RDA_XferSTM32* port, uint8_t* byte)
+{
+    RDA_Xfer* xfer = port->xfer;
+    uint16_t word;
+
+    if (port->phase == PHASE_REG)
+    {
+        *byte = xfer->reg;
+        port->phase = (xfer->direction == RDA_XFER_WRITE) ? PHASE_DATA : PHASE_RESTART;
+        return 1;
+    }
+    if (port->phase == PHASE_DATA && xfer->direction == RDA_XFER_WRITE && port->index < port->count)
+    {
+        word = xfer->data[port->index / 2];
+        *byte = (port->index & 1) ? (uint8_t)word : (uint8_t)(word >> 8);
+        port->index++;
+        return 1;
+    }
+    return 0;
+}
+
+void RDA_XferSTM32Init(RDA_XferSTM32* port, I2C_TypeDef* I2Cx, RDA_XferQueue* queue)
+{
+    port->I2Cx = I2Cx;
+    port->queue = queue;
+    port->xfer = 0;
+    if (I2Cx == I2C1)
+    {
+        port->eventIRQ = I2C1_EV_IRQn;
+        port->errorIRQ = I2C1_ER_IRQn;
+    }
+    else
+    {
+        port->eventIRQ = I2C2_EV_IRQn;
+        port->errorIRQ = I2C2_ER_IRQn;
+    }
+}
+
+void RDA_XferSTM32EventIRQ(RDA_XferSTM32* port)
+{
+    I2C_TypeDef* I2Cx = port->I2Cx;
+    RDA_Xfer* xfer = port->xfer;
+    // Reading SR1 then SR2 also clears ADDR
+    uint32_t event = I2C_GetLastEvent(I2Cx);
+    uint8_t receive;
+    uint8_t byte;
+
+    if (!xfer)
+    {
+        I2C_ITConfig(I2Cx, PORT_IT, DISABLE);
+        return;
+    }
+    receive = (port->phase == PHASE_DATA && xfer->direction == RDA_XFER_READ);
+
+    if (event & EVENT_SB)
+    {
+        if (receive)
+        {
+            // NACK the only byte, otherwise ACK until the last one
+            I2C_AcknowledgeConfig(I2Cx, (port->count > 1) ? ENABLE : DISABLE);
+        }
+        I2C_Send7bitAddress(I2Cx, xfer->address << 1, receive ? I2C_Direction_Receiver : I2C_Direction_Transmitter);
+        return;
+    }
+    if (event & EVENT_ADDR)
+    {
+        if (receive && port->count == 1)
+        {
+            I2C_GenerateSTOP(I2Cx, ENABLE);
+        }
+        return;
+    }
+    if (event & EVENT_TRA)
+    {
+        if ((event & EVENT_TXE) && portTxByte(port, &byte))
+        {
+            I2C_SendData(I2Cx, byte);
+            return;
+        }
+        // Nothing left, wait for the last byte to leave the shift register
+        I2C_ITConfig(I2Cx, I2C_IT_BUF, DISABLE);
+        if (event & EVENT_BTF)
+        {
+            if (port->phase == PHASE_RESTART)
+            {
+                port->phase = PHASE_DATA;
+                I2C_ITConfig(I2Cx, I2C_IT_BUF, ENABLE);
+                I2C_GenerateSTART(I2Cx, ENABLE);
+                return;
+            }
+            portFinish(port, RDA_XFER_OK);
+        }
+        return;
+    }
+    if (event & EVENT_RXNE)
+    {
+        byte = I2C_ReceiveData(I2Cx);
+        if (port->index & 1)
+        {
+            xfer->data[port->index / 2] |= byte;
+        }
+        else
+        {
+            xfer->data[port->index / 2] = (uint16_t)byte << 8;
+        }
+        port->index++;
+        if (port->count - port->index == 1)
+        {
+            // NACK and STOP after the last byte
+            I2C_AcknowledgeConfig(I2Cx, DISABLE);
+            I2C_GenerateSTOP(I2Cx, ENABLE);
+        }
+        else if (port->index == port->count)
+        {
+            I2C_ITConfig(I2Cx, PORT_IT, DISABLE);
+            port->xfer = 0;
+            RDA_XferComplete(port->queue, RDA_XFER_OK);
+        }
+    }
+}
+
+void RDA_XferSTM32ErrorIRQ(RDA_XferSTM32* port)
+{
+    RDA_XferStatus status = I2C_GetITStatus(port->I2Cx, I2C_IT_AF) ? RDA_XFER_NACK : RDA_XFER_ERROR;
+
+    I2C_ClearITPendingBit(port->I2Cx, I2C_IT_AF | I2C_IT_ARLO | I2C_IT_BERR | I2C_IT_OVR);
+    if (port->xfer)
+    {
+        portFinish(port, status);
+    }
+}
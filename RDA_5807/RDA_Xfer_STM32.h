@@ -0,0 +1,62 @@
+#ifndef __RDA_XFER_STM32_H
+#define __RDA_XFER_STM32_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stm32f10x_i2c.h>
+#include <RDA_Xfer.h>
+
+/**
+ * @ingroup GA04
+ * @brief Interrupt driven I2C port state
+ */
+typedef struct
+{
+    I2C_TypeDef* I2Cx;      //!< I2C peripheral
+    RDA_XferQueue* queue;   //!< Queue completed transfers are reported to
+    RDA_Xfer* xfer;         //!< Transfer on the bus
+    uint8_t phase;          //!< Register address, restart or data phase
+    uint8_t index;          //!< Data byte index
+    uint8_t count;          //!< Data bytes in the transfer
+    IRQn_Type eventIRQ;     //!< I2Cx_EV_IRQn
+    IRQn_Type errorIRQ;     //!< I2Cx_ER_IRQn
+} RDA_XferSTM32;
+
+/**
+ * @ingroup GA04
+ * @brief Interrupt driven port operations for the transfer engine
+ */
+extern const RDA_XferPort RDA_XferPortSTM32;
+
+/**
+ * @ingroup GA04
+ * @brief Init the interrupt driven port of an I2C peripheral
+ * @details The application enables the event and error IRQs in the NVIC and calls the two
+ * @details IRQ functions below from I2Cx_EV_IRQHandler and I2Cx_ER_IRQHandler.
+ * @param port Port state
+ * @param I2Cx I2C Port
+ * @param queue Transfer queue, see RDA_GetXferQueue
+ */
+void RDA_XferSTM32Init(RDA_XferSTM32* port, I2C_TypeDef* I2Cx, RDA_XferQueue* queue);
+
+/**
+ * @ingroup GA04
+ * @brief I2C event interrupt, call from I2Cx_EV_IRQHandler
+ * @param port Port state
+ */
+void RDA_XferSTM32EventIRQ(RDA_XferSTM32* port);
+
+/**
+ * @ingroup GA04
+ * @brief I2C error interrupt, call from I2Cx_ER_IRQHandler
+ * @param port Port state
+ */
+void RDA_XferSTM32ErrorIRQ(RDA_XferSTM32* port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_XFER_STM32_H */
@@ -0,0 +1,643 @@
+#include <RDA_Sim.h>
+#include <stdio.h>
+#include <string.h>
+
+// Band limits and channel spacing in kHz, indexed by BAND and SPACE of REG03
+static const uint32_t simBandStart[] = {87000, 76000, 76000, 65000};
+static const uint32_t simBandEnd[] = {108000, 91000, 108000, 76000};
+static const uint32_t simSpace[] = {100, 200, 50, 25};
+
+/*
+ * Power-on values of the writable registers
+ */
+static void simReset(RDA_Sim* sim)
+{
+    memset(sim->reg, 0, sizeof(sim->reg));
+    sim->reg[REG00] = SIM_CHIP_ID;
+    sim->reg[REG05] = 0x880F;
+    sim->reg[REG07] = 0x4202;
+    sim->pointer = REG00;
+    sim->busy = FALSE;
+    sim->current = NULL;
+    sim->rdsGroup = 0;
+    sim->rdsUnread = FALSE;
+    RDA_HAL_AlarmStop(&sim->stcAlarm);
+}
+
+static uint32_t simStart(RDA_Sim* sim)
+{
+    RDA_Reg03 reg03 = {.raw = sim->reg[REG03]};
+    RDA_Reg07 reg07 = {.raw = sim->reg[REG07]};
+
+    if (reg03.refined.BAND == RDA_FM_BAND_SPECIAL && !reg07.refined.MODE_50_60)
+    {
+        return 50000;
+    }
+    return simBandStart[reg03.refined.BAND];
+}
+
+static uint32_t simChannelToFrequency(RDA_Sim* sim, uint16_t channel)
+{
+    RDA_Reg03 reg03 = {.raw = sim->reg[REG03]};
+
+    return simStart(sim) + (uint32_t)channel * simSpace[reg03.refined.SPACE];
+}
+
+static uint16_t simLastChannel(RDA_Sim* sim)
+{
+    RDA_Reg03 reg03 = {.raw = sim->reg[REG03]};
+
+    return (simBandEnd[reg03.refined.BAND] - simStart(sim)) / simSpace[reg03.refined.SPACE];
+}
+
+/*
+ * Gets the transmitter heard on a channel, NULL on noise
+ */
+static const RDA_SimStation* simStationAt(RDA_Sim* sim, uint16_t channel)
+{
+    RDA_Reg03 reg03 = {.raw = sim->reg[REG03]};
+    uint32_t frequency = simChannelToFrequency(sim, channel);
+    uint32_t half = simSpace[reg03.refined.SPACE] / 2;
+    uint8_t i;
+
+    for (i = 0; i < sim->stationCount; i++)
+    {
+        if (sim->stations[i].frequency + half > frequency && sim->stations[i].frequency < frequency + half + 1)
+        {
+            return &sim->stations[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Walks the band like the chip does: one channel per step, stops on a station above SEEKTH.
+ * Returns the number of channels passed.
+ */
+static uint16_t simSeek(RDA_Sim* sim, uint16_t from)
+{
+    RDA_Reg02 reg02 = {.raw = sim->reg[REG02]};
+    RDA_Reg05 reg05 = {.raw = sim->reg[REG05]};
+    uint16_t last = simLastChannel(sim);
+    uint16_t channel = from;
+    const RDA_SimStation* station;
+    uint16_t steps = 0;
+
+    sim->seekFail = TRUE;
+    do
+    {
+        if (reg02.refined.SEEKUP)
+        {
+            if (channel == last)
+            {
+                if (reg02.refined.SKMODE == RDA_SEEK_STOP)
+                {
+                    break;
+                }
+                channel = 0;
+            }
+            else
+            {
+                channel++;
+            }
+        }
+        else
+        {
+            if (channel == 0)
+            {
+                if (reg02.refined.SKMODE == RDA_SEEK_STOP)
+                {
+                    break;
+                }
+                channel = last;
+            }
+            else
+            {
+                channel--;
+            }
+        }
+        steps++;
+        station = simStationAt(sim, channel);
+        if (station && station->rssi > reg05.refined.SEEKTH)
+        {
+            sim->seekFail = FALSE;
+            break;
+        }
+    } while (channel != from);
+
+    sim->targetChannel = channel;
+    return steps;
+}
+
+/*
+ * AF code of a frequency in kHz
+ */
+static uint8_t simAFCode(uint32_t frequency)
+{
+    return (uint8_t)((frequency - 87500) / 100);
+}
+
+/*
+ * Builds RDS group n of the current station: 0A (PS) and 2A (RT) groups alternate
+ */
+static void simRdsGroup(RDA_Sim* sim, uint32_t n)
+{
+    const RDA_SimStation* station = sim->current;
+    uint16_t blockB = (station->tp ? 0x0400 : 0) | ((uint16_t)(station->pty & 0x1F) << 5);
+    uint8_t segments = 0;
+    uint8_t length = 0;
+    uint8_t text[4];
+    uint8_t segment;
+    uint32_t group;
+    uint8_t afs;
+    uint8_t pair;
+    uint8_t i;
+
+    if (station->rt)
+    {
+        // A text shorter than 64 characters ends with a carriage return
+        length = strlen(station->rt);
+        segments = (length < 64) ? (length + 4) / 4 : 16;
+    }
+    sim->reg[REG0C] = station->pi;
+    if (segments && (n & 1))
+    {
+        segment = (n / 2) % segments;
+        for (i = 0; i < 4; i++)
+        {
+            text[i] = (4 * segment + i < length) ? station->rt[4 * segment + i] : (4 * segment + i == length) ? 0x0D : ' ';
+        }
+        sim->reg[REG0D] = 0x2000 | blockB | segment;
+        sim->reg[REG0E] = ((uint16_t)text[0] << 8) | text[1];
+        sim->reg[REG0F] = ((uint16_t)text[2] << 8) | text[3];
+    }
+    else
+    {
+        group = segments ? n / 2 : n;
+        segment = group % 4;
+        // Music, block C carries the AF list: count and first AF, then two AFs per group
+        sim->reg[REG0D] = blockB | 0x0008 | segment;
+        sim->reg[REG0E] = 0xE0CD;
+        for (afs = 0; station->af && station->af[afs]; afs++);
+        if (afs)
+        {
+            pair = group % (1 + afs / 2);
+            if (pair == 0)
+            {
+                sim->reg[REG0E] = ((uint16_t)(224 + afs) << 8) | simAFCode(station->af[0]);
+            }
+            else
+            {
+                sim->reg[REG0E] = ((uint16_t)simAFCode(station->af[2 * pair - 1]) << 8) |
+                                  ((2 * pair < afs) ? simAFCode(station->af[2 * pair]) : 205);
+            }
+        }
+        sim->reg[REG0F] = ((uint16_t)station->ps[2 * segment] << 8) | (uint8_t)station->ps[2 * segment + 1];
+    }
+}
+
+/*
+ * Fading of the current station: a repeatable level per SIM_FADE_TIME slot
+ */
+static int8_t simFade(RDA_Sim* sim, uint32_t now)
+{
+    uint32_t x = (now / SIM_FADE_TIME) * 2654435761u ^ sim->current->frequency;
+
+    x ^= x >> 15;
+    return (int8_t)((x >> 8) % (2 * SIM_FADE_DEPTH + 1)) - SIM_FADE_DEPTH;
+}
+
+/*
+ * Completes a pending tune or seek once its time has come and delivers RDS groups
+ */
+static void simUpdate(RDA_Sim* sim)
+{
+    RDA_Reg02 reg02 = {.raw = sim->reg[REG02]};
+    RDA_Reg03 reg03 = {.raw = sim->reg[REG03]};
+    RDA_Reg0A reg0A = {.raw = sim->reg[REG0A]};
+    RDA_Reg0B reg0B = {.raw = sim->reg[REG0B]};
+    uint32_t now = getMillis();
+    uint32_t due;
+    int8_t fade = 0;
+
+    if (sim->busy && (int32_t)(now - sim->doneAt) >= 0)
+    {
+        sim->busy = FALSE;
+        reg0A.refined.STC = 1;
+        reg0A.refined.READCHAN = sim->targetChannel;
+        if (reg02.refined.SEEK)
+        {
+            reg0A.refined.SF = sim->seekFail;
+            reg02.refined.SEEK = 0;
+        }
+        reg03.refined.TUNE = 0;
+        sim->current = simStationAt(sim, sim->targetChannel);
+        sim->tunedAt = sim->doneAt;
+        sim->rdsGroup = 0;
+        sim->rdsUnread = FALSE;
+    }
+
+    reg0B.refined.FM_READY = reg02.refined.ENABLE && (int32_t)(now - sim->readyAt) >= 0;
+    if (sim->busy || !reg0B.refined.FM_READY)
+    {
+        reg0B.refined.RSSI = 0;
+        reg0B.refined.FM_TRUE = 0;
+        reg0A.refined.ST = 0;
+    }
+    else
+    {
+        fade = sim->current ? simFade(sim, now) : 0;
+        reg0B.refined.RSSI = sim->current ? sim->current->rssi + fade : SIM_NOISE_RSSI;
+        reg0B.refined.FM_TRUE = (sim->current != NULL);
+        reg0A.refined.ST = sim->current && sim->current->stereo && !reg02.refined.MONO;
+    }
+
+    reg0A.refined.RDSS = 0;
+    if (!sim->busy && reg02.refined.RDS_EN && sim->current && sim->current->pi)
+    {
+        due = (now - sim->tunedAt) * SIM_RDS_GROUP_RATE / 10000;
+        if (due > sim->rdsGroup)
+        {
+            // Groups not read in time are overwritten by the newest one
+            sim->stats.rdsLost += due - sim->rdsGroup - (sim->rdsUnread ? 0 : 1);
+            sim->stats.rdsGroups += due - sim->rdsGroup;
+            simRdsGroup(sim, due - 1);
+            sim->rdsGroup = due;
+            sim->rdsUnread = TRUE;
+        }
+        reg0A.refined.RDSS = (sim->rdsGroup > 0);
+    }
+    reg0A.refined.RDSR = sim->rdsUnread;
+    // Deep fades corrupt some blocks
+    reg0B.refined.BLERA = (fade <= -SIM_FADE_DEPTH) ? 1 : 0;
+    reg0B.refined.BLERB = (fade <= -SIM_FADE_DEPTH + 2) ? 1 : 0;
+    reg0B.refined.ABCD_E = 0;
+
+    sim->reg[REG02] = reg02.raw;
+    sim->reg[REG03] = reg03.raw;
+    sim->reg[REG0A] = reg0A.raw;
+    sim->reg[REG0B] = reg0B.raw;
+}
+
+/*
+ * End of a tune or seek: STC is set and GPIO2 pulses low when the interrupt is enabled
+ */
+static void simComplete(RDA_HAL_Alarm* alarm)
+{
+    RDA_Sim* sim = alarm->context;
+    RDA_Reg04 reg04 = {.raw = sim->reg[REG04]};
+
+    simUpdate(sim);
+    if (sim->irq && reg04.refined.STCIEN && reg04.refined.GPIO2 == 1)
+    {
+        sim->stats.interrupts++;
+        sim->irq(sim->irqContext);
+    }
+}
+
+/*
+ * Reacts to a register written by the driver
+ */
+static void simWriteRegister(RDA_Sim* sim, uint8_t reg, uint16_t value)
+{
+    RDA_Reg02 reg02;
+    RDA_Reg03 reg03;
+    RDA_Reg04 reg04;
+    RDA_Reg0A reg0A;
+    uint32_t duration;
+
+    if (reg < REG02 || reg > REG07)
+    {
+        return; // Read only
+    }
+    reg02.raw = sim->reg[REG02];
+    if (reg == REG02 && !reg02.refined.ENABLE && (value & 0x0001))
+    {
+        // ENABLE starts the crystal oscillator
+        sim->readyAt = getMillis() + SIM_OSC_SETTLE;
+    }
+    sim->reg[reg] = value;
+    reg02.raw = sim->reg[REG02];
+    reg03.raw = sim->reg[REG03];
+    reg0A.raw = sim->reg[REG0A];
+
+    if (reg == REG02 && reg02.refined.SOFT_RESET)
+    {
+        simReset(sim);
+        return;
+    }
+    if (sim->busy || !reg02.refined.ENABLE)
+    {
+        return;
+    }
+    if (reg == REG02 && reg02.refined.SEEK)
+    {
+        sim->stats.seeks++;
+        duration = (uint32_t)simSeek(sim, reg0A.refined.READCHAN) * SIM_SEEK_STEP_TIME;
+    }
+    else if (reg == REG03 && reg03.refined.TUNE)
+    {
+        sim->stats.tunes++;
+        sim->targetChannel = (reg03.refined.CHAN > simLastChannel(sim)) ? simLastChannel(sim) : reg03.refined.CHAN;
+        duration = sim->tuneTime;
+    }
+    else
+    {
+        return;
+    }
+    reg0A.refined.STC = 0;
+    reg0A.refined.SF = 0;
+    reg0A.refined.RDSR = 0;
+    sim->reg[REG0A] = reg0A.raw;
+    sim->current = NULL;
+    sim->rdsUnread = FALSE;
+    sim->busy = TRUE;
+    // A tune requested before the oscillator is stable starts once it is
+    sim->doneAt = ((int32_t)(getMillis() - sim->readyAt) < 0 ? sim->readyAt : getMillis()) + duration;
+    reg04.raw = sim->reg[REG04];
+    if (sim->irq && reg04.refined.STCIEN && reg04.refined.GPIO2 == 1)
+    {
+        RDA_HAL_AlarmStart(&sim->stcAlarm, sim->doneAt * 1000 - getMicros(), simComplete, sim);
+    }
+}
+
+/*
+ * Accounts a START..STOP sequence: address and data bytes with their ACK bit, plus START and STOP
+ */
+static void simBus(RDA_Sim* sim, uint32_t bytes)
+{
+    uint32_t bits = bytes * 9 + 2;
+
+    sim->stats.transactions++;
+    sim->stats.bytes += bytes;
+    sim->stats.bits += bits;
+    RDA_HAL_AdvanceMicros((uint32_t)((uint64_t)bits * 1000000 / sim->busSpeed));
+}
+
+/*
+ * Fails a transfer with the injected fault, RDA_XFER_OK when there is none
+ */
+static RDA_XferStatus simFault(RDA_Sim* sim)
+{
+    RDA_XferStatus status;
+
+    if (sim->fault == SIM_FAULT_NONE)
+    {
+        return RDA_XFER_OK;
+    }
+    sim->stats.faults++;
+    if (sim->fault == SIM_FAULT_NACK)
+    {
+        // The address byte is not acknowledged, STOP
+        simBus(sim, 1);
+        status = RDA_XFER_NACK;
+    }
+    else
+    {
+        // START or the address never completes, the HAL gives up after its event budget
+        sim->stats.transactions++;
+        RDA_HAL_Advance(RDA_I2C_TIMEOUT + 1);
+        status = RDA_XFER_TIMEOUT;
+    }
+    if (sim->fault != SIM_FAULT_SDA_STUCK && --sim->faultCount == 0)
+    {
+        sim->fault = SIM_FAULT_NONE;
+    }
+    return status;
+}
+
+static void simRecover(void* device)
+{
+    RDA_Sim* sim = device;
+
+    sim->stats.recoveries++;
+    RDA_HAL_AdvanceMicros((uint32_t)((uint64_t)SIM_RECOVER_CLOCKS * 1000000 / sim->busSpeed));
+    if (sim->fault == SIM_FAULT_SDA_STUCK)
+    {
+        sim->fault = SIM_FAULT_NONE;
+    }
+}
+
+static RDA_XferStatus simWrite(void* device, uint8_t address, uint8_t reg, const uint16_t* data, uint8_t length)
+{
+    RDA_Sim* sim = device;
+    RDA_XferStatus fault = simFault(sim);
+    uint8_t i;
+
+    if (fault != RDA_XFER_OK)
+    {
+        return fault;
+    }
+    if (address == I2C_ADDR_FULL_ACCESS)
+    {
+        // Sequential writes always start at REG02
+        reg = REG02;
+        simBus(sim, 1 + 2 * length);
+    }
+    else if (address != I2C_ADDR_DIRECT_ACCESS || reg == RDA_XFER_NO_REG)
+    {
+        simBus(sim, 1);
+        return RDA_XFER_NACK;
+    }
+    else
+    {
+        simBus(sim, 2 + 2 * length);
+    }
+    simUpdate(sim);
+    sim->pointer = reg;
+    for (i = 0; i < length; i++)
+    {
+        simWriteRegister(sim, (reg + i) & 0x0F, data[i]);
+    }
+    simUpdate(sim);
+    return RDA_XFER_OK;
+}
+
+static RDA_XferStatus simRead(void* device, uint8_t address, uint8_t reg, uint16_t* data, uint8_t length)
+{
+    RDA_Sim* sim = device;
+    RDA_XferStatus fault = simFault(sim);
+    uint8_t i;
+
+    if (fault != RDA_XFER_OK)
+    {
+        return fault;
+    }
+    if (address == I2C_ADDR_FULL_ACCESS)
+    {
+        // Sequential reads always start at REG0A
+        reg = REG0A;
+    }
+    else if (address != I2C_ADDR_DIRECT_ACCESS)
+    {
+        simBus(sim, 1);
+        return RDA_XFER_NACK;
+    }
+    else if (reg == RDA_XFER_NO_REG)
+    {
+        reg = sim->pointer;
+    }
+    else
+    {
+        // Register pointer write, STOP, then the read
+        simBus(sim, 2);
+    }
+    simBus(sim, 1 + 2 * length);
+    simUpdate(sim);
+    for (i = 0; i < length; i++)
+    {
+        data[i] = sim->reg[(reg + i) & 0x0F];
+        if (((reg + i) & 0x0F) == REG0C)
+        {
+            sim->rdsUnread = FALSE;
+        }
+    }
+    return RDA_XFER_OK;
+}
+
+/*
+ * Interrupt of the host port: runs the transfer on the bus and reports it
+ */
+static void portInterrupt(RDA_HAL_Alarm* alarm)
+{
+    RDA_SimPort* port = alarm->context;
+    RDA_Xfer* xfer = port->xfer;
+    RDA_XferStatus status;
+
+    if (port->locked)
+    {
+        // Masked, pending until unlock
+        RDA_HAL_AlarmStart(&port->alarm, SIM_PORT_LATENCY, portInterrupt, port);
+        return;
+    }
+    if (port->lose)
+    {
+        port->lose--;
+        return;
+    }
+    if (xfer->direction == RDA_XFER_WRITE)
+    {
+        status = RDA_HAL_Write(port->bus, xfer->address, xfer->reg, xfer->data, xfer->length);
+    }
+    else
+    {
+        status = RDA_HAL_Read(port->bus, xfer->address, xfer->reg, xfer->data, xfer->length);
+    }
+    port->xfer = NULL;
+    RDA_XferComplete(port->queue, status);
+}
+
+static void portStart(void* context, RDA_Xfer* xfer)
+{
+    RDA_SimPort* port = context;
+
+    port->xfer = xfer;
+    port->started++;
+    RDA_HAL_AlarmStart(&port->alarm, SIM_PORT_LATENCY, portInterrupt, port);
+}
+
+static void portLock(void* context)
+{
+    ((RDA_SimPort*)context)->locked++;
+}
+
+static void portUnlock(void* context)
+{
+    ((RDA_SimPort*)context)->locked--;
+}
+
+static void portAbort(void* context)
+{
+    RDA_SimPort* port = context;
+
+    RDA_HAL_AlarmStop(&port->alarm);
+    port->xfer = NULL;
+    port->aborted++;
+}
+
+const RDA_XferPort RDA_SimPortOps = {portStart, portLock, portUnlock, portAbort};
+
+void RDA_SimPortInit(RDA_SimPort* port, RDA_BusTypeDef* bus, RDA_XferQueue* queue)
+{
+    RDA_HAL_AlarmStop(&port->alarm);
+    memset(port, 0, sizeof(*port));
+    port->bus = bus;
+    port->queue = queue;
+}
+
+void RDA_SimPortLose(RDA_SimPort* port, uint8_t count)
+{
+    port->lose = count;
+}
+
+void RDA_SimInit(RDA_Sim* sim, RDA_BusTypeDef* bus)
+{
+    // The model may be re-initialised with a completion pending
+    RDA_HAL_AlarmStop(&sim->stcAlarm);
+    memset(sim, 0, sizeof(*sim));
+    sim->busSpeed = SIM_BUS_SPEED;
+    sim->tuneTime = SIM_TUNE_TIME;
+    simReset(sim);
+    bus->write = simWrite;
+    bus->read = simRead;
+    bus->recover = simRecover;
+    bus->device = sim;
+}
+
+void RDA_SimSetStations(RDA_Sim* sim, const RDA_SimStation* stations, uint8_t count)
+{
+    sim->stations = stations;
+    sim->stationCount = count;
+}
+
+void RDA_SimSetBusSpeed(RDA_Sim* sim, uint32_t hz)
+{
+    sim->busSpeed = hz;
+}
+
+void RDA_SimSetTuneTime(RDA_Sim* sim, uint32_t ms)
+{
+    sim->tuneTime = ms;
+}
+
+void RDA_SimBrownOut(RDA_Sim* sim)
+{
+    simReset(sim);
+}
+
+void RDA_SimSetIRQ(RDA_Sim* sim, void (*irq)(void* context), void* context)
+{
+    sim->irq = irq;
+    sim->irqContext = context;
+    if (!irq)
+    {
+        RDA_HAL_AlarmStop(&sim->stcAlarm);
+    }
+}
+
+void RDA_SimInjectFault(RDA_Sim* sim, uint8_t fault, uint8_t count)
+{
+    sim->fault = (count || fault == SIM_FAULT_SDA_STUCK) ? fault : SIM_FAULT_NONE;
+    sim->faultCount = count;
+}
+
+uint32_t RDA_SimGetFrequency(RDA_Sim* sim)
+{
+    RDA_Reg0A reg0A = {.raw = sim->reg[REG0A]};
+
+    return simChannelToFrequency(sim, reg0A.refined.READCHAN);
+}
+
+void RDA_SimReport(RDA_Sim* sim)
+{
+    RDA_SimStats* stats = &sim->stats;
+
+    printf("run time      %u ms\n", getMillis());
+    printf("transactions  %u\n", stats->transactions);
+    printf("bytes         %u\n", stats->bytes);
+    printf("bus @100kHz   %u us\n", (uint32_t)((uint64_t)stats->bits * 1000000 / 100000));
+    printf("bus @400kHz   %u us\n", (uint32_t)((uint64_t)stats->bits * 1000000 / 400000));
+    printf("cpu waiting   %u ms\n", RDA_HAL_GetWaitMillis());
+    printf("tunes/seeks   %u/%u\n", stats->tunes, stats->seeks);
+    printf("rds groups    %u (%u lost)\n", stats->rdsGroups, stats->rdsLost);
+}
@@ -0,0 +1,215 @@
+#ifndef __RDA_SIM_H
+#define __RDA_SIM_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <RDA_5807.h>
+
+#define SIM_CHIP_ID         0x5804  //!< REG00 of a RDA5807M
+#define SIM_TUNE_TIME       10      //!< Default ms from TUNE to STC
+#define SIM_OSC_SETTLE      120     //!< ms from ENABLE until the crystal oscillator is stable (FM_READY)
+#define SIM_SEEK_STEP_TIME  8       //!< ms a seek spends on every channel it passes
+#define SIM_NOISE_RSSI      4       //!< RSSI of a channel without station
+#define SIM_RDS_GROUP_RATE  114     //!< RDS groups per 10 s (11.4 groups/s)
+#define SIM_BUS_SPEED       100000  //!< Default I2C clock in Hz
+#define SIM_FADE_DEPTH      6       //!< RSSI of a station varies by up to this much either way
+#define SIM_FADE_TIME       100     //!< ms the RSSI stays at one fading level
+#define SIM_RECOVER_CLOCKS  10      //!< SCL cycles of a bus recovery: 9 clocks and a STOP
+#define SIM_PORT_LATENCY    20      //!< µs from the start of a transfer on the interrupt port until its interrupt
+
+#define SIM_FAULT_NONE      0       //!< The bus works
+#define SIM_FAULT_NACK      1       //!< The chip does not acknowledge its address
+#define SIM_FAULT_TIMEOUT   2       //!< A bus event never comes, the HAL waits out RDA_I2C_TIMEOUT
+#define SIM_FAULT_SDA_STUCK 3       //!< The chip holds SDA low, every transfer times out until a bus recovery
+
+/**
+ * @ingroup GA06
+ * @brief A transmitter of the simulated band
+ */
+typedef struct
+{
+    uint32_t frequency;     //!< kHz
+    uint8_t rssi;           //!< 0 to 127
+    BOOL stereo;            //!< Stereo pilot present
+    uint16_t pi;            //!< RDS program identification, 0 = no RDS
+    uint8_t pty;            //!< RDS program type
+    BOOL tp;                //!< RDS traffic program
+    const char* ps;         //!< RDS program service name, 8 characters
+    const char* rt;         //!< RDS radiotext, up to 64 characters, may be NULL
+    const uint32_t* af;     //!< AF list sent in groups 0A, kHz, 0 terminated, may be NULL
+} RDA_SimStation;
+
+/**
+ * @ingroup GA06
+ * @brief Bus and chip activity counters of a run
+ */
+typedef struct
+{
+    uint32_t transactions;  //!< START to STOP sequences
+    uint32_t bytes;         //!< Bytes on the wire, address bytes included
+    uint32_t bits;          //!< Clock cycles on the wire, START/STOP and ACK included
+    uint32_t tunes;         //!< Tunes started
+    uint32_t seeks;         //!< Seeks started
+    uint32_t rdsGroups;     //!< RDS groups received by the chip
+    uint32_t rdsLost;       //!< RDS groups overwritten before the driver read them
+    uint32_t faults;        //!< Transfers failed by an injected fault
+    uint32_t recoveries;    //!< Bus recoveries
+    uint32_t interrupts;    //!< Seek/tune complete pulses on GPIO2
+} RDA_SimStats;
+
+/**
+ * @ingroup GA06
+ * @brief Register level model of the RDA5807 behind the host bus
+ * @details Timing follows the virtual clock of the Linux HAL; every transfer advances it by its bus time.
+ */
+typedef struct RDA_Sim
+{
+    uint16_t reg[0x10];                 //!< Register file, REG00 to REG0F
+    uint8_t pointer;                    //!< Register pointer of the direct access address
+    BOOL busy;                          //!< Tune or seek in progress
+    uint32_t doneAt;                    //!< Virtual ms the pending tune or seek completes
+    uint16_t targetChannel;             //!< Channel the pending tune or seek ends on
+    BOOL seekFail;                      //!< Pending seek ends without a station
+    const RDA_SimStation* stations;     //!< Station map
+    uint8_t stationCount;
+    const RDA_SimStation* current;      //!< Station on the tuned channel, NULL on noise
+    uint32_t tunedAt;                   //!< Virtual ms the current channel locked
+    uint32_t readyAt;                   //!< Virtual ms the oscillator is stable after ENABLE
+    uint32_t rdsGroup;                  //!< Groups received on the current channel
+    BOOL rdsUnread;                     //!< Blocks not read since the last group
+    uint32_t busSpeed;                  //!< I2C clock in Hz
+    uint32_t tuneTime;                  //!< ms from TUNE to STC
+    uint8_t fault;                      //!< Injected bus fault, SIM_FAULT_*
+    uint8_t faultCount;                 //!< Transfers the NACK or timeout fault still hits
+    void (*irq)(void* context);         //!< Handler wired to GPIO2, NULL when the pin is not wired
+    void* irqContext;
+    RDA_HAL_Alarm stcAlarm;             //!< Completion of the pending tune or seek
+    RDA_SimStats stats;
+} RDA_Sim;
+
+/**
+ * @ingroup GA06
+ * @brief Interrupt driven transfer port of the host, the counterpart of RDA_XferSTM32
+ * @details start() only arms an alarm: the transfer runs on the bus and completes from it,
+ * @details SIM_PORT_LATENCY µs later, like from the I2C interrupt. While locked the interrupt waits.
+ */
+typedef struct
+{
+    RDA_BusTypeDef* bus;        //!< Bus the transfers run on
+    RDA_XferQueue* queue;       //!< Queue completed transfers are reported to
+    RDA_Xfer* xfer;             //!< Transfer on the bus
+    RDA_HAL_Alarm alarm;        //!< Interrupt of the transfer on the bus
+    uint8_t locked;             //!< lock() depth
+    uint8_t lose;               //!< Interrupts still to lose
+    uint32_t started;           //!< Transfers started
+    uint32_t aborted;           //!< Transfers aborted
+} RDA_SimPort;
+
+/**
+ * @ingroup GA06
+ * @brief Port operations of RDA_SimPort
+ */
+extern const RDA_XferPort RDA_SimPortOps;
+
+/**
+ * @ingroup GA06
+ * @brief Init the interrupt driven host port of a bus
+ * @param port Port state
+ * @param bus Host bus
+ * @param queue Transfer queue, see RDA_GetXferQueue
+ */
+void RDA_SimPortInit(RDA_SimPort* port, RDA_BusTypeDef* bus, RDA_XferQueue* queue);
+
+/**
+ * @ingroup GA06
+ * @brief Lose the interrupt of the next transfers, they stay on the bus until aborted
+ * @param port Port state
+ * @param count transfers
+ */
+void RDA_SimPortLose(RDA_SimPort* port, uint8_t count);
+
+/**
+ * @ingroup GA06
+ * @brief Power-on reset of the model and hook it to a host bus
+ * @param sim Model
+ * @param bus Host bus the driver is given as I2C port
+ */
+void RDA_SimInit(RDA_Sim* sim, RDA_BusTypeDef* bus);
+
+/**
+ * @ingroup GA06
+ * @brief Set the transmitters of the simulated band
+ * @param sim Model
+ * @param stations station map, must stay valid
+ * @param count number of stations
+ */
+void RDA_SimSetStations(RDA_Sim* sim, const RDA_SimStation* stations, uint8_t count);
+
+/**
+ * @ingroup GA06
+ * @brief Set the I2C clock the bus time is computed with
+ * @param sim Model
+ * @param hz clock in Hz
+ */
+void RDA_SimSetBusSpeed(RDA_Sim* sim, uint32_t hz);
+
+/**
+ * @ingroup GA06
+ * @brief Set the time a tune takes until STC, SIM_TUNE_TIME after RDA_SimInit
+ * @param sim Model
+ * @param ms tune time
+ */
+void RDA_SimSetTuneTime(RDA_Sim* sim, uint32_t ms);
+
+/**
+ * @ingroup GA06
+ * @brief Dip the supply: the chip comes back with its power-on registers, powered down
+ * @param sim Model
+ */
+void RDA_SimBrownOut(RDA_Sim* sim);
+
+/**
+ * @ingroup GA06
+ * @brief Wire GPIO2 to an interrupt
+ * @details With STCIEN set and GPIO2 configured as interrupt output (01) in REG04, the handler
+ * @details runs when a tune or seek completes, at its time on the virtual clock (falling edge).
+ * @details Unwire it before the model goes out of scope.
+ * @param sim Model
+ * @param irq handler, NULL leaves the pin unwired
+ * @param context passed to the handler
+ */
+void RDA_SimSetIRQ(RDA_Sim* sim, void (*irq)(void* context), void* context);
+
+/**
+ * @ingroup GA06
+ * @brief Make the next transfers fail on the bus
+ * @details A NACK or timeout fault hits the next count transfers. A stuck SDA hits every
+ * @details transfer until RDA_HAL_Recover clocks it free.
+ * @param sim Model
+ * @param fault SIM_FAULT_*
+ * @param count transfers, ignored for SIM_FAULT_SDA_STUCK
+ */
+void RDA_SimInjectFault(RDA_Sim* sim, uint8_t fault, uint8_t count);
+
+/**
+ * @ingroup GA06
+ * @brief Get the frequency of the channel the chip is tuned to
+ * @param sim Model
+ * @return uint32_t kHz
+ */
+uint32_t RDA_SimGetFrequency(RDA_Sim* sim);
+
+/**
+ * @ingroup GA06
+ * @brief Print bytes on the wire, bus time at 100/400 kHz and CPU wait time of the run
+ * @param sim Model
+ */
+void RDA_SimReport(RDA_Sim* sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RDA_SIM_H */
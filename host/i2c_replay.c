@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <RDA_5807.h>
+#include <RDA_Trace.h>
+#include <RDA_Sim.h>
+
+#define REPLAY_RING     (1 << 20)   // Bytes of the trace ring of a recording
+#define REPLAY_SEEKS    3           // Seeks up from the first station
+#define REPLAY_SESSION  2000        // ms of the display poll loop
+#define REPLAY_POLL     10          // ms between passes of the poll loop
+#define REPLAY_LOOKAHEAD 64         // Records the diff looks ahead to realign the streams
+#define REPLAY_LIST     10          // Differences listed by the diff
+
+/*
+ * A transfer of a trace
+ */
+typedef struct
+{
+    uint32_t time;          // us the transfer started
+    uint8_t address;
+    uint8_t flags;          // RDA_TRACE_READ and the status
+    uint8_t reg;
+    uint8_t length;
+    uint16_t data[255];
+} ReplayRecord;
+
+static const RDA_SimStation stations[] = {
+    { 89100, 38, TRUE,  0xD318, 10, FALSE, "RADIO 1 ", "The best mix of the 80s, 90s and today"},
+    { 94800, 22, FALSE, 0,      0,  FALSE, NULL,       NULL},
+    {101300, 45, TRUE,  0xD3C2, 3,  TRUE,  "INFO FM ", "Traffic and news every 30 minutes"},
+    {104000, 51, TRUE,  0xD201, 5,  FALSE, "CLASSIC ", "Bach: Goldberg Variations"},
+    {106700, 30, TRUE,  0xD4A7, 15, FALSE, "JAZZ 106", "Late night jazz"},
+};
+
+static const uint32_t speeds[] = {100000, 400000};
+
+/*
+ * Dump sink of RDA_TraceDump
+ */
+static void fileWrite(void* context, const uint8_t* data, uint32_t length)
+{
+    fwrite(data, 1, length, context);
+}
+
+/*
+ * Reads a dump, returns the records (free them) or NULL
+ */
+static ReplayRecord* loadTrace(const char* path, uint32_t* count)
+{
+    FILE* input = fopen(path, "rb");
+    ReplayRecord* records = NULL;
+    ReplayRecord* record;
+    uint8_t header[RDA_TRACE_HEADER];
+    uint8_t bytes[2 * 255];
+    uint32_t size = 0;
+    uint8_t i;
+
+    *count = 0;
+    if (!input)
+    {
+        perror(path);
+        return NULL;
+    }
+    if (fread(header, 1, RDA_TRACE_HEADER, input) != RDA_TRACE_HEADER || memcmp(header, "RDAT", 4) ||
+        header[4] != RDA_TRACE_VERSION || header[5] != RDA_TRACE_RECORD)
+    {
+        fprintf(stderr, "%s: not a version %u trace\n", path, RDA_TRACE_VERSION);
+        fclose(input);
+        return NULL;
+    }
+    while (fread(bytes, 1, RDA_TRACE_RECORD, input) == RDA_TRACE_RECORD)
+    {
+        if (*count == size)
+        {
+            size = size ? 2 * size : 1024;
+            records = realloc(records, size * sizeof(ReplayRecord));
+        }
+        record = &records[*count];
+        record->time = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+        record->address = bytes[4];
+        record->flags = bytes[5];
+        record->reg = bytes[6];
+        record->length = bytes[7];
+        if (fread(bytes, 2, record->length, input) != record->length)
+        {
+            fprintf(stderr, "%s: record %u cut short\n", path, *count);
+            break;
+        }
+        for (i = 0; i < record->length; i++)
+        {
+            record->data[i] = bytes[2 * i] | bytes[2 * i + 1] << 8;
+        }
+        (*count)++;
+    }
+    fclose(input);
+    if (!records)
+    {
+        records = malloc(sizeof(ReplayRecord));
+    }
+    return records;
+}
+
+/*
+ * Clock cycles of a transfer on the wire, as the chip model counts them: address byte and
+ * data, a read at a register address writes the address in a transaction of its own
+ */
+static uint32_t recordBits(const ReplayRecord* record)
+{
+    uint32_t bits = (1 + 2 * record->length) * 9 + 2;
+
+    if (record->reg != RDA_XFER_NO_REG)
+    {
+        bits += (record->flags & RDA_TRACE_READ) ? 2 * 9 + 2 : 9;
+    }
+    return bits;
+}
+
+static void printRecord(const char* prefix, const ReplayRecord* record)
+{
+    uint8_t i;
+
+    printf("%s%10u us  %02X %c ", prefix, record->time, record->address,
+           (record->flags & RDA_TRACE_READ) ? 'R' : 'W');
+    if (record->reg == RDA_XFER_NO_REG)
+    {
+        printf("  --");
+    }
+    else
+    {
+        printf("  %02X", record->reg);
+    }
+    printf("  status %u ", RDA_TRACE_STATUS(record->flags));
+    for (i = 0; i < record->length; i++)
+    {
+        printf(" %04X", record->data[i]);
+    }
+    printf("\n");
+}
+
+/*
+ * Same transfer: address, direction, register, length and for writes the words
+ */
+static BOOL sameTransfer(const ReplayRecord* a, const ReplayRecord* b)
+{
+    return a->address == b->address && (a->flags & RDA_TRACE_READ) == (b->flags & RDA_TRACE_READ) &&
+           a->reg == b->reg && a->length == b->length &&
+           ((a->flags & RDA_TRACE_READ) || !memcmp(a->data, b->data, a->length * sizeof(a->data[0])));
+}
+
+/*
+ * Runs the session of the tool against the chip model and dumps its bus traffic
+ */
+static int record(const char* path, int window)
+{
+    static uint8_t buffer[REPLAY_RING];
+    RDA_Trace trace;
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_RDS rds;
+    FILE* output;
+    uint32_t end;
+    uint8_t i;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_TraceInit(&trace, buffer, sizeof(buffer));
+    RDA_TraceAttach(&trace);
+
+    RDA_Init(&radio, &bus);
+    if (window >= 0)
+    {
+        RDA_SetCacheWindow(&radio, window);
+    }
+    RDA_BeginUpdate(&radio);
+    RDA_SetBass(&radio, TRUE);
+    RDA_SetVolume(&radio, 15);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_CommitUpdate(&radio);
+    RDA_Tune(&radio, 89100);
+    for (i = 0; i < REPLAY_SEEKS; i++)
+    {
+        RDA_SeekAsync(&radio, RDA_SEEK_WRAP, RDA_SEEK_UP, NULL);
+        while (RDA_TunePoll(&radio) == RDA_TUNE_IN_PROGRESS)
+        {
+            RDA_HAL_Idle();
+        }
+    }
+    RDA_RDSInit(&rds);
+    end = getMillis() + REPLAY_SESSION;
+    while ((int32_t)(getMillis() - end) < 0)
+    {
+        RDA_GetRealFrequency(&radio);
+        RDA_GetQuality(&radio);
+        RDA_GetSterioStatus(&radio);
+        if (RDA_GetRDSReady(&radio))
+        {
+            RDA_ReadRDS(&radio, &rds);
+        }
+        Delay(REPLAY_POLL);
+    }
+    RDA_TraceAttach(NULL);
+
+    if (!(output = fopen(path, "wb")))
+    {
+        perror(path);
+        return 1;
+    }
+    RDA_TraceDump(&trace, fileWrite, output);
+    fclose(output);
+    printf("%s: %u transfers, %u dropped, %u transactions on the chip, PS \"%s\"\n", path, trace.records,
+           trace.dropped, sim.stats.transactions, rds.ps);
+    return 0;
+}
+
+static int show(const char* path)
+{
+    ReplayRecord* records;
+    uint32_t count;
+    uint32_t i;
+
+    if (!(records = loadTrace(path, &count)))
+    {
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        printRecord("", &records[i]);
+    }
+    free(records);
+    return 0;
+}
+
+/*
+ * Puts the transfers of a trace on the bus of a fresh chip model at their recorded times,
+ * returns the transfers whose status or read words differ from the recording
+ */
+static int play(const char* path)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    ReplayRecord* records;
+    ReplayRecord* record;
+    uint16_t data[255];
+    RDA_XferStatus status;
+    uint32_t mismatches = 0;
+    uint32_t count;
+    uint32_t i;
+
+    if (!(records = loadTrace(path, &count)))
+    {
+        return 1;
+    }
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    for (i = 0; i < count; i++)
+    {
+        record = &records[i];
+        if ((int32_t)(record->time - getMicros()) > 0)
+        {
+            RDA_HAL_AdvanceMicros(record->time - getMicros());
+        }
+        if (record->flags & RDA_TRACE_READ)
+        {
+            status = RDA_HAL_Read(&bus, record->address, record->reg, data, record->length);
+        }
+        else
+        {
+            status = RDA_HAL_Write(&bus, record->address, record->reg, record->data, record->length);
+        }
+        if (status != RDA_TRACE_STATUS(record->flags) ||
+            ((record->flags & RDA_TRACE_READ) && memcmp(data, record->data, record->length * sizeof(data[0]))))
+        {
+            if (mismatches++ < REPLAY_LIST)
+            {
+                printRecord("recorded ", record);
+                record->flags = (record->flags & RDA_TRACE_READ) | (status << 1);
+                memcpy(record->data, data, record->length * sizeof(data[0]));
+                printRecord("replayed ", record);
+            }
+        }
+    }
+    printf("%s: %u transfers replayed, %u transactions, ended on %u kHz, %u mismatches\n", path, count,
+           sim.stats.transactions, RDA_SimGetFrequency(&sim), mismatches);
+    free(records);
+    return mismatches != 0;
+}
+
+static void printBusTime(uint64_t bitsA, uint64_t bitsB, uint32_t hz)
+{
+    uint64_t usA = bitsA * 1000000 / hz;
+    uint64_t usB = bitsB * 1000000 / hz;
+
+    printf("bus time at %6u Hz: %8llu us / %8llu us, %+lld us (%+.1f%%)\n", hz, (unsigned long long)usA,
+           (unsigned long long)usB, (long long)usB - (long long)usA, usA ? ((double)usB - usA) * 100 / usA : 0.0);
+}
+
+/*
+ * Aligns two traces and reports the transfers only one of them has, the reads that returned
+ * other words and the bus time of both
+ */
+static int diff(const char* pathA, const char* pathB, uint32_t hz)
+{
+    ReplayRecord* a;
+    ReplayRecord* b;
+    uint32_t countA, countB;
+    uint32_t i = 0, j = 0;
+    uint32_t k, m;
+    uint32_t equal = 0, onlyA = 0, onlyB = 0, data = 0, listed = 0;
+    uint64_t bitsA = 0, bitsB = 0;
+    uint8_t s;
+
+    a = loadTrace(pathA, &countA);
+    b = loadTrace(pathB, &countB);
+    if (!a || !b)
+    {
+        free(a);
+        free(b);
+        return 1;
+    }
+    for (i = 0; i < countA; i++)
+    {
+        bitsA += recordBits(&a[i]);
+    }
+    for (j = 0; j < countB; j++)
+    {
+        bitsB += recordBits(&b[j]);
+    }
+
+    i = 0;
+    j = 0;
+    while (i < countA || j < countB)
+    {
+        if (i < countA && j < countB && sameTransfer(&a[i], &b[j]))
+        {
+            if (memcmp(a[i].data, b[j].data, a[i].length * sizeof(a[i].data[0])))
+            {
+                data++;
+                if (listed++ < REPLAY_LIST)
+                {
+                    printRecord("< ", &a[i]);
+                    printRecord("> ", &b[j]);
+                }
+            }
+            equal++;
+            i++;
+            j++;
+            continue;
+        }
+        // The nearer realignment wins: b[j] further on in a, or a[i] further on in b
+        for (k = 1; j < countB && k <= REPLAY_LOOKAHEAD && i + k < countA && !sameTransfer(&a[i + k], &b[j]); k++)
+        {
+        }
+        for (m = 1; i < countA && m <= REPLAY_LOOKAHEAD && j + m < countB && !sameTransfer(&a[i], &b[j + m]); m++)
+        {
+        }
+        if (j >= countB || (i < countA && k < m))
+        {
+            onlyA++;
+            if (listed++ < REPLAY_LIST)
+            {
+                printRecord("< ", &a[i]);
+            }
+            i++;
+        }
+        else if (i >= countA || m < k)
+        {
+            onlyB++;
+            if (listed++ < REPLAY_LIST)
+            {
+                printRecord("> ", &b[j]);
+            }
+            j++;
+        }
+        else
+        {
+            // No realignment in reach, a transfer replaced by another
+            onlyA++;
+            onlyB++;
+            if (listed++ < REPLAY_LIST)
+            {
+                printRecord("< ", &a[i]);
+                printRecord("> ", &b[j]);
+            }
+            i++;
+            j++;
+        }
+    }
+
+    printf("%u equal transfers, %u only in %s, %u only in %s, %u reads with other words\n", equal, onlyA, pathA,
+           onlyB, pathB, data);
+    for (s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++)
+    {
+        printBusTime(bitsA, bitsB, speeds[s]);
+    }
+    if (hz)
+    {
+        printBusTime(bitsA, bitsB, hz);
+    }
+    free(a);
+    free(b);
+    return onlyA || onlyB || data;
+}
+
+/*
+ * Records, lists, replays and compares I2C traces of the driver (RDA_Trace.h dumps).
+ * Usage: i2c_replay record <file> [cache window ms]   run the session on the chip model and dump it
+ *        i2c_replay show <file>                       list the transfers
+ *        i2c_replay play <file>                       replay against a fresh chip model, check the reads
+ *        i2c_replay diff <a> <b> [I2C clock in Hz]    compare two traces, e.g. of two driver versions
+ * Exits with 1 on mismatches or differences.
+ */
+int main(int argc, char** argv)
+{
+    if (argc >= 3 && !strcmp(argv[1], "record"))
+    {
+        return record(argv[2], argc > 3 ? atoi(argv[3]) : -1);
+    }
+    if (argc == 3 && !strcmp(argv[1], "show"))
+    {
+        return show(argv[2]);
+    }
+    if (argc == 3 && !strcmp(argv[1], "play"))
+    {
+        return play(argv[2]);
+    }
+    if (argc >= 4 && !strcmp(argv[1], "diff"))
+    {
+        return diff(argv[2], argv[3], argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 0) : 0);
+    }
+    fprintf(stderr, "usage: %s record <file> [cache ms] | show <file> | play <file> | diff <a> <b> [Hz]\n", argv[0]);
+    return 2;
+}
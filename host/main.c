@@ -0,0 +1,1791 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <RDA_5807.h>
+#include <RDA_Sched.h>
+#include <RDA_Prof.h>
+#include <RDA_Sim.h>
+#include <RDA_Trace.h>
+
+#define SESSION_SEEKS   3       // Seeks up from the first station
+#define SESSION_RDS     2000    // ms of RDS reception on the last station
+#define SESSION_DRAIN   100     // ms between ring drains
+#define SESSION_BUSY    2500    // ms the main loop does not drain, overloads the ring
+#define SESSION_CAPTURE 40      // ms between RDS captures of the timer tick
+#define SESSION_STATIONS 32     // Station table entries of the band scan
+#define SESSION_TUNERS  3       // Tuners of the multi-tuner scan
+#define SESSION_MONITOR 150     // ms between signal monitor samples
+#define SESSION_SAMPLES 5000    // Samples of the monitor check
+#define SESSION_MUTE    250     // ms mute window of the AF checks, room for the PI of one AF
+#define SESSION_AF_WAIT 5000    // ms budget to receive an AF list
+#define SESSION_CT_MINUTES 60   // Minutes of the Clock-Time stream
+#define SESSION_CT_MJD  60000   // 2023-02-25, the stream starts at 23:50 UTC and crosses midnight
+#define SESSION_CT_ERRORS 4     // One CT group in this many has a bit error
+#define SESSION_RDS_POLL 40     // ms between RDS reads of the power sessions
+#define SESSION_SCHED   6000    // ms of the scheduler session
+#define SESSION_UI      1500    // ms between seek key presses of the scheduler session
+#define SESSION_TASKS   4       // Tasks of the scheduler session
+#define SESSION_FLASH   "fm_radio_host.flash"   // Flash file of the store checks, removed afterwards
+#define SESSION_FLASH_BASE 0x0800F800           // The last 2 KB of a 64 KB part
+#define SESSION_SAVES   2000    // State saves of the wear check
+#define SESSION_CUTS    300     // Power cuts of the store check
+#define SESSION_OTHER_INIT 80   // ms the rest of the board takes to initialise at boot
+#define SESSION_BOOT_BUDGET 150 // ms from power-up to audio on the restored station
+#define SESSION_POLL    10      // ms between passes of the display poll loop
+#define SESSION_POLLS   300     // Passes of the display poll loop
+#define SESSION_FAULT_SLACK 3   // ms a faulted call may take on top of its event timeouts
+#define SESSION_REFRESHES 20    // Status refreshes of the bus transaction check
+#define SESSION_TUNE_DEADLINE 500   // ms the driver waits for a tune (TUNE_TIMEOUT) before it reads STC anyway
+#define SESSION_TRACE   256     // Bytes of the trace ring of the trace check
+
+static const RDA_SimStation stations[] = {
+    { 89100, 38, TRUE,  0xD318, 10, FALSE, "RADIO 1 ", "The best mix of the 80s, 90s and today"},
+    { 94800, 22, FALSE, 0,      0,  FALSE, NULL,       NULL},
+    {101300, 45, TRUE,  0xD3C2, 3,  TRUE,  "INFO FM ", "Traffic and news every 30 minutes"},
+    {104000, 51, TRUE,  0xD201, 5,  FALSE, "CLASSIC ", "Bach: Goldberg Variations"},
+    {106700, 30, TRUE,  0xD4A7, 15, FALSE, "JAZZ 106", "Late night jazz"},
+};
+
+// One program on several transmitters, the AF list names one carrying another program
+static const uint32_t radio1AF[] = {89100, 92400, 97700, 99900, 0};
+
+static const RDA_SimStation transmitters[] = {
+    { 89100, 30, TRUE,  0xD318, 10, FALSE, "RADIO 1 ", NULL, radio1AF},
+    { 92400, 50, TRUE,  0xD318, 10, FALSE, "RADIO 1 ", NULL, radio1AF},
+    { 95000, 45, TRUE,  0xD3C2, 3,  TRUE,  "INFO FM ", NULL, NULL},
+    { 97700, 20, FALSE, 0xD318, 10, FALSE, "RADIO 1 ", NULL, radio1AF},
+    // Another program on an AF of RADIO 1, received here stronger than any of its transmitters
+    { 99900, 60, TRUE,  0xD4A7, 15, FALSE, "JAZZ 106", NULL, NULL},
+};
+
+static RDA_Handle* captureDevice;
+static uint32_t drained;
+static uint32_t maxLatency;
+
+/*
+ * Timer interrupt stand-in
+ */
+static void captureTick(void)
+{
+    // Sample first: the capture reads REG0C, which clears RDSR
+    RDA_MonitorTick(captureDevice);
+    RDA_CaptureRDS(captureDevice);
+}
+
+/*
+ * Installs the interrupt driven port the timer tick reads through
+ */
+static void tickPortAttach(RDA_Handle* radio, RDA_SimPort* port, RDA_BusTypeDef* bus)
+{
+    RDA_SimPortInit(port, bus, RDA_GetXferQueue(radio));
+    RDA_SetXferPort(radio, &RDA_SimPortOps, port);
+}
+
+/*
+ * Lets the last tick read complete and goes back to the polled port
+ */
+static void tickPortDetach(RDA_Handle* radio)
+{
+    while (RDA_XferBusy(RDA_GetXferQueue(radio)))
+    {
+        RDA_HAL_Idle();
+    }
+    RDA_SetXferPort(radio, NULL, NULL);
+}
+
+/*
+ * Decodes the captured groups
+ */
+static void drainRing(RDA_RDSRing* ring, RDA_RDS* rds)
+{
+    RDA_RDSGroup group;
+
+    while (RDA_RDSRingPop(ring, &group))
+    {
+        RDA_RDSDecodeGroup(rds, &group, &RDA_RDSPolicyDefault);
+        drained++;
+        if (getMillis() - group.timestamp > maxLatency)
+        {
+            maxLatency = getMillis() - group.timestamp;
+        }
+    }
+}
+
+/*
+ * Feeds a monitor with random samples, with a channel change now and then, and compares its
+ * statistics with the ones computed from the samples kept on the side
+ */
+static uint32_t checkMonitor(void)
+{
+    static RDA_Monitor monitor;
+    uint8_t rssi[SESSION_SAMPLES];
+    uint8_t flags[SESSION_SAMPLES];
+    RDA_SignalStats stats;
+    uint32_t mismatches = 0;
+    uint32_t first = 0;
+    uint32_t sum;
+    uint32_t n;
+    uint32_t i;
+    uint32_t j;
+    uint16_t channel = 0;
+    uint8_t min;
+    uint8_t max;
+    uint8_t stereo;
+    uint8_t blocks;
+
+    srand(5807);
+    RDA_MonitorInit(&monitor);
+    for (i = 0; i < SESSION_SAMPLES; i++)
+    {
+        if (rand() % 200 == 0)
+        {
+            channel++;
+            first = i;
+        }
+        rssi[i] = rand() % 128;
+        flags[i] = rand() & (RDA_SAMPLE_FM_TRUE | RDA_SAMPLE_STEREO | RDA_SAMPLE_RDS | RDA_SAMPLE_ERROR_A | RDA_SAMPLE_ERROR_B);
+        RDA_MonitorPush(&monitor, channel, rssi[i], flags[i]);
+
+        n = (i + 1 - first < RDA_MONITOR_WINDOW) ? i + 1 - first : RDA_MONITOR_WINDOW;
+        min = 127;
+        max = 0;
+        sum = 0;
+        stereo = 0;
+        blocks = 0;
+        for (j = i + 1 - n; j <= i; j++)
+        {
+            min = (rssi[j] < min) ? rssi[j] : min;
+            max = (rssi[j] > max) ? rssi[j] : max;
+            sum += rssi[j];
+            stereo += (flags[j] & RDA_SAMPLE_STEREO) ? 1 : 0;
+            blocks += (flags[j] & RDA_SAMPLE_RDS) ? 2 : 0;
+        }
+        RDA_MonitorGetStats(&monitor, &stats);
+        if (stats.samples != n || stats.rssiMin != min || stats.rssiMax != max || stats.channel != channel ||
+            stats.rssiAvg != (sum + n / 2) / n || stats.stereo != (stereo * 100 + n / 2) / n || stats.rdsBlocks != blocks)
+        {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/*
+ * Decodes a synthetic stream with one CT group per minute among 0A groups, flips a bit in some
+ * CT groups and checks that every accepted time is the one sent and that the clock follows it
+ */
+static uint32_t checkClockTime(uint32_t* accepted)
+{
+    static const uint16_t ps[] = {0x4354, 0x2054, 0x494D, 0x4520};   // "CT TIME "
+    RDA_RDS rds;
+    RDA_Clock clock = {0};
+    uint16_t blocks[4];
+    uint32_t mismatches = 0;
+    uint32_t start = getMillis();
+    uint32_t minutes;
+    uint32_t expected;
+    uint32_t mjd;
+    uint32_t minute;
+    uint8_t group;
+    uint8_t corrupt;
+    time_t unixTime;
+    struct tm* date;
+
+    srand(4);
+    RDA_RDSInit(&rds);
+    *accepted = 0;
+    for (minute = 0; minute < SESSION_CT_MINUTES; minute++)
+    {
+        minutes = 23 * 60 + 50 + minute;
+        mjd = SESSION_CT_MJD + minutes / 1440;
+        minutes %= 1440;
+        for (group = 0; group < 11; group++)
+        {
+            blocks[0] = 0xD318;
+            if (group == 0)
+            {
+                // 4A, UTC+1
+                blocks[1] = 0x4000 | (mjd >> 15);
+                blocks[2] = (uint16_t)(mjd << 1) | ((minutes / 60) >> 4);
+                blocks[3] = (uint16_t)(((minutes / 60) & 0x0F) << 12) | (uint16_t)((minutes % 60) << 6) | 2;
+                corrupt = (rand() % SESSION_CT_ERRORS == 0);
+                if (corrupt)
+                {
+                    blocks[1 + rand() % 3] ^= 1 << (rand() % 16);
+                }
+            }
+            else
+            {
+                blocks[1] = 0x0008 | (group & 3);
+                blocks[2] = 0xE0CD;
+                blocks[3] = ps[group & 3];
+            }
+            if (RDA_RDSDecode(&rds, blocks) & RDA_RDS_CT_READY)
+            {
+                (*accepted)++;
+                RDA_SyncClock(&clock, &rds.time, getMillis());
+                unixTime = RDA_RDSTimeToUnix(&rds.time);
+                date = gmtime(&unixTime);
+                if (rds.time.mjd != mjd || rds.time.hour * 60 + rds.time.minute != minutes || rds.time.offset != 2 ||
+                    rds.time.year != date->tm_year + 1900 || rds.time.month != date->tm_mon + 1 || rds.time.day != date->tm_mday)
+                {
+                    mismatches++;
+                }
+            }
+            Delay(60000 / 11);
+        }
+    }
+    // The clock runs on from the last sync
+    expected = (SESSION_CT_MJD - 40587) * 86400 + (23 * 60 + 50) * 60 + (getMillis() - start) / 1000;
+    if (!*accepted || RDA_GetClock(&clock, FALSE) != expected || RDA_GetClock(&clock, TRUE) != expected + 3600)
+    {
+        mismatches++;
+    }
+    return mismatches;
+}
+
+/*
+ * Tunes every channel of every BAND/SPACE combination (up to the 10-bit CHAN limit) and
+ * compares the requested frequency with the one the model tuned and the one read back
+ */
+static uint32_t checkChannels(RDA_Sim* sim, RDA_Handle* radio, uint32_t* channels)
+{
+    static const uint32_t start[] = {87000, 76000, 76000, 65000};
+    static const uint32_t end[] = {108000, 91000, 108000, 76000};
+    static const uint32_t space[] = {100, 200, 50, 25};
+    uint32_t mismatches = 0;
+    uint32_t frequency;
+    uint32_t channel;
+    uint8_t band;
+    uint8_t step;
+
+    *channels = 0;
+    for (band = 0; band < 4; band++)
+    {
+        for (step = 0; step < 4; step++)
+        {
+            RDA_SetBand(radio, band);
+            RDA_SetSpace(radio, step);
+            for (channel = 0; channel <= (end[band] - start[band]) / space[step] && channel < 1024; channel++)
+            {
+                frequency = start[band] + channel * space[step];
+                RDA_Tune(radio, frequency);
+                if (RDA_SimGetFrequency(sim) != frequency || RDA_GetRealFrequency(radio) != frequency)
+                {
+                    mismatches++;
+                }
+                (*channels)++;
+            }
+        }
+    }
+    RDA_SetBand(radio, RDA_FM_BAND_USA_EU);
+    RDA_SetSpace(radio, 0);
+    return mismatches;
+}
+
+/*
+ * Receives the AF list of the tuned program, then checks its AFs
+ */
+static uint32_t afCheck(RDA_Handle* radio, RDA_AFTable* table, uint16_t window, uint32_t expected)
+{
+    const RDA_AFList* list = NULL;
+    uint16_t blocks[4];
+    uint32_t from = RDA_GetRealFrequency(radio);
+    uint32_t start = getMillis();
+    uint32_t duration;
+    RDA_Status status;
+    BOOL switched;
+
+    while (getMillis() - start < SESSION_AF_WAIT && !(list && RDA_AFComplete(list)))
+    {
+        Delay(SESSION_CAPTURE);
+        if (RDA_GetRDSReady(radio) && RDA_RefreshStatus(radio) == RDA_OK)
+        {
+            RDA_GetRDSBlocks(radio, blocks);
+            RDA_AFDecode(table, blocks);
+            list = RDA_AFFind(table, blocks[0]);
+        }
+    }
+    if (!list || !RDA_AFComplete(list))
+    {
+        printf("af check      no AF list on %u kHz\n", from);
+        return 1;
+    }
+
+    start = getMillis();
+    status = RDA_AFCheck(radio, list, window, &switched);
+    duration = getMillis() - start;
+    printf("af check      PI %04X, %u AFs, %u -> %u kHz (%s), %u of %u ms (%d)\n", list->pi, list->count, from,
+           RDA_GetRealFrequency(radio), switched ? "switched" : "stayed", duration, window, status);
+    return (status != RDA_OK || RDA_GetRealFrequency(radio) != expected || duration > window) ? 1 : 0;
+}
+
+/*
+ * Runs AF checks on a band with one program on several transmitters: from the weak one to
+ * the strongest, then from the strongest, which has to stay, also with a window too short for all AFs
+ */
+static uint32_t afSession(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_AFTable table;
+    uint32_t failures;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, transmitters, sizeof(transmitters) / sizeof(transmitters[0]));
+    RDA_Init(&radio, &bus);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_AFTableInit(&table);
+
+    RDA_Tune(&radio, 89100);
+    failures = afCheck(&radio, &table, SESSION_MUTE, 92400);
+    failures += afCheck(&radio, &table, SESSION_MUTE, 92400);
+    failures += afCheck(&radio, &table, SESSION_MUTE / 2, 92400);
+    failures += afCheck(&radio, &table, SESSION_MUTE / 2, 92400);
+    return failures;
+}
+
+/*
+ * Scans the band with several simulated tuners, one after the other, then interleaved
+ */
+static void multiScan(void)
+{
+    RDA_Sim sims[SESSION_TUNERS];
+    RDA_BusTypeDef buses[SESSION_TUNERS];
+    RDA_Handle radios[SESSION_TUNERS];
+    RDA_Station found[SESSION_TUNERS][SESSION_STATIONS];
+    RDA_StationTable tables[SESSION_TUNERS];
+    uint32_t sequential = 0;
+    uint32_t interleaved;
+    uint32_t start;
+    uint8_t active;
+    uint8_t i;
+
+    for (i = 0; i < SESSION_TUNERS; i++)
+    {
+        RDA_SimInit(&sims[i], &buses[i]);
+        RDA_SimSetStations(&sims[i], stations, sizeof(stations) / sizeof(stations[0]));
+        RDA_Init(&radios[i], &buses[i]);
+        tables[i] = (RDA_StationTable){found[i], SESSION_STATIONS};
+    }
+
+    for (i = 0; i < SESSION_TUNERS; i++)
+    {
+        RDA_Scan(&radios[i], RDA_SCAN_STEP, &tables[i]);
+        sequential += tables[i].time;
+    }
+
+    start = getMillis();
+    for (i = 0; i < SESSION_TUNERS; i++)
+    {
+        RDA_ScanStart(&radios[i], RDA_SCAN_STEP, &tables[i]);
+    }
+    do
+    {
+        active = 0;
+        for (i = 0; i < SESSION_TUNERS; i++)
+        {
+            active += (RDA_ScanPoll(&radios[i]) == RDA_TUNE_IN_PROGRESS);
+        }
+        if (active)
+        {
+            RDA_HAL_Idle();
+        }
+    }
+    while (active);
+    interleaved = getMillis() - start;
+
+    printf("multi scan    %u tuners, %u stations each, sequential %u ms, interleaved %u ms\n", SESSION_TUNERS,
+           tables[0].count, sequential, interleaved);
+}
+
+static RDA_Timer powerTimer;
+static RDA_RDS powerRds;
+
+/*
+ * RDS read of the scheduled power session, re-arms itself
+ */
+static void powerRead(RDA_Timer* timer)
+{
+    RDA_ReadRDS(timer->context, &powerRds);
+    RDA_TimerStart(timer, SESSION_RDS_POLL, powerRead, timer->context);
+}
+
+/*
+ * Tune completion of the scheduled power session, starts the RDS reads
+ */
+static void powerTuned(RDA_Handle* dev, RDA_TuneStatus status)
+{
+    RDA_TimerStart(&powerTimer, SESSION_RDS_POLL, powerRead, dev);
+}
+
+/*
+ * Tunes a station and reads RDS for SESSION_RDS ms, either with blocking calls and Delay between
+ * the reads, or with the tune continuation and a timer while the main loop sleeps. Bus time is
+ * what the CPU spends busy (polled transfers), Delay and RDA_HAL_Idle is what it sleeps.
+ */
+static void powerSession(BOOL scheduled)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    uint32_t start;
+    uint32_t wait;
+    uint32_t idle;
+    uint32_t bits;
+    uint32_t busy;
+    uint32_t delay;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_RDSInit(&powerRds);
+
+    start = getMillis();
+    wait = RDA_HAL_GetWaitMillis();
+    idle = RDA_HAL_GetIdleMillis();
+    bits = sim.stats.bits;
+    if (scheduled)
+    {
+        RDA_TuneAsync(&radio, 89100, powerTuned);
+        while ((int32_t)(getMillis() - start - SESSION_RDS) < 0)
+        {
+            RDA_TimerSleep();
+        }
+        RDA_TimerStop(&powerTimer);
+    }
+    else
+    {
+        RDA_Tune(&radio, 89100);
+        while ((int32_t)(getMillis() - start - SESSION_RDS) < 0)
+        {
+            RDA_ReadRDS(&radio, &powerRds);
+            Delay(SESSION_RDS_POLL);
+        }
+    }
+    busy = (uint32_t)((uint64_t)(sim.stats.bits - bits) * 1000 / sim.busSpeed);
+    idle = RDA_HAL_GetIdleMillis() - idle;
+    delay = RDA_HAL_GetWaitMillis() - wait - idle;
+
+    printf("power %s  %u ms, cpu busy %u ms, asleep %u ms (%u in Delay), busy %u ms with a spinning Delay, PS \"%s\"\n",
+           scheduled ? "timers" : "polled", getMillis() - start, busy, delay + idle, delay, busy + delay,
+           RDA_RDSHasPS(&powerRds) ? powerRds.ps : "");
+}
+
+static RDA_Task schedTasks[SESSION_TASKS];
+static RDA_RDSRing schedRing;
+static RDA_RDS schedRds;
+static uint32_t schedSeeks;
+
+/*
+ * Timer interrupt stand-in of the scheduler session, only captures RDS
+ */
+static void schedCapture(void)
+{
+    RDA_CaptureRDS(captureDevice);
+}
+
+/*
+ * Scheduler session tasks: tune completion, ring drain, signal sample and the seek key
+ */
+static void taskTuned(RDA_Task* task)
+{
+    // A new station, forget the old one's RDS
+    RDA_RDSInit(&schedRds);
+    schedSeeks++;
+}
+
+static void taskDrain(RDA_Task* task)
+{
+    drainRing(&schedRing, &schedRds);
+}
+
+static void taskMonitor(RDA_Task* task)
+{
+    RDA_MonitorStep(task->context);
+}
+
+/*
+ * Tune completion, runs in the timer continuation and hands over to the task
+ */
+static void schedTuneDone(RDA_Handle* dev, RDA_TuneStatus status)
+{
+    RDA_TaskPost(&schedTasks[0]);
+}
+
+static void taskKey(RDA_Task* task)
+{
+    RDA_SeekAsync(task->context, RDA_SEEK_WRAP, RDA_SEEK_UP, schedTuneDone);
+}
+
+/*
+ * Runs the driver and application jobs as scheduler tasks: the seek key every SESSION_UI ms,
+ * tune completion, ring drains and signal samples, and reports where the CPU time went
+ */
+static void schedSession(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Monitor monitor;
+    RDA_SimPort port;
+    RDA_SchedStats stats;
+    RDA_Task* task;
+    uint32_t start;
+    uint32_t busy = 0;
+    uint8_t i;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_RDSInit(&schedRds);
+    RDA_RDSRingInit(&schedRing);
+    RDA_SetRDSRing(&radio, &schedRing);
+    RDA_SetMonitor(&radio, &monitor, SESSION_MONITOR);
+    tickPortAttach(&radio, &port, &bus);
+    captureDevice = &radio;
+    drained = 0;
+    maxLatency = 0;
+    schedSeeks = 0;
+
+    RDA_SchedInit();
+    RDA_TaskAdd(&schedTasks[0], "tuned", RDA_PRIORITY_HIGH, taskTuned, &radio);
+    RDA_TaskAdd(&schedTasks[1], "drain", RDA_PRIORITY_NORMAL, taskDrain, &radio);
+    RDA_TaskAdd(&schedTasks[2], "monitor", RDA_PRIORITY_NORMAL, taskMonitor, &radio);
+    RDA_TaskAdd(&schedTasks[3], "key", RDA_PRIORITY_LOW, taskKey, &radio);
+    RDA_TaskSetPeriod(&schedTasks[1], SESSION_DRAIN);
+    RDA_TaskSetPeriod(&schedTasks[2], SESSION_MONITOR);
+    RDA_TaskSetPeriod(&schedTasks[3], SESSION_UI);
+    RDA_HAL_SetTick(schedCapture, SESSION_CAPTURE);
+    RDA_TuneAsync(&radio, 89100, schedTuneDone);
+
+    start = getMillis();
+    while ((int32_t)(getMillis() - start - SESSION_SCHED) < 0)
+    {
+        RDA_SchedStep();
+    }
+    RDA_HAL_SetTick(NULL, 0);
+    RDA_SchedGetStats(&stats);
+
+    printf("sched         %u ms, %u stations tuned, %u groups drained, latency max %u ms, PS \"%s\"\n", SESSION_SCHED,
+           schedSeeks, drained, maxLatency, RDA_RDSHasPS(&schedRds) ? schedRds.ps : "");
+    for (i = 0; i < SESSION_TASKS; i++)
+    {
+        task = &schedTasks[i];
+        busy += task->runMicros;
+        printf("  task %-8s %4u runs, %6u us (%u.%u%%), max %4u us\n", task->name, task->runs, task->runMicros,
+               task->runMicros * 100 / stats.elapsed, task->runMicros * 1000 / stats.elapsed % 10, task->maxMicros);
+    }
+    printf("  timers        %6u us, idle %u us, rest %u us\n", stats.timers, stats.idle,
+           stats.elapsed - stats.idle - stats.timers - busy);
+    RDA_SchedInit();
+    tickPortDetach(&radio);
+    RDA_SetRDSRing(&radio, NULL);
+    RDA_SetMonitor(&radio, NULL, 0);
+}
+
+/*
+ * Power cycle of the store: the flash file is opened again and the store mounted from it
+ */
+static uint8_t storeReboot(RDA_Store* store)
+{
+    RDA_HAL_FlashFile(SESSION_FLASH, SESSION_FLASH_BASE, 2 * RDA_FLASH_PAGE_SIZE);
+    return RDA_StoreOpen(store, SESSION_FLASH_BASE);
+}
+
+/*
+ * Compares a mounted entry with the expected one, NULL stands for an empty entry
+ */
+static uint32_t storeMismatch(const RDA_StoreEntry* mounted, const RDA_StoreEntry* expected)
+{
+    if (!mounted || !expected)
+    {
+        return (mounted || (expected && expected->frequency)) ? 1 : 0;
+    }
+    return (mounted->frequency != expected->frequency || mounted->band != expected->band ||
+            mounted->space != expected->space || mounted->volume != expected->volume ||
+            mounted->flags != expected->flags || strcmp(mounted->ps, expected->ps)) ? 1 : 0;
+}
+
+/*
+ * Presets of the stations of the session, the last state on the fourth one
+ */
+static void storeFill(RDA_Store* store, RDA_StoreEntry* presets, RDA_StoreEntry* state)
+{
+    uint8_t count = sizeof(stations) / sizeof(stations[0]);
+    uint8_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        memset(&presets[i], 0, sizeof(presets[i]));
+        presets[i].frequency = stations[i].frequency;
+        presets[i].volume = 10;
+        presets[i].flags = RDA_STORE_BASS;
+        strncpy(presets[i].ps, stations[i].ps ? stations[i].ps : "", RDA_STORE_PS);
+        RDA_StoreSavePreset(store, i, &presets[i]);
+    }
+    *state = presets[3];
+    RDA_StoreSaveState(store, state);
+}
+
+/*
+ * Checks the preset store against the file-backed flash: contents across power cycles, wear
+ * over many saves and power cuts in the middle of appends and compactions
+ */
+static uint32_t checkStore(void)
+{
+    uint8_t count = sizeof(stations) / sizeof(stations[0]);
+    RDA_StoreEntry presets[RDA_STORE_PRESETS];
+    RDA_StoreEntry state;
+    RDA_StoreEntry pending;
+    RDA_Store store;
+    uint32_t mismatches = 0;
+    uint32_t compacting = 0;
+    uint32_t records = 0;
+    uint32_t erases;
+    uint32_t cut;
+    uint32_t n;
+    uint8_t saved;
+    uint8_t full;
+    uint8_t i;
+
+    remove(SESSION_FLASH);
+    storeReboot(&store);
+    storeFill(&store, presets, &state);
+    storeReboot(&store);
+    for (i = 0; i < count; i++)
+    {
+        mismatches += storeMismatch(RDA_StoreGetPreset(&store, i), &presets[i]);
+    }
+    mismatches += storeMismatch(RDA_StoreGetState(&store), &state);
+
+    // Every save differs from the last one
+    erases = RDA_HAL_FlashGetErases();
+    for (n = 0; n < SESSION_SAVES; n++)
+    {
+        state.frequency = stations[n % count].frequency;
+        state.volume = n % 16;
+        RDA_StoreSaveState(&store, &state);
+    }
+    erases = RDA_HAL_FlashGetErases() - erases;
+    records = store.records;
+    storeReboot(&store);
+    mismatches += storeMismatch(RDA_StoreGetState(&store), &state);
+    printf("store check   %u saves, %u records, %u page erases\n", SESSION_SAVES, records, erases);
+
+    // Each round saves until the power is cut, after the reboot the last complete save is there
+    for (cut = 0; cut < SESSION_CUTS; cut++)
+    {
+        RDA_HAL_FlashFailAfter(1 + cut * 7 % 97);
+        do
+        {
+            pending = state;
+            pending.volume = (pending.volume + 1) % 16;
+            full = (store.next + RDA_STORE_RECORD > RDA_FLASH_PAGE_SIZE);
+            saved = RDA_StoreSaveState(&store, &pending);
+            if (saved)
+            {
+                state = pending;
+            }
+        }
+        while (saved);
+        compacting += full;
+        RDA_HAL_FlashFailAfter(0);
+        storeReboot(&store);
+        mismatches += storeMismatch(RDA_StoreGetState(&store), &state);
+        for (i = 0; i < count; i++)
+        {
+            mismatches += storeMismatch(RDA_StoreGetPreset(&store, i), &presets[i]);
+        }
+    }
+    printf("store cuts    %u power cuts, %u during a compaction, %u mismatches\n", SESSION_CUTS, compacting, mismatches);
+    remove(SESSION_FLASH);
+    return mismatches;
+}
+
+/*
+ * Time from reset until the station plays: the hard-coded tune of src/main.c, a scan for the
+ * stations when nothing is stored, and the restore of the stored state
+ */
+static void bootSession(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Store store;
+    RDA_StoreEntry presets[RDA_STORE_PRESETS];
+    RDA_StoreEntry state;
+    RDA_Station found[SESSION_STATIONS];
+    RDA_StationTable table = {found, SESSION_STATIONS};
+    uint32_t start;
+    uint32_t transactions;
+    uint8_t way;
+
+    remove(SESSION_FLASH);
+    storeReboot(&store);
+    storeFill(&store, presets, &state);
+    for (way = 0; way < 3; way++)
+    {
+        RDA_SimInit(&sim, &bus);
+        RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+        start = getMillis();
+        RDA_PowerUpStart(&radio, &bus);
+        RDA_HAL_Advance(SESSION_OTHER_INIT);
+        while (RDA_PowerUpPoll(&radio) == RDA_TUNE_IN_PROGRESS)
+        {
+            RDA_HAL_Idle();
+        }
+        switch (way)
+        {
+            case 0:
+                RDA_BeginUpdate(&radio);
+                RDA_SetBass(&radio, TRUE);
+                RDA_SetVolume(&radio, 10);
+                RDA_CommitUpdate(&radio);
+                RDA_Tune(&radio, state.frequency);
+                break;
+            case 1:
+                RDA_Scan(&radio, RDA_SCAN_SEEK, &table);
+                RDA_BeginUpdate(&radio);
+                RDA_SetBass(&radio, TRUE);
+                RDA_SetVolume(&radio, 10);
+                RDA_CommitUpdate(&radio);
+                RDA_Tune(&radio, table.count > 3 ? found[3].frequency : state.frequency);
+                break;
+            default:
+                storeReboot(&store);
+                RDA_RestoreState(&radio, RDA_StoreGetState(&store));
+                break;
+        }
+        transactions = sim.stats.transactions;
+        printf("boot %s  %u kHz after %u ms, %u transactions\n", way == 0 ? "fixed  " : way == 1 ? "scan   " : "restore",
+               RDA_SimGetFrequency(&sim), getMillis() - start, transactions);
+    }
+    remove(SESSION_FLASH);
+}
+
+/*
+ * Boots onto the stored station with the power-up done first and then overlapped with the rest
+ * of the board init, returns the mismatches: the staged boot must be faster and within budget
+ */
+static uint32_t checkBoot(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Store store;
+    RDA_StoreEntry presets[RDA_STORE_PRESETS];
+    RDA_StoreEntry state;
+    uint32_t boot[2];
+    uint32_t ready[2];
+    uint32_t mismatches = 0;
+    uint8_t staged;
+
+    remove(SESSION_FLASH);
+    storeReboot(&store);
+    storeFill(&store, presets, &state);
+    for (staged = 0; staged < 2; staged++)
+    {
+        RDA_SimInit(&sim, &bus);
+        RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+        if (staged)
+        {
+            RDA_PowerUpStart(&radio, &bus);
+            RDA_HAL_Advance(SESSION_OTHER_INIT);
+            while (RDA_PowerUpPoll(&radio) == RDA_TUNE_IN_PROGRESS)
+            {
+                RDA_HAL_Idle();
+            }
+        }
+        else
+        {
+            RDA_Init(&radio, &bus);
+            RDA_HAL_Advance(SESSION_OTHER_INIT);
+        }
+        storeReboot(&store);
+        RDA_RestoreState(&radio, RDA_StoreGetState(&store));
+        boot[staged] = RDA_GetBootTime(&radio);
+        ready[staged] = radio.readyTime;
+        mismatches += (RDA_SimGetFrequency(&sim) != state.frequency) || !boot[staged];
+    }
+    mismatches += (boot[1] > SESSION_BOOT_BUDGET) || (boot[1] >= boot[0]);
+    printf("boot check    ready %u ms, audio %u ms in sequence / %u ms staged (budget %u ms), %u mismatches\n",
+           ready[1], boot[0], boot[1], SESSION_BOOT_BUDGET, mismatches);
+    remove(SESSION_FLASH);
+    return mismatches;
+}
+
+#ifdef RDA_PROFILE
+/*
+ * Prints the instrumentation table and checks its totals against the bus of the model
+ */
+static uint32_t profCheck(RDA_Sim* sim)
+{
+    const RDA_ProfEntry* entry;
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+    uint8_t i;
+
+    RDA_ProfDump((RDA_ProfPrint)puts);
+    for (i = 0; i < RDA_PROF_SLOTS; i++)
+    {
+        if ((entry = RDA_ProfGet(i)))
+        {
+            transactions += entry->transactions;
+            bytes += entry->bytes;
+        }
+    }
+    printf("prof check    %u/%u transactions, %u/%u bytes counted\n", transactions, sim->stats.transactions, bytes,
+           sim->stats.bytes);
+    return (transactions != sim->stats.transactions) + (bytes != sim->stats.bytes);
+}
+#endif
+
+/*
+ * The display loop of a typical application: channel, RSSI, stereo and RDS flags every pass,
+ * the RDS group when one is ready. Returns the passes that saw the wrong channel
+ */
+static uint32_t pollSession(uint16_t window, uint32_t* transactions)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_RDS rds;
+    RDA_CacheStats cache;
+    uint32_t mismatches = 0;
+    uint16_t pass;
+
+#ifdef RDA_PROFILE
+    RDA_ProfReset();
+#endif
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_Tune(&radio, 104000);
+    RDA_RDSInit(&rds);
+    RDA_SetCacheWindow(&radio, window);
+    *transactions = sim.stats.transactions;
+    RDA_GetCacheStats(&radio, &cache);
+    for (pass = 0; pass < SESSION_POLLS; pass++)
+    {
+        mismatches += RDA_GetRealFrequency(&radio) != 104000;
+        RDA_GetQuality(&radio);
+        RDA_GetSterioStatus(&radio);
+        RDA_GetRDSSync(&radio);
+        if (RDA_GetRDSReady(&radio))
+        {
+            RDA_ReadRDS(&radio, &rds);
+        }
+        Delay(SESSION_POLL);
+    }
+    *transactions = sim.stats.transactions - *transactions;
+    RDA_GetCacheStats(&radio, &cache);
+    printf("poll loop     window %2u ms, %u passes, %u transactions, %u hits / %u misses (%u%%), PS \"%s\", %u mismatches\n",
+           window, SESSION_POLLS, *transactions, cache.hits, cache.misses, cache.hits * 100 / (cache.hits + cache.misses),
+           rds.ps, mismatches);
+#ifdef RDA_PROFILE
+    mismatches += profCheck(&sim);
+#endif
+    return mismatches;
+}
+
+/*
+ * Knocks the chip out of line with the shadow registers (brown-out, soft reset) and has
+ * RDA_Resync bring it back, returns the mismatches
+ */
+static uint32_t checkResync(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Reg05 reg05;
+    RDA_CacheStats cache;
+    uint8_t diverged[3];
+    uint32_t mismatches = 0;
+    uint32_t start;
+    uint8_t way;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_BeginUpdate(&radio);
+    RDA_SetBass(&radio, TRUE);
+    RDA_SetVolume(&radio, 7);
+    RDA_CommitUpdate(&radio);
+    RDA_Tune(&radio, 101300);
+    for (way = 0; way < 2; way++)
+    {
+        RDA_Verify(&radio, &diverged[0]);
+        if (way == 0)
+        {
+            RDA_SimBrownOut(&sim);
+        }
+        else
+        {
+            RDA_SoftReset(&radio);
+        }
+        RDA_Verify(&radio, &diverged[1]);
+        start = getMillis();
+        RDA_Resync(&radio);
+        RDA_Verify(&radio, &diverged[2]);
+        reg05.raw = sim.reg[REG05];
+        mismatches += diverged[0] || !diverged[1] || diverged[2] || RDA_SimGetFrequency(&sim) != 101300 ||
+                      reg05.refined.VOLUME != 7 || RDA_GetQuality(&radio) == 0;
+        printf("resync        %s: registers %02X diverged, back on %u kHz after %u ms, %u mismatches\n",
+               way == 0 ? "brown-out " : "soft reset", diverged[1], RDA_SimGetFrequency(&sim), getMillis() - start,
+               mismatches);
+    }
+    RDA_GetCacheStats(&radio, &cache);
+    mismatches += cache.resyncs != 2;
+    return mismatches;
+}
+
+/*
+ * Waits for the asynchronous tune/seek to finish
+ */
+static RDA_TuneStatus waitTune(RDA_Handle* radio)
+{
+    RDA_TuneStatus status;
+
+    while ((status = RDA_TunePoll(radio)) == RDA_TUNE_IN_PROGRESS)
+    {
+        RDA_HAL_Idle();
+    }
+    return status;
+}
+
+static RDA_BusTypeDef* logBus;
+static RDA_Xfer busLog[SESSION_REFRESHES];
+static uint32_t busLogged;
+
+/*
+ * Fake I2C layer: logs every transfer, then passes it to the model
+ */
+static void busRecord(uint8_t address, uint8_t direction, uint8_t reg, uint8_t length)
+{
+    RDA_Xfer xfer = {address, direction, reg, length};
+
+    if (busLogged < SESSION_REFRESHES)
+    {
+        busLog[busLogged] = xfer;
+    }
+    busLogged++;
+}
+
+static RDA_XferStatus logWrite(void* device, uint8_t address, uint8_t reg, const uint16_t* data, uint8_t length)
+{
+    busRecord(address, RDA_XFER_WRITE, reg, length);
+    return logBus->write(logBus->device, address, reg, data, length);
+}
+
+static RDA_XferStatus logRead(void* device, uint8_t address, uint8_t reg, uint16_t* data, uint8_t length)
+{
+    busRecord(address, RDA_XFER_READ, reg, length);
+    return logBus->read(logBus->device, address, reg, data, length);
+}
+
+/*
+ * The timer tick reads must start nothing on the polled port, where they would run the transfer
+ * in the interrupt, nor while a write settles; on the interrupt port they start one read each.
+ * The task sample and capture read on the polled port once the write settled. A tick inside an
+ * application call is not charged to it by the instrumentation. Returns the mismatches
+ */
+static uint32_t checkTickReads(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_SimPort port;
+    RDA_RDSRing ring;
+    RDA_Monitor monitor;
+    uint32_t transactions;
+    uint32_t started;
+    uint32_t stepped;
+    uint32_t mismatches = 0;
+#ifdef RDA_PROFILE
+    RDA_ProfScope call;
+    uint32_t charged;
+#endif
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_Tune(&radio, 104000);
+    RDA_RDSRingInit(&ring);
+    RDA_SetRDSRing(&radio, &ring);
+    RDA_SetMonitor(&radio, &monitor, 0);
+    Delay(SESSION_FAULT_SLACK);
+
+    transactions = sim.stats.transactions;
+    mismatches += RDA_MonitorTick(&radio) || RDA_CaptureRDS(&radio);
+    mismatches += sim.stats.transactions != transactions;
+
+    // From a task the polled port is fine, the read completes in the call
+    RDA_SetVolume(&radio, 8);
+    mismatches += RDA_MonitorStep(&radio) || RDA_CaptureRDSStep(&radio);
+    Delay(SESSION_FAULT_SLACK);
+    transactions = sim.stats.transactions;
+    mismatches += !RDA_MonitorStep(&radio) || !RDA_CaptureRDSStep(&radio);
+    stepped = sim.stats.transactions - transactions;
+    mismatches += stepped != 2;
+
+    tickPortAttach(&radio, &port, &bus);
+    RDA_SetVolume(&radio, 7);
+    transactions = sim.stats.transactions;
+    started = port.started;
+    mismatches += RDA_MonitorTick(&radio) || RDA_CaptureRDS(&radio);
+    Delay(SESSION_FAULT_SLACK);
+#ifdef RDA_PROFILE
+    // The ticks land inside an application call, which must not be charged with their reads
+    call = RDA_ProfEnter(__func__);
+    charged = call.entry->transactions;
+#endif
+    mismatches += !RDA_MonitorTick(&radio) || !RDA_CaptureRDS(&radio);
+#ifdef RDA_PROFILE
+    mismatches += call.entry->transactions != charged;
+    RDA_ProfLeave(&call);
+#endif
+    tickPortDetach(&radio);
+    mismatches += sim.stats.transactions - transactions != 2 || port.started - started != 2;
+    printf("tick reads    refused polled and settling, %u transactions on the port, %u polled from a task, %u mismatches\n",
+           sim.stats.transactions - transactions, stepped, mismatches);
+    RDA_SetRDSRing(&radio, NULL);
+    RDA_SetMonitor(&radio, NULL, 0);
+    return mismatches;
+}
+
+/*
+ * Tunes off the channel grid, synchronous and asynchronous, and steps from there: the state
+ * must hold the channel the chip is on, never the requested frequency. Returns the mismatches
+ */
+static uint32_t checkOffGrid(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_StoreEntry state;
+    uint32_t mismatches = 0;
+    uint8_t step;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_Tune(&radio, 100050);
+    RDA_GetState(&radio, &state);
+    mismatches += state.frequency != 100100 || RDA_SimGetFrequency(&sim) != 100100;
+    // Up, up, down, down, down: every step lands on the grid where the chip is
+    for (step = 0; step < 5; step++)
+    {
+        if (step < 2)
+        {
+            RDA_ManualDown(&radio);
+        }
+        else
+        {
+            RDA_ManualUp(&radio);
+        }
+        RDA_GetState(&radio, &state);
+        mismatches += state.frequency != RDA_SimGetFrequency(&sim) || (state.frequency - 87000) % 100 != 0;
+    }
+    mismatches += state.frequency != 100000;
+    RDA_TuneAsync(&radio, 94730, NULL);
+    waitTune(&radio);
+    RDA_GetState(&radio, &state);
+    mismatches += state.frequency != 94700 || RDA_SimGetFrequency(&sim) != 94700;
+    printf("off grid      100050 kHz tuned as 100100, steps on the grid, async 94730 as %u, %u mismatches\n",
+           state.frequency, mismatches);
+    return mismatches;
+}
+
+static uint32_t traceDumped;
+
+/*
+ * Dump sink of the trace check: the interrupt port completes a transfer while it writes
+ */
+static void traceWrite(void* context, const uint8_t* data, uint32_t length)
+{
+    if (!traceDumped)
+    {
+        RDA_HAL_AdvanceMicros(2 * SIM_PORT_LATENCY);
+    }
+    traceDumped += length;
+}
+
+/*
+ * Gets the start time of a trace record
+ */
+static uint32_t traceTime(const uint8_t* record)
+{
+    return record[0] | record[1] << 8 | record[2] << 16 | (uint32_t)record[3] << 24;
+}
+
+/*
+ * Two chips, one on the interrupt port and one polled: a transfer of the polled one starts and
+ * ends while the other is on the bus, each record must keep the start time of its own queue.
+ * A transfer completing during RDA_TraceDump must be counted as dropped and leave the ring
+ * alone. Returns the mismatches
+ */
+static uint32_t checkTrace(void)
+{
+    static uint8_t buffer[SESSION_TRACE];
+    RDA_Trace trace;
+    RDA_Sim sims[2];
+    RDA_BusTypeDef buses[2];
+    RDA_Handle radios[2];
+    RDA_SimPort port;
+    uint16_t words[SH_REG0B + 1];
+    RDA_Xfer xfer = {I2C_ADDR_FULL_ACCESS, RDA_XFER_READ, RDA_XFER_NO_REG, SH_REG0B + 1, words};
+    RDA_XferQueue* queue;
+    uint32_t started[2];
+    uint32_t head;
+    uint32_t mismatches = 0;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++)
+    {
+        RDA_SimInit(&sims[i], &buses[i]);
+        RDA_SimSetStations(&sims[i], stations, sizeof(stations) / sizeof(stations[0]));
+        RDA_Init(&radios[i], &buses[i]);
+    }
+    tickPortAttach(&radios[0], &port, &buses[0]);
+    queue = RDA_GetXferQueue(&radios[0]);
+    Delay(SESSION_FAULT_SLACK);
+    RDA_TraceInit(&trace, buffer, sizeof(buffer));
+    RDA_TraceAttach(&trace);
+
+    started[0] = getMicros();
+    mismatches += !RDA_XferSubmit(queue, &xfer);
+    RDA_HAL_AdvanceMicros(SIM_PORT_LATENCY / 2);
+    started[1] = getMicros();
+    // The interrupt of the first transfer comes during the bus time of this one
+    mismatches += RDA_RefreshStatus(&radios[1]) != RDA_OK || xfer.status != RDA_XFER_OK;
+    mismatches += trace.records != 2 || traceTime(buffer) != started[0] ||
+                  traceTime(&buffer[RDA_TRACE_RECORD + 2 * buffer[RDA_TRACE_RECORD - 1]]) != started[1];
+
+    head = trace.head;
+    traceDumped = 0;
+    mismatches += !RDA_XferSubmit(queue, &xfer);
+    RDA_TraceDump(&trace, traceWrite, NULL);
+    mismatches += xfer.status != RDA_XFER_OK || trace.head != head || trace.dropped != 1 ||
+                  traceDumped != RDA_TRACE_HEADER + head;
+    mismatches += RDA_RefreshStatus(&radios[1]) != RDA_OK || trace.records != 3;
+    printf("trace check   %u records, the polled one started %u us after, %u dropped while dumping, %u mismatches\n",
+           trace.records, started[1] - started[0], trace.dropped, mismatches);
+    RDA_TraceAttach(NULL);
+    tickPortDetach(&radios[0]);
+    return mismatches;
+}
+
+/*
+ * Checks on a logging bus that every RDA_RefreshStatus is one sequential read of REG0A-REG0F
+ * through the full access address, and that the getters are served from what it read.
+ * Returns the mismatches
+ */
+static uint32_t checkRefreshStatus(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef model;
+    RDA_BusTypeDef bus = {logWrite, logRead, NULL, NULL};
+    RDA_Handle radio;
+    RDA_Reg0B reg0B;
+    uint16_t blocks[4];
+    uint32_t transactions;
+    uint32_t mismatches = 0;
+    uint8_t i;
+    uint8_t j;
+
+    RDA_SimInit(&sim, &model);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    logBus = &model;
+    RDA_Init(&radio, &bus);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_Tune(&radio, 104000);
+    transactions = sim.stats.transactions;
+    busLogged = 0;
+    for (i = 0; i < SESSION_REFRESHES; i++)
+    {
+        Delay(SESSION_RDS_POLL);
+        mismatches += RDA_RefreshStatus(&radio) != RDA_OK;
+        mismatches += busLogged != i + 1u || busLog[i].address != I2C_ADDR_FULL_ACCESS ||
+                      busLog[i].direction != RDA_XFER_READ || busLog[i].reg != RDA_XFER_NO_REG ||
+                      busLog[i].length != REG0F - REG0A + 1;
+        // Served from the burst, no transfer of their own
+        RDA_GetRDSBlocks(&radio, blocks);
+        for (j = 0; j < 4; j++)
+        {
+            mismatches += blocks[j] != sim.reg[REG0C + j];
+        }
+        reg0B.raw = sim.reg[REG0B];
+        mismatches += RDA_GetQuality(&radio) != reg0B.refined.RSSI || busLogged != i + 1u;
+    }
+    printf("refresh check %u refreshes, %u transfers, %u transactions, %u mismatches\n", SESSION_REFRESHES, busLogged,
+           sim.stats.transactions - transactions, mismatches);
+    mismatches += sim.stats.transactions - transactions != SESSION_REFRESHES;
+    return mismatches;
+}
+
+static RDA_Xfer portXfers[RDA_XFER_QUEUE_SIZE + 1];
+static uint16_t portWords[RDA_XFER_QUEUE_SIZE + 1];
+static uint8_t portOrder[RDA_XFER_QUEUE_SIZE + 1];
+static uint8_t portDone;
+static BOOL portSubmitted;
+
+/*
+ * Completion callback of the port check: logs the order, the third one queues one more
+ */
+static void portCompleted(RDA_Xfer* xfer)
+{
+    uint8_t index = xfer - portXfers;
+
+    portOrder[portDone++] = index;
+    if (index == 2)
+    {
+        portSubmitted = RDA_XferSubmit(xfer->context, &portXfers[RDA_XFER_QUEUE_SIZE]);
+    }
+}
+
+/*
+ * Runs the queue on the interrupt driven host port, which completes transfers from an alarm:
+ * a full queue of overlapping submits, a submit from a completion callback, driver calls, and
+ * lost interrupts that the driver has to abort. Returns the mismatches
+ */
+static uint32_t checkAsyncPort(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_SimPort port;
+    RDA_XferQueue* queue;
+    RDA_Status status;
+    uint32_t recoveries;
+    uint32_t elapsed;
+    uint32_t start;
+    uint32_t mismatches = 0;
+    uint8_t busy;
+    uint8_t full;
+    uint8_t lost;
+    uint8_t i;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_Tune(&radio, 101300);
+    queue = RDA_GetXferQueue(&radio);
+    RDA_SimPortInit(&port, &bus, queue);
+    RDA_SetXferPort(&radio, &RDA_SimPortOps, &port);
+
+    // Reads of REG02-REG09 back to back, the ninth comes from the callback of the third
+    portDone = 0;
+    for (i = 0; i <= RDA_XFER_QUEUE_SIZE; i++)
+    {
+        RDA_Xfer xfer = {I2C_ADDR_DIRECT_ACCESS, RDA_XFER_READ, REG02 + i, 1, &portWords[i], portCompleted, queue};
+        portXfers[i] = xfer;
+    }
+    for (i = 0; i < RDA_XFER_QUEUE_SIZE; i++)
+    {
+        mismatches += !RDA_XferSubmit(queue, &portXfers[i]);
+    }
+    full = !RDA_XferSubmit(queue, &portXfers[RDA_XFER_QUEUE_SIZE]);
+    busy = RDA_XferBusy(queue) && portDone == 0;
+    start = getMillis();
+    // Each one is well below 1 ms at 100 kHz
+    while (RDA_XferBusy(queue) && getMillis() - start <= RDA_XFER_QUEUE_SIZE + 1)
+    {
+        RDA_HAL_Idle();
+    }
+    mismatches += !full || !busy || !portSubmitted || portDone != RDA_XFER_QUEUE_SIZE + 1 || RDA_XferBusy(queue);
+    for (i = 0; i <= RDA_XFER_QUEUE_SIZE; i++)
+    {
+        mismatches += portOrder[i] != i || portXfers[i].status != RDA_XFER_OK || portWords[i] != sim.reg[REG02 + i];
+    }
+    printf("async port    %u transfers in order, queue full %s, %u started, %u mismatches\n", portDone,
+           full ? "refused" : "accepted", port.started, mismatches);
+
+    // The driver waits for the alarm instead of completing inside start()
+    start = getMicros();
+    status = RDA_Tune(&radio, 94800);
+    elapsed = getMicros() - start;
+    mismatches += status != RDA_OK || RDA_GetRealFrequency(&radio) != 94800 || RDA_SimGetFrequency(&sim) != 94800;
+    printf("async port    tune %d in %u us, %u mismatches\n", status, elapsed, mismatches);
+
+    // A lost interrupt is aborted after RDA_I2C_TIMEOUT and retried, four exhaust the retries
+    for (lost = 1; lost <= 4; lost += 3)
+    {
+        Delay(SESSION_FAULT_SLACK);
+        recoveries = sim.stats.recoveries;
+        i = port.aborted;
+        RDA_SimPortLose(&port, lost);
+        start = getMillis();
+        status = RDA_RefreshStatus(&radio);
+        elapsed = getMillis() - start;
+        mismatches += status != ((lost == 1) ? RDA_OK : RDA_TIMEOUT) || port.aborted - i != ((lost == 1) ? 1 : 3) ||
+                      sim.stats.recoveries - recoveries != port.aborted - i ||
+                      elapsed > (port.aborted - i) * (RDA_I2C_TIMEOUT + 1) + SESSION_FAULT_SLACK;
+        printf("async port    %u lost: %d after %u ms, %u aborted, %u mismatches\n", lost, status, elapsed,
+               port.aborted - i, mismatches);
+    }
+    RDA_SimPortLose(&port, 0);
+    mismatches += RDA_RefreshStatus(&radio) != RDA_OK || RDA_XferBusy(queue);
+    RDA_SetXferPort(&radio, NULL, NULL);
+    return mismatches;
+}
+
+/*
+ * EXTI handler of the pin wired to GPIO2
+ */
+static void stcInterrupt(void* context)
+{
+    RDA_NotifySTC(context);
+}
+
+/*
+ * Runs the same tune and seek polled and with GPIO2 wired to RDA_NotifySTC, and counts the
+ * REG0A reads and transactions each one really makes. Returns the mismatches
+ */
+static uint32_t checkTuneInterrupt(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_TuneStatus status;
+    uint32_t polls[2];
+    uint32_t transactions[2];
+    uint32_t elapsed[2];
+    uint32_t interrupts;
+    uint32_t start;
+    uint32_t mismatches = 0;
+    uint8_t irq;
+    uint8_t op;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_SimSetIRQ(&sim, stcInterrupt, &radio);
+    RDA_Init(&radio, &bus);
+    for (op = 0; op < 2; op++)
+    {
+        for (irq = 0; irq < 2; irq++)
+        {
+            RDA_SetTuneInterrupt(&radio, irq);
+            RDA_Tune(&radio, 89100);
+            // Let the settle time of the tune pass, it is not part of the measurement
+            Delay(SESSION_FAULT_SLACK);
+            start = getMillis();
+            transactions[irq] = sim.stats.transactions;
+            interrupts = sim.stats.interrupts;
+            if (op == 0)
+            {
+                status = (RDA_Tune(&radio, 94800) == RDA_OK) ? RDA_TUNE_DONE : RDA_TUNE_ERROR;
+            }
+            else
+            {
+                RDA_SeekAsync(&radio, RDA_SEEK_WRAP, RDA_SEEK_UP, NULL);
+                status = waitTune(&radio);
+            }
+            elapsed[irq] = getMillis() - start;
+            transactions[irq] = sim.stats.transactions - transactions[irq];
+            polls[irq] = RDA_GetTunePolls(&radio);
+            mismatches += status != RDA_TUNE_DONE || RDA_SimGetFrequency(&sim) != 94800 ||
+                          RDA_GetRealFrequency(&radio) != 94800 || sim.stats.interrupts - interrupts != irq;
+        }
+        // The synchronous tune takes STC from the interrupt alone, the seek reads REG0A once for READCHAN
+        mismatches += polls[1] != op || polls[0] <= polls[1] || transactions[0] <= transactions[1] ||
+                      elapsed[1] > elapsed[0];
+        printf("stc interrupt %s: polled %u reads, %u transactions, %u ms; gpio2 %u reads, %u transactions, %u ms, %u mismatches\n",
+               op == 0 ? "tune" : "seek", polls[0], transactions[0], elapsed[0], polls[1], transactions[1], elapsed[1],
+               mismatches);
+    }
+    RDA_SetTuneInterrupt(&radio, FALSE);
+    RDA_SimSetIRQ(&sim, NULL, NULL);
+    return mismatches;
+}
+
+static uint32_t tuneCalls;
+static uint32_t tuneDoneAt;
+
+/*
+ * Completion callback of the asynchronous tune check
+ */
+static void tuneDone(RDA_Handle* dev, RDA_TuneStatus status)
+{
+    tuneCalls++;
+    tuneDoneAt = getMillis();
+}
+
+/*
+ * Runs RDA_TuneAsync against several tune times of the model: each tune must complete no
+ * sooner than the chip, call back once and end on the station. Inside a batch update the
+ * tune and the seek must be refused without touching the bus. Returns the mismatches
+ */
+static uint32_t checkAsyncTune(void)
+{
+    static const uint32_t tuneTimes[] = {10, 60, 250, 450};
+    static const uint32_t targets[] = {94800, 101300, 104000, 89100};
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_TuneStatus status;
+    uint32_t transactions;
+    uint32_t elapsed;
+    uint32_t start;
+    uint32_t mismatches = 0;
+    uint8_t i;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    for (i = 0; i < sizeof(tuneTimes) / sizeof(tuneTimes[0]); i++)
+    {
+        RDA_SimSetTuneTime(&sim, tuneTimes[i]);
+        Delay(SESSION_FAULT_SLACK);
+        tuneCalls = 0;
+        start = getMillis();
+        mismatches += RDA_TuneAsync(&radio, targets[i], tuneDone) != RDA_OK;
+        status = waitTune(&radio);
+        elapsed = tuneDoneAt - start;
+        mismatches += status != RDA_TUNE_DONE || tuneCalls != 1 || elapsed < tuneTimes[i] ||
+                      RDA_SimGetFrequency(&sim) != targets[i] || RDA_GetRealFrequency(&radio) != targets[i];
+        printf("async tune    chip %3u ms, done after %3u ms, %u callbacks, %u mismatches\n", tuneTimes[i], elapsed,
+               tuneCalls, mismatches);
+    }
+    // A batch defers register writes, the operation would be tracked without having started
+    tuneCalls = 0;
+    transactions = sim.stats.transactions;
+    RDA_BeginUpdate(&radio);
+    mismatches += RDA_TuneAsync(&radio, 106700, tuneDone) != RDA_ERROR;
+    mismatches += RDA_SeekAsync(&radio, RDA_SEEK_WRAP, RDA_SEEK_UP, tuneDone) != RDA_ERROR;
+    mismatches += RDA_CommitUpdate(&radio) != RDA_OK;
+    mismatches += RDA_TunePoll(&radio) != RDA_TUNE_IDLE || tuneCalls || sim.stats.transactions != transactions ||
+                  RDA_SimGetFrequency(&sim) != targets[i - 1];
+    printf("async tune    refused in a batch, %u transactions, %u mismatches\n", sim.stats.transactions - transactions,
+           mismatches);
+    return mismatches;
+}
+
+/*
+ * RDA_ScanStart must be refused without bus traffic inside a batch update, while an
+ * asynchronous seek is pending and while a scan runs; the seek must still call back once
+ * and the running scan finish on its own table. Returns the mismatches
+ */
+static uint32_t checkScanRefused(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Station found[SESSION_STATIONS];
+    RDA_Station other[SESSION_STATIONS];
+    RDA_StationTable table = {found, SESSION_STATIONS};
+    RDA_StationTable second = {other, SESSION_STATIONS, 0xFF};
+    RDA_TuneStatus status;
+    uint32_t transactions;
+    uint32_t mismatches = 0;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_Tune(&radio, 101300);
+
+    // A batch would later rewrite REG03 with the channel from before the scan
+    transactions = sim.stats.transactions;
+    RDA_BeginUpdate(&radio);
+    mismatches += RDA_ScanStart(&radio, RDA_SCAN_STEP, &second) != RDA_ERROR;
+    mismatches += RDA_CommitUpdate(&radio) != RDA_OK;
+    mismatches += RDA_ScanPoll(&radio) != RDA_TUNE_IDLE || sim.stats.transactions != transactions;
+
+    // The scan would take the STC of the seek
+    tuneCalls = 0;
+    mismatches += RDA_SeekAsync(&radio, RDA_SEEK_WRAP, RDA_SEEK_UP, tuneDone) != RDA_OK;
+    transactions = sim.stats.transactions;
+    mismatches += RDA_Scan(&radio, RDA_SCAN_SEEK, &second) != RDA_ERROR;
+    mismatches += sim.stats.transactions != transactions;
+    mismatches += waitTune(&radio) != RDA_TUNE_DONE || tuneCalls != 1;
+
+    // A second start would move the running scan to another table
+    mismatches += RDA_ScanStart(&radio, RDA_SCAN_STEP, &table) != RDA_OK;
+    transactions = sim.stats.transactions;
+    mismatches += RDA_ScanStart(&radio, RDA_SCAN_SEEK, &second) != RDA_ERROR;
+    mismatches += sim.stats.transactions != transactions;
+    while ((status = RDA_ScanPoll(&radio)) == RDA_TUNE_IN_PROGRESS)
+    {
+        RDA_HAL_Idle();
+    }
+    mismatches += status != RDA_TUNE_DONE || table.count == 0 || second.count != 0xFF;
+    printf("scan refused  in a batch, during a seek and during a scan, %u stations, %u mismatches\n", table.count,
+           mismatches);
+    return mismatches;
+}
+
+/*
+ * EXTI handler that loses the edge
+ */
+static void stcMissed(void* context)
+{
+}
+
+/*
+ * Loses the GPIO2 edge of an interrupt driven tune, synchronous and asynchronous: both must
+ * read STC at their deadline and complete instead of waiting forever. Returns the mismatches
+ */
+static uint32_t checkMissedSTC(void)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Status status[2];
+    uint32_t elapsed[2];
+    uint32_t start;
+    uint32_t mismatches = 0;
+    uint8_t op;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_SimSetIRQ(&sim, stcMissed, NULL);
+    RDA_Init(&radio, &bus);
+    RDA_SetTuneInterrupt(&radio, TRUE);
+    for (op = 0; op < 2; op++)
+    {
+        Delay(SESSION_FAULT_SLACK);
+        start = getMillis();
+        if (op == 0)
+        {
+            status[op] = RDA_Tune(&radio, 94800);
+        }
+        else
+        {
+            RDA_TuneAsync(&radio, 101300, NULL);
+            status[op] = (waitTune(&radio) == RDA_TUNE_DONE) ? RDA_OK : RDA_GetLastError(&radio);
+        }
+        elapsed[op] = getMillis() - start;
+        mismatches += status[op] != RDA_OK || elapsed[op] > SESSION_TUNE_DEADLINE + SESSION_FAULT_SLACK ||
+                      RDA_GetTunePolls(&radio) != 1 || RDA_SimGetFrequency(&sim) != (op ? 101300 : 94800);
+    }
+    printf("missed stc    tune %d after %u ms, async tune %d after %u ms, %u mismatches\n", status[0], elapsed[0],
+           status[1], elapsed[1], mismatches);
+    RDA_SetTuneInterrupt(&radio, FALSE);
+    RDA_SimSetIRQ(&sim, NULL, NULL);
+    return mismatches;
+}
+
+/*
+ * Injects bus faults under a status read and a register write and checks that the driver
+ * recovers from each within its budget: the event timeouts it has to wait out plus the
+ * transfers themselves. Returns the mismatches
+ */
+static uint32_t checkFaults(void)
+{
+    static const struct
+    {
+        const char* name;
+        uint8_t fault;
+        uint8_t count;
+        RDA_Status status;      // Result with the default retries
+        uint8_t timeouts;       // RDA_I2C_TIMEOUT waits on the way
+        uint8_t recoveries;     // Bus recoveries on the way
+    } faults[] = {
+        {"nack     ", SIM_FAULT_NACK, 1, RDA_OK, 0, 1},
+        {"timeout  ", SIM_FAULT_TIMEOUT, 2, RDA_OK, 2, 2},
+        {"sda stuck", SIM_FAULT_SDA_STUCK, 0, RDA_OK, 1, 1},
+        {"dead bus ", SIM_FAULT_TIMEOUT, 3, RDA_TIMEOUT, 3, 2},
+    };
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Reg05 reg05;
+    RDA_Status status[2];
+    uint32_t elapsed[2];
+    uint32_t recoveries;
+    uint32_t budget;
+    uint32_t start;
+    uint32_t mismatches = 0;
+    uint8_t i;
+    uint8_t op;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    RDA_Init(&radio, &bus);
+    RDA_Tune(&radio, 101300);
+    for (i = 0; i < sizeof(faults) / sizeof(faults[0]); i++)
+    {
+        budget = faults[i].timeouts * (RDA_I2C_TIMEOUT + 1) + SESSION_FAULT_SLACK;
+        for (op = 0; op < 2; op++)
+        {
+            // Let the settle time of the last write pass, it is not part of the budget
+            Delay(SESSION_FAULT_SLACK);
+            recoveries = sim.stats.recoveries;
+            RDA_SimInjectFault(&sim, faults[i].fault, faults[i].count);
+            start = getMillis();
+            status[op] = (op == 0) ? RDA_RefreshStatus(&radio) : RDA_SetVolume(&radio, i + 1);
+            elapsed[op] = getMillis() - start;
+            mismatches += status[op] != faults[i].status || elapsed[op] > budget ||
+                          sim.stats.recoveries - recoveries != faults[i].recoveries || sim.fault != SIM_FAULT_NONE;
+        }
+        // The bus works again afterwards
+        reg05.raw = sim.reg[REG05];
+        mismatches += RDA_RefreshStatus(&radio) != RDA_OK || RDA_GetRealFrequency(&radio) != 101300 ||
+                      reg05.refined.VOLUME != ((faults[i].status == RDA_OK) ? i + 1 : i);
+        printf("fault %s read %d in %u ms, write %d in %u ms, budget %u ms, %u mismatches\n", faults[i].name,
+               status[0], elapsed[0], status[1], elapsed[1], budget, mismatches);
+    }
+    return mismatches;
+}
+
+
+/*
+ * Host counterpart of src/main.c: runs a standard session against the chip model and
+ * reports bus and wait costs. Usage: fm_radio_host [I2C clock in Hz]
+ */
+int main(int argc, char** argv)
+{
+    RDA_Sim sim;
+    RDA_BusTypeDef bus;
+    RDA_Handle radio;
+    RDA_Status status;
+    RDA_TuneStatus tune;
+    RDA_RDS rds;
+    RDA_RDSRing ring;
+    RDA_Monitor monitor;
+    RDA_SimPort port;
+    RDA_SignalStats signal;
+    RDA_Station found[SESSION_STATIONS];
+    RDA_StationTable table = {found, SESSION_STATIONS};
+    uint32_t transactions;
+    uint8_t mode;
+    uint32_t channels;
+    uint32_t uncachedTransactions;
+    uint32_t ctAccepted;
+    uint32_t ctMismatches;
+    uint32_t channelMismatches;
+    uint32_t end;
+    uint32_t mismatches;
+    uint8_t i;
+
+    RDA_SimInit(&sim, &bus);
+    RDA_SimSetStations(&sim, stations, sizeof(stations) / sizeof(stations[0]));
+    if (argc > 1)
+    {
+        RDA_SimSetBusSpeed(&sim, (uint32_t)strtoul(argv[1], NULL, 0));
+    }
+
+    status = RDA_Init(&radio, &bus);
+    RDA_BeginUpdate(&radio);
+    RDA_SetBass(&radio, TRUE);
+    RDA_SetMono(&radio, FALSE);
+    RDA_SetVolume(&radio, 15);
+    RDA_SetRDS(&radio, TRUE);
+    RDA_CommitUpdate(&radio);
+    if (status != RDA_OK)
+    {
+        printf("init failed %d\n", status);
+        return 1;
+    }
+
+    status = RDA_Tune(&radio, 89100);
+    printf("tune          %u kHz rssi %d (%d)\n", RDA_SimGetFrequency(&sim), (int)RDA_GetQuality(&radio), status);
+    for (i = 0; i < SESSION_SEEKS; i++)
+    {
+        RDA_SeekAsync(&radio, RDA_SEEK_WRAP, RDA_SEEK_UP, NULL);
+        tune = waitTune(&radio);
+        printf("seek          %u kHz rssi %d (%s)\n", RDA_SimGetFrequency(&sim), (int)RDA_GetQuality(&radio),
+               tune == RDA_TUNE_DONE ? "found" : "failed");
+    }
+
+    // RDS is captured and the signal sampled by the timer tick on the interrupt driven port,
+    // the main loop drains the ring
+    RDA_RDSInit(&rds);
+    RDA_RDSRingInit(&ring);
+    RDA_SetRDSRing(&radio, &ring);
+    RDA_SetMonitor(&radio, &monitor, SESSION_MONITOR);
+    tickPortAttach(&radio, &port, &bus);
+    captureDevice = &radio;
+    RDA_HAL_SetTick(captureTick, SESSION_CAPTURE);
+    end = getMillis() + SESSION_RDS;
+    while ((int32_t)(getMillis() - end) < 0)
+    {
+        Delay(SESSION_DRAIN);
+        drainRing(&ring, &rds);
+    }
+    Delay(SESSION_BUSY);
+    drainRing(&ring, &rds);
+    RDA_HAL_SetTick(NULL, 0);
+    tickPortDetach(&radio);
+    RDA_SetRDSRing(&radio, NULL);
+
+    // The statistics come from the monitor, not from the bus
+    transactions = sim.stats.transactions;
+    RDA_GetSignalStats(&radio, &signal);
+    printf("signal        %u samples, rssi %u/%u/%u, fm true %u%%, stereo %u%%, rds errors %u%% of %u blocks, %u transactions\n",
+           signal.samples, signal.rssiMin, signal.rssiAvg, signal.rssiMax, signal.fmTrue, signal.stereo, signal.rdsErrors,
+           signal.rdsBlocks, sim.stats.transactions - transactions);
+    RDA_SetMonitor(&radio, NULL, 0);
+
+    printf("rds           PI %04X PTY %u PS \"%s\" RT \"%s\"\n", rds.pi, rds.pty,
+           RDA_RDSHasPS(&rds) ? rds.ps : "", RDA_RDSHasRT(&rds) ? rds.rt : "");
+    printf("rds ring      %u drained, %u dropped, latency max %u ms\n", drained, ring.dropped, maxLatency);
+
+    for (mode = RDA_SCAN_STEP; mode <= RDA_SCAN_SEEK; mode++)
+    {
+        transactions = sim.stats.transactions;
+        status = RDA_Scan(&radio, mode, &table);
+        printf("scan %s     %u stations, %u channels, %u ms, %u transactions (%d)\n", mode == RDA_SCAN_STEP ? "step" : "seek",
+               table.count, table.channels, table.time, sim.stats.transactions - transactions, status);
+        for (i = 0; i < table.count; i++)
+        {
+            printf("              %u kHz rssi %u%s%s\n", found[i].frequency, found[i].rssi,
+                   (found[i].flags & RDA_STATION_STEREO) ? " stereo" : "", (found[i].flags & RDA_STATION_RDS) ? " rds" : "");
+        }
+    }
+
+    RDA_SimReport(&sim);
+
+    multiScan();
+
+    powerSession(FALSE);
+    powerSession(TRUE);
+    schedSession();
+    bootSession();
+
+    mismatches = checkMonitor();
+    printf("monitor check %u samples, %u mismatches\n", SESSION_SAMPLES, mismatches);
+
+    mismatches += afSession();
+
+    mismatches += checkStore();
+
+    mismatches += checkBoot();
+
+    mismatches += pollSession(0, &uncachedTransactions);
+    mismatches += pollSession(RDA_CACHE_WINDOW, &transactions);
+    mismatches += (transactions >= uncachedTransactions);
+
+    mismatches += checkResync();
+
+    mismatches += checkFaults();
+
+    mismatches += checkTuneInterrupt();
+    mismatches += checkMissedSTC();
+    mismatches += checkAsyncTune();
+    mismatches += checkScanRefused();
+
+    mismatches += checkAsyncPort();
+
+    mismatches += checkRefreshStatus();
+
+    mismatches += checkTickReads();
+
+    mismatches += checkOffGrid();
+
+    mismatches += checkTrace();
+
+    ctMismatches = checkClockTime(&ctAccepted);
+    printf("ct check      %u minutes, %u times accepted, %u mismatches\n", SESSION_CT_MINUTES, ctAccepted, ctMismatches);
+    mismatches += ctMismatches;
+
+    channelMismatches = checkChannels(&sim, &radio, &channels);
+    printf("channel check %u channels, %u mismatches\n", channels, channelMismatches);
+    return (channelMismatches || mismatches) ? 1 : 0;
+}
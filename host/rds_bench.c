@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <RDA_RDS.h>
+
+#define BENCH_TRIALS    200     // Receptions per error rate
+#define BENCH_GROUPS    400     // Groups per reception, about 35 s of RDS
+#define BENCH_PI        0xD318
+#define BENCH_PS        "RADIO 1 "
+#define BENCH_RT        "The best mix of the 80s, 90s and today"
+
+#define BENCH_WAYS      3       // Levels ignored, clean blocks only, default policy with voting
+
+// Error rates in percent of blocks hit
+static const uint8_t rates[] = {0, 2, 5, 10, 20, 30, 40};
+
+// Only blocks without errors, nothing left to vote on
+static const RDA_RDSPolicy cleanOnly = {{0, 0, 0, 0}};
+
+/*
+ * Result of one way of decoding at one error rate
+ */
+typedef struct
+{
+    uint32_t stable;        // Receptions that ended with the right PS
+    uint32_t groups;        // Sum of the groups until the PS was stable
+    uint32_t wrong;         // PS completions with a wrong name
+} BenchResult;
+
+/*
+ * Hits a block with errors: 1-2 errors are corrected, 3-5 errors are corrected but one time
+ * in four into a wrong word, 6+ errors are left in. Returns the REG0B error level.
+ */
+static uint8_t benchHit(uint16_t* block, uint8_t rate)
+{
+    uint8_t severity;
+
+    if (rand() % 100 >= rate)
+    {
+        return 0;
+    }
+    severity = rand() % 10;
+    if (severity < 4)
+    {
+        return 1;
+    }
+    if (severity < 7)
+    {
+        if (rand() % 4 == 0)
+        {
+            *block ^= 1 << (rand() % 16);
+        }
+        return 2;
+    }
+    *block ^= (uint16_t)rand() | 1;
+    return 3;
+}
+
+/*
+ * Builds group n of the station: 0A and 2A groups alternate
+ */
+static void benchGroup(uint32_t n, uint16_t* blocks)
+{
+    uint8_t length = strlen(BENCH_RT);
+    uint8_t segment;
+    uint8_t text[4];
+    uint8_t i;
+
+    blocks[0] = BENCH_PI;
+    if (n & 1)
+    {
+        segment = (n / 2) % ((length + 4) / 4);
+        for (i = 0; i < 4; i++)
+        {
+            text[i] = (4 * segment + i < length) ? BENCH_RT[4 * segment + i] : (4 * segment + i == length) ? 0x0D : ' ';
+        }
+        blocks[1] = 0x2000 | 0x0140 | segment;
+        blocks[2] = ((uint16_t)text[0] << 8) | text[1];
+        blocks[3] = ((uint16_t)text[2] << 8) | text[3];
+    }
+    else
+    {
+        segment = (n / 2) % 4;
+        blocks[1] = 0x0148 | segment;
+        blocks[2] = 0xE0CD;
+        blocks[3] = ((uint16_t)BENCH_PS[2 * segment] << 8) | (uint8_t)BENCH_PS[2 * segment + 1];
+    }
+}
+
+/*
+ * Receives one station for BENCH_GROUPS groups, decoded each way
+ */
+static void benchReception(uint8_t rate, BenchResult* results)
+{
+    RDA_RDS rds[BENCH_WAYS];
+    uint32_t stableFrom[BENCH_WAYS];
+    RDA_RDSGroup group;
+    uint8_t changes;
+    uint8_t level;
+    uint32_t n;
+    uint8_t i;
+
+    for (i = 0; i < BENCH_WAYS; i++)
+    {
+        RDA_RDSInit(&rds[i]);
+        stableFrom[i] = 0;
+    }
+    for (n = 0; n < BENCH_GROUPS; n++)
+    {
+        benchGroup(n, group.blocks);
+        group.blera = benchHit(&group.blocks[0], rate);
+        group.blerb = benchHit(&group.blocks[1], rate);
+        for (i = 2; i < 4; i++)
+        {
+            level = benchHit(&group.blocks[i], rate);
+            group.blerb = (level > group.blerb) ? level : group.blerb;
+        }
+
+        for (i = 0; i < BENCH_WAYS; i++)
+        {
+            switch (i)
+            {
+                case 0:
+                    changes = RDA_RDSDecode(&rds[i], group.blocks);
+                    break;
+                case 1:
+                    changes = RDA_RDSDecodeGroup(&rds[i], &group, &cleanOnly);
+                    break;
+                default:
+                    changes = RDA_RDSDecodeGroup(&rds[i], &group, &RDA_RDSPolicyDefault);
+                    break;
+            }
+            if ((changes & RDA_RDS_PS_READY) && strcmp(rds[i].ps, BENCH_PS))
+            {
+                results[i].wrong++;
+            }
+            // Stable from the last group that left the right name standing
+            if (!RDA_RDSHasPS(&rds[i]) || strcmp(rds[i].ps, BENCH_PS))
+            {
+                stableFrom[i] = n + 1;
+            }
+        }
+    }
+    for (i = 0; i < BENCH_WAYS; i++)
+    {
+        if (stableFrom[i] < BENCH_GROUPS)
+        {
+            results[i].stable++;
+            results[i].groups += stableFrom[i] + 1;
+        }
+    }
+}
+
+/*
+ * Groups until the PS name is stable, at several block error rates: with the levels ignored
+ * (every group decoded), with clean blocks only, and with the default policy and voting.
+ * Usage: rds_bench [seed]
+ */
+int main(int argc, char** argv)
+{
+    BenchResult results[BENCH_WAYS];
+    uint32_t trial;
+    uint8_t r;
+    uint8_t i;
+
+    srand(argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 0) : 1);
+    printf("%u receptions of %u groups per rate\n", BENCH_TRIALS, BENCH_GROUPS);
+    printf("groups until the PS is stable (receptions that end stable, wrong PS completions)\n");
+    printf("block errors  levels ignored        clean blocks only     policy + voting\n");
+    for (r = 0; r < sizeof(rates); r++)
+    {
+        memset(results, 0, sizeof(results));
+        for (trial = 0; trial < BENCH_TRIALS; trial++)
+        {
+            benchReception(rates[r], results);
+        }
+        printf("%3u%%        ", rates[r]);
+        for (i = 0; i < BENCH_WAYS; i++)
+        {
+            printf("  %6.1f (%3u%%, %4u)", results[i].stable ? (double)results[i].groups / results[i].stable : 0.0,
+                   results[i].stable * 100 / BENCH_TRIALS, results[i].wrong);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <RDA_RDS.h>
+
+/*
+ * Replays a recorded block stream through the RDS decoder.
+ * One group per line: blocks A, B, C and D in hex, e.g. "D318 0408 E0CD 5241", optionally
+ * followed by the BLERA and BLERB levels, which are then checked against the default policy.
+ * Usage: rds_replay [file], reads stdin without argument
+ */
+int main(int argc, char** argv)
+{
+    FILE* input = stdin;
+    RDA_RDS rds;
+    RDA_RDSGroup group;
+    unsigned int a, b, c, d, blera, blerb;
+    uint8_t changes;
+    char line[128];
+
+    if (argc > 1 && !(input = fopen(argv[1], "r")))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    RDA_RDSInit(&rds);
+    while (fgets(line, sizeof(line), input))
+    {
+        blera = 0;
+        blerb = 0;
+        if (sscanf(line, "%x %x %x %x %u %u", &a, &b, &c, &d, &blera, &blerb) < 4)
+        {
+            continue; // Comments and empty lines
+        }
+        group.blocks[0] = a;
+        group.blocks[1] = b;
+        group.blocks[2] = c;
+        group.blocks[3] = d;
+        group.blera = blera;
+        group.blerb = blerb;
+        changes = RDA_RDSDecodeGroup(&rds, &group, &RDA_RDSPolicyDefault);
+        if (changes & RDA_RDS_PI_CHANGED)
+        {
+            printf("%6u PI  %04X\n", rds.groups, rds.pi);
+        }
+        if (changes & RDA_RDS_PTY_CHANGED)
+        {
+            printf("%6u PTY %u\n", rds.groups, rds.pty);
+        }
+        if (changes & RDA_RDS_FLAGS_CHANGED)
+        {
+            printf("%6u TP %u TA %u MS %u\n", rds.groups, rds.tp, rds.ta, rds.ms);
+        }
+        if (changes & RDA_RDS_PS_READY)
+        {
+            printf("%6u PS  \"%s\"\n", rds.groups, rds.ps);
+        }
+        if (changes & RDA_RDS_RT_READY)
+        {
+            printf("%6u RT  \"%s\"\n", rds.groups, rds.rt);
+        }
+        if (changes & RDA_RDS_CT_READY)
+        {
+            printf("%6u CT  %04u-%02u-%02u %02u:%02u UTC%+d min\n", rds.groups, rds.time.year, rds.time.month,
+                   rds.time.day, rds.time.hour, rds.time.minute, rds.time.offset * 30);
+        }
+    }
+    if (rds.rejected)
+    {
+        printf("%6u groups rejected\n", rds.rejected);
+    }
+    if (input != stdin)
+    {
+        fclose(input);
+    }
+    return 0;
+}
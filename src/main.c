@@ -3,6 +3,152 @@
 #include <stm32f10x_gpio.h>
 #include <stm32f10x_i2c.h>
 #include <RDA_5807.h>
+#include <RDA_Sched.h>
+#include <string.h>
+
+#define CAPTURE_PERIOD 40    // ms between RDS captures, the chip keeps a group for about 88 ms
+#define DRAIN_PERIOD 200     // ms between RDS ring drains, the ring holds about 1.4 s of groups
+#define MONITOR_PERIOD 1000  // ms between signal quality samples, RDA_GetSignalStats averages the last ones
+#define LED_PERIOD 500       // ms between heartbeat LED toggles
+#define KEY_PERIOD 20        // ms between polls of the seek key (PA0 to ground), longer than its bounce
+#define PS_STABLE 10000      // ms a PS name must hold before it is stored, dynamic names never do
+#define POWER_TRIES 3        // Power-up attempts before the radio is given up
+#define ERROR_PERIOD 100     // ms between LED toggles when the radio does not power up
+// STORE_BASE (preset store pages) comes from the Makefile, store.ld fails the link when the image reaches it
+
+static RDA_Handle radio;
+static RDA_RDS rds;
+static RDA_RDSRing ring;
+static RDA_Monitor monitor;
+static RDA_Store store;
+static uint32_t psSince;  // getMillis() when the current PS name completed
+static uint32_t psStored; // Frequency the PS name was stored for, one save per station
+static BOOL keyDown;      // The seek key was down at the last poll
+static RDA_Task captureTask;
+static RDA_Task rdsTask;
+static RDA_Task monitorTask;
+static RDA_Task tunedTask;
+static RDA_Task keyTask;
+static RDA_Task ledTask;
+
+/*
+ * Reads the group the chip received into the ring, ahead of the decoding
+ */
+static void rdsCapture(RDA_Task* task)
+{
+    RDA_CaptureRDSStep(task->context);
+}
+
+/*
+ * Samples the signal quality of the station
+ */
+static void monitorSample(RDA_Task* task)
+{
+    RDA_MonitorStep(task->context);
+}
+
+/*
+ * Decodes the captured RDS groups
+ */
+static void rdsDrain(RDA_Task* task)
+{
+    RDA_StoreEntry state;
+    RDA_RDSGroup group;
+
+    while (RDA_RDSRingPop(&ring, &group))
+    {
+        if (RDA_RDSDecodeGroup(&rds, &group, &RDA_RDSPolicyDefault) & RDA_RDS_PS_READY)
+        {
+            psSince = getMillis();
+        }
+    }
+    // The station is worth coming back to once its name is known. A scrolling name completes
+    // again every few seconds, storing each one would wear the flash out in weeks
+    if (!RDA_RDSHasPS(&rds) || (getMillis() - psSince) < PS_STABLE)
+    {
+        return;
+    }
+    RDA_GetState(task->context, &state);
+    if (state.frequency != psStored)
+    {
+        strncpy(state.ps, rds.ps, RDA_STORE_PS);
+        state.ps[RDA_STORE_PS] = 0;
+        RDA_StoreSaveState(&store, &state);
+        psStored = state.frequency;
+    }
+}
+
+static void ledFlip(GPIO_TypeDef* port)
+{
+    if (GPIO_ReadOutputDataBit(port, GPIO_Pin_13))
+    {
+        GPIO_ResetBits(port, GPIO_Pin_13);
+    }
+    else
+    {
+        GPIO_SetBits(port, GPIO_Pin_13);
+    }
+}
+
+#ifdef SYSTICK_DELAY
+/*
+ * A new station: the RDS of the old one is forgotten
+ */
+static void tuned(RDA_Task* task)
+{
+    RDA_RDSInit(&rds);
+    RDA_RDSRingInit(&ring);
+}
+
+/*
+ * Seek completion, runs in the timer continuation and hands over to the task
+ */
+static void seekDone(RDA_Handle* dev, RDA_TuneStatus status)
+{
+    RDA_TaskPost(&tunedTask);
+}
+
+/*
+ * Seek key: every press seeks up to the next station
+ */
+static void keyPoll(RDA_Task* task)
+{
+    BOOL down = !GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_0);
+
+    if (down && !keyDown)
+    {
+        RDA_SeekAsync(task->context, RDA_SEEK_WRAP, RDA_SEEK_UP, seekDone);
+    }
+    keyDown = down;
+}
+#endif
+
+/*
+ * Heartbeat, shows the main loop is alive
+ */
+static void ledToggle(RDA_Task* task)
+{
+    ledFlip(task->context);
+}
+
+/*
+ * Powers the radio up, the store is mounted while the oscillator settles
+ */
+static RDA_Status powerUp(void)
+{
+    RDA_TuneStatus power;
+
+    if (RDA_PowerUpStart(&radio, I2C1) != RDA_OK)
+    {
+        return RDA_GetLastError(&radio);
+    }
+    RDA_StoreOpen(&store, STORE_BASE);
+    while ((power = RDA_PowerUpPoll(&radio)) == RDA_TUNE_IN_PROGRESS)
+    {
+        RDA_HAL_Idle();
+    }
+    return (power == RDA_TUNE_DONE) ? RDA_OK : RDA_ERROR;
+}
 
 int main(void)
 {
@@ -15,8 +161,17 @@ int main(void)
     GPIO_Init(GPIOC, &led);
     GPIO_SetBits(GPIOC, GPIO_Pin_13);
 
+    GPIO_InitTypeDef key;
+    key.GPIO_Pin = GPIO_Pin_0;
+    key.GPIO_Mode = GPIO_Mode_IPU;
+    key.GPIO_Speed = GPIO_Speed_2MHz;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+    GPIO_Init(GPIOA, &key);
+
     GPIO_InitTypeDef  GPIO_InitStructure;
     I2C_InitTypeDef  I2C_InitStructure;
+    uint8_t tries;
 
     /* Enable RCC clock */
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
@@ -41,12 +196,58 @@ int main(void)
     I2C_InitStructure.I2C_ClockSpeed = 100000;
     I2C_Init(I2C1, &I2C_InitStructure);
 
-    RDA_Init(I2C1);
-    RDA_SetBass(I2C1, TRUE);
-    RDA_SetVolume(I2C1, 15);
-    RDA_Tune(I2C1, (uint16_t)10400);
+    for (tries = 1; powerUp() != RDA_OK; tries++)
+    {
+        if (tries == POWER_TRIES)
+        {
+            // No radio answers, nothing to restore or tune: blink fast
+            while (1)
+            {
+#ifdef SYSTICK_DELAY
+                Delay(ERROR_PERIOD);
+                ledFlip(GPIOC);
+#endif
+            }
+        }
+        RDA_HAL_Recover(I2C1);
+    }
+    if (RDA_StoreGetState(&store))
+    {
+        // Back on the last station with one batched register load
+        RDA_RestoreState(&radio, RDA_StoreGetState(&store));
+    }
+    else
+    {
+        RDA_BeginUpdate(&radio);
+        RDA_SetBass(&radio, TRUE);
+        RDA_SetVolume(&radio, 15);
+        RDA_CommitUpdate(&radio);
+        RDA_Tune(&radio, 104000);
+    }
+    // The station plays, RDA_GetBootTime(&radio) has the ms it took from the power-up
     GPIO_ResetBits(GPIOC, GPIO_Pin_13);
 
+#ifdef SYSTICK_DELAY
+    RDA_SetRDS(&radio, TRUE);
+    RDA_RDSInit(&rds);
+    RDA_RDSRingInit(&ring);
+    RDA_SetRDSRing(&radio, &ring);
+    RDA_SetMonitor(&radio, &monitor, MONITOR_PERIOD);
+    RDA_SchedInit();
+    RDA_TaskAdd(&tunedTask, "tuned", RDA_PRIORITY_HIGH, tuned, &radio);
+    RDA_TaskAdd(&captureTask, "capture", RDA_PRIORITY_HIGH, rdsCapture, &radio);
+    RDA_TaskAdd(&rdsTask, "rds", RDA_PRIORITY_NORMAL, rdsDrain, &radio);
+    RDA_TaskAdd(&monitorTask, "monitor", RDA_PRIORITY_NORMAL, monitorSample, &radio);
+    RDA_TaskAdd(&keyTask, "key", RDA_PRIORITY_LOW, keyPoll, &radio);
+    RDA_TaskAdd(&ledTask, "led", RDA_PRIORITY_LOW, ledToggle, GPIOC);
+    RDA_TaskSetPeriod(&captureTask, CAPTURE_PERIOD);
+    RDA_TaskSetPeriod(&rdsTask, DRAIN_PERIOD);
+    RDA_TaskSetPeriod(&monitorTask, MONITOR_PERIOD);
+    RDA_TaskSetPeriod(&keyTask, KEY_PERIOD);
+    RDA_TaskSetPeriod(&ledTask, LED_PERIOD);
+    // Runs the posted tasks, sleeps until the next timer or interrupt otherwise
+    RDA_SchedRun();
+#endif
     while (1)
     {
         /* code */